@@ -0,0 +1,78 @@
+/**
+ * Serialization cost of /action bodies
+ * Every factory writes the JSON body up front, so building is serializing.
+ */
+
+#include <spirecomm/action.hpp>
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace spirecomm;
+
+void BM_ActionPlayCard(benchmark::State& state) {
+    int index = 0;
+    for (auto _ : state) {
+        Action action = Action::playCard(index & 7, 1);
+        benchmark::DoNotOptimize(action.body().data());
+        ++index;
+    }
+}
+
+void BM_ActionEndTurn(benchmark::State& state) {
+    for (auto _ : state) {
+        Action action = Action::endTurn();
+        benchmark::DoNotOptimize(action.body().data());
+    }
+}
+
+void BM_ActionBuyCard(benchmark::State& state) {
+    for (auto _ : state) {
+        Action action = Action::buyCard("Flame Barrier");
+        benchmark::DoNotOptimize(action.body().data());
+    }
+}
+
+// Names that need escaping
+void BM_ActionChooseByName(benchmark::State& state) {
+    for (auto _ : state) {
+        Action action = Action::chooseByName("Ascender's Bane \"cursed\"");
+        benchmark::DoNotOptimize(action.body().data());
+    }
+}
+
+// Enough names to push the body past the inline buffer
+void BM_ActionCardSelect(benchmark::State& state) {
+    std::vector<std::string> names(static_cast<size_t>(state.range(0)), "Pommel Strike");
+    for (auto _ : state) {
+        Action action = Action::cardSelect(names);
+        benchmark::DoNotOptimize(action.body().data());
+    }
+    state.counters["body"] = static_cast<double>(Action::cardSelect(names).body().size());
+}
+
+// A whole planned turn, as handed to sendActions()
+void BM_ActionTurn(benchmark::State& state) {
+    std::vector<Action> turn;
+    turn.reserve(5);
+    for (auto _ : state) {
+        turn.clear();
+        turn.push_back(Action::playCard(0, 1));
+        turn.push_back(Action::playCard(2, 0));
+        turn.push_back(Action::usePotion(0, 2));
+        turn.push_back(Action::playCard(0));
+        turn.push_back(Action::endTurn());
+        benchmark::DoNotOptimize(turn.data());
+    }
+}
+
+} // anonymous namespace
+
+BENCHMARK(BM_ActionPlayCard);
+BENCHMARK(BM_ActionEndTurn);
+BENCHMARK(BM_ActionBuyCard);
+BENCHMARK(BM_ActionChooseByName);
+BENCHMARK(BM_ActionCardSelect)->Arg(1)->Arg(3)->Arg(10);
+BENCHMARK(BM_ActionTurn);
@@ -0,0 +1,146 @@
+/**
+ * Parse cost of /state bodies on each screen
+ *
+ * Dom: json::parse and parseGameState(json), what getState() pays
+ * Sax: parseGameStateBody(), what fetchGameState() pays
+ * EncodeBatch: filling a FeatureBatch from typed states, what startBatched() pays per batch
+ * TrajectoryAppend: logging one transition, what the play loop pays for TrajectoryWriter
+ */
+
+#include "payloads.hpp"
+#include <spirecomm/features.hpp>
+#include <spirecomm/game_state.hpp>
+#include <spirecomm/trajectory.hpp>
+#include <spirecomm/wire_format.hpp>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+using json = nlohmann::json;
+using namespace spirecomm;
+using bench::Screen;
+
+std::string encoded(Screen screen, WireFormat format) {
+    const std::string& body = bench::statePayload(screen);
+    if (format == WireFormat::JSON) {
+        return body;
+    }
+    json state = json::parse(body);
+    std::vector<uint8_t> bytes = format == WireFormat::MSGPACK ? json::to_msgpack(state) : json::to_cbor(state);
+    return std::string(bytes.begin(), bytes.end());
+}
+
+void BM_ParseDom(benchmark::State& state, Screen screen) {
+    const std::string& body = bench::statePayload(screen);
+    GameState game_state;
+    for (auto _ : state) {
+        json dom = json::parse(body);
+        parseGameState(dom, game_state);
+        benchmark::DoNotOptimize(game_state);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * body.size()));
+    state.counters["bytes"] = static_cast<double>(body.size());
+}
+
+void BM_ParseSax(benchmark::State& state, Screen screen, WireFormat format, uint32_t sections) {
+    std::string body = encoded(screen, format);
+    GameState game_state;
+    for (auto _ : state) {
+        bool ok = parseGameStateBody(body, game_state, sections, format);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(game_state);
+    }
+    if (!parseGameStateBody(body, game_state, sections, format)) {
+        state.SkipWithError("payload did not parse");
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * body.size()));
+    state.counters["bytes"] = static_cast<double>(body.size());
+}
+
+// Parsing a DOM that is already built (e.g. a cached state), without json::parse
+void BM_TypedFromDom(benchmark::State& state, Screen screen) {
+    json dom = json::parse(bench::statePayload(screen));
+    GameState game_state;
+    for (auto _ : state) {
+        parseGameState(dom, game_state);
+        benchmark::DoNotOptimize(game_state);
+    }
+}
+
+// Encoding a batch of combat states into feature columns (batch size as the argument)
+void BM_EncodeBatch(benchmark::State& state) {
+    GameState game_state;
+    parseGameStateBody(bench::statePayload(Screen::COMBAT), game_state);
+    size_t rows = static_cast<size_t>(state.range(0));
+    FeatureBatch batch;
+    for (auto _ : state) {
+        batch.reset(rows);
+        for (size_t row = 0; row < rows; ++row) {
+            batch.encode(row, game_state);
+        }
+        benchmark::DoNotOptimize(batch.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * rows));
+}
+
+// Encoding one combat state into a caller-owned row-major buffer
+void BM_EncodeRow(benchmark::State& state) {
+    GameState game_state;
+    parseGameStateBody(bench::statePayload(Screen::COMBAT), game_state);
+    std::vector<float> row(Feature::COUNT);
+    for (auto _ : state) {
+        encodeFeatures(game_state, row.data());
+        benchmark::DoNotOptimize(row.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Appending combat transitions to a trajectory file; the disk writes happen on the writer thread
+void BM_TrajectoryAppend(benchmark::State& state) {
+    GameState game_state;
+    parseGameStateBody(bench::statePayload(Screen::COMBAT), game_state);
+    Action action = Action::playCard(0, 0);
+    std::string path = (std::filesystem::temp_directory_path() / "spirecomm_bench.strj").string();
+    std::string error;
+    TrajectoryWriter writer;
+    if (!writer.open(path, error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    for (auto _ : state) {
+        writer.append(game_state, action, game_state);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    writer.close();
+    std::remove(path.c_str());
+}
+
+} // anonymous namespace
+
+BENCHMARK_CAPTURE(BM_ParseDom, combat, Screen::COMBAT);
+BENCHMARK_CAPTURE(BM_ParseDom, map, Screen::MAP);
+BENCHMARK_CAPTURE(BM_ParseDom, shop, Screen::SHOP);
+BENCHMARK_CAPTURE(BM_ParseDom, grid, Screen::GRID);
+
+BENCHMARK_CAPTURE(BM_ParseSax, combat, Screen::COMBAT, WireFormat::JSON, StateSections::ALL);
+BENCHMARK_CAPTURE(BM_ParseSax, map, Screen::MAP, WireFormat::JSON, StateSections::ALL);
+BENCHMARK_CAPTURE(BM_ParseSax, shop, Screen::SHOP, WireFormat::JSON, StateSections::ALL);
+BENCHMARK_CAPTURE(BM_ParseSax, grid, Screen::GRID, WireFormat::JSON, StateSections::ALL);
+
+// Combat-only agents skip the deck, map and screen
+BENCHMARK_CAPTURE(BM_ParseSax, combat_sections, Screen::COMBAT, WireFormat::JSON, StateSections::COMBAT);
+BENCHMARK_CAPTURE(BM_ParseSax, combat_msgpack, Screen::COMBAT, WireFormat::MSGPACK, StateSections::ALL);
+BENCHMARK_CAPTURE(BM_ParseSax, combat_cbor, Screen::COMBAT, WireFormat::CBOR, StateSections::ALL);
+BENCHMARK_CAPTURE(BM_ParseSax, map_msgpack, Screen::MAP, WireFormat::MSGPACK, StateSections::ALL);
+
+BENCHMARK_CAPTURE(BM_TypedFromDom, combat, Screen::COMBAT);
+BENCHMARK_CAPTURE(BM_TypedFromDom, map, Screen::MAP);
+
+BENCHMARK(BM_EncodeRow);
+BENCHMARK(BM_EncodeBatch)->Arg(1)->Arg(16)->Arg(256);
+BENCHMARK(BM_TrajectoryAppend);
@@ -0,0 +1,173 @@
+/**
+ * End-to-end cost of SpireCommClient requests against a mock server
+ *
+ * The mock is an in-process httplib server on a loopback port that answers
+ * /state with a fixed payload and /action with a fresh id, so the numbers
+ * cover the client, the HTTP stack and the parse, not the game or
+ * http_server.py.
+ */
+
+#include "payloads.hpp"
+#include <spirecomm/client.hpp>
+#include <benchmark/benchmark.h>
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using json = nlohmann::json;
+using namespace spirecomm;
+using bench::Screen;
+
+class MockServer {
+public:
+    MockServer() {
+        for (Screen screen : {Screen::COMBAT, Screen::MAP, Screen::SHOP, Screen::GRID}) {
+            const std::string& body = bench::statePayload(screen);
+            std::vector<uint8_t> msgpack = json::to_msgpack(json::parse(body));
+            json_bodies.push_back(body);
+            msgpack_bodies.emplace_back(msgpack.begin(), msgpack.end());
+        }
+
+        server.set_keep_alive_max_count(std::numeric_limits<size_t>::max());
+        server.set_tcp_nodelay(true);
+        server.Get("/health", [](const httplib::Request&, httplib::Response& res) {
+            res.set_content(R"({"status":"ready"})", "application/json");
+        });
+        server.Get("/state", [this](const httplib::Request& req, httplib::Response& res) {
+            size_t index = static_cast<size_t>(screen.load(std::memory_order_relaxed));
+            if (req.get_header_value("Accept") == "application/msgpack") {
+                res.set_content(msgpack_bodies[index], "application/msgpack");
+            } else {
+                res.set_content(json_bodies[index], "application/json");
+            }
+        });
+        server.Post("/action", [this](const httplib::Request&, httplib::Response& res) {
+            uint64_t id = ++action_id;
+            res.set_content(R"({"status":"queued","action_id":)" + std::to_string(id) + "}", "application/json");
+        });
+
+        port = server.bind_to_any_port("127.0.0.1");
+        thread = std::thread([this] { server.listen_after_bind(); });
+    }
+
+    ~MockServer() {
+        server.stop();
+        thread.join();
+    }
+
+    /**
+     * Get the shared server, started on first use
+     * @param payload Screen whose state /state serves from now on
+     */
+    static MockServer& serving(Screen payload) {
+        static MockServer instance;
+        instance.screen.store(payload, std::memory_order_relaxed);
+        return instance;
+    }
+
+    int port = 0;
+
+private:
+    httplib::Server server;
+    std::thread thread;
+    std::vector<std::string> json_bodies;
+    std::vector<std::string> msgpack_bodies;
+    std::atomic<Screen> screen{Screen::COMBAT};
+    std::atomic<uint64_t> action_id{0};
+};
+
+std::unique_ptr<SpireCommClient> connectedClient(benchmark::State& state, Screen screen,
+                                                 WireFormat format = WireFormat::JSON) {
+    ClientConfig config;
+    config.port = MockServer::serving(screen).port;
+    config.wire_format = format;
+    auto client = std::make_unique<SpireCommClient>(config);
+    if (!client->connect()) {
+        state.SkipWithError(("connect failed: " + client->getLastError()).c_str());
+        return nullptr;
+    }
+    return client;
+}
+
+// GET /state decoded into the JSON cache and the typed view
+void BM_RoundTripGetState(benchmark::State& state, Screen screen) {
+    auto client = connectedClient(state, screen);
+    if (!client) {
+        return;
+    }
+    for (auto _ : state) {
+        if (!client->getState()) {
+            state.SkipWithError(client->getLastError().c_str());
+            break;
+        }
+    }
+}
+
+// GET /state streamed into the typed view
+void BM_RoundTripFetchGameState(benchmark::State& state, Screen screen, WireFormat format) {
+    auto client = connectedClient(state, screen, format);
+    if (!client) {
+        return;
+    }
+    for (auto _ : state) {
+        if (!client->fetchGameState()) {
+            state.SkipWithError(client->getLastError().c_str());
+            break;
+        }
+    }
+}
+
+void BM_RoundTripSendAction(benchmark::State& state) {
+    auto client = connectedClient(state, Screen::COMBAT);
+    if (!client) {
+        return;
+    }
+    for (auto _ : state) {
+        if (!client->playCard(0, 1)) {
+            state.SkipWithError(client->getLastError().c_str());
+            break;
+        }
+    }
+}
+
+// One agent step: read the state, decide trivially, send the action
+void BM_RoundTripDecision(benchmark::State& state) {
+    auto client = connectedClient(state, Screen::COMBAT);
+    if (!client) {
+        return;
+    }
+    for (auto _ : state) {
+        if (!client->fetchGameState()) {
+            state.SkipWithError(client->getLastError().c_str());
+            break;
+        }
+        const GameState& game_state = client->getGameState();
+        bool sent = game_state.combat.hand.empty() ? client->endTurn() : client->playCard(0, 0);
+        if (!sent) {
+            state.SkipWithError(client->getLastError().c_str());
+            break;
+        }
+    }
+}
+
+} // anonymous namespace
+
+BENCHMARK_CAPTURE(BM_RoundTripGetState, combat, Screen::COMBAT)->UseRealTime();
+BENCHMARK_CAPTURE(BM_RoundTripGetState, map, Screen::MAP)->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_RoundTripFetchGameState, combat, Screen::COMBAT, WireFormat::JSON)->UseRealTime();
+BENCHMARK_CAPTURE(BM_RoundTripFetchGameState, map, Screen::MAP, WireFormat::JSON)->UseRealTime();
+BENCHMARK_CAPTURE(BM_RoundTripFetchGameState, shop, Screen::SHOP, WireFormat::JSON)->UseRealTime();
+BENCHMARK_CAPTURE(BM_RoundTripFetchGameState, grid, Screen::GRID, WireFormat::JSON)->UseRealTime();
+BENCHMARK_CAPTURE(BM_RoundTripFetchGameState, combat_msgpack, Screen::COMBAT, WireFormat::MSGPACK)->UseRealTime();
+
+BENCHMARK(BM_RoundTripSendAction)->UseRealTime();
+BENCHMARK(BM_RoundTripDecision)->UseRealTime();
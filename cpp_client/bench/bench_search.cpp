@@ -0,0 +1,203 @@
+/**
+ * Forward model and search cost, and search against the random baseline
+ *
+ * The combat is an Ironclad starter deck against a Jaw Worm and a Cultist,
+ * built directly in CombatSim. The random policy is the one
+ * simple_combat_ai.cpp plays: a uniformly random playable card, or END.
+ */
+
+#include <spirecomm/combat_sim.hpp>
+#include <spirecomm/search.hpp>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using json = nlohmann::json;
+using namespace spirecomm;
+
+SimCard card(const char* game_id, int8_t cost, CardType type, bool targeted) {
+    SimCard result;
+    result.id = CombatSim::cardId(game_id);
+    result.cost = cost;
+    result.type = type;
+    result.flags = targeted ? SimCard::TARGETED : 0;
+    if (std::string_view(game_id).find("Strike") != std::string_view::npos) {
+        result.flags |= SimCard::STRIKE;
+    }
+    return result;
+}
+
+CombatSim starterCombat(uint64_t seed) {
+    CombatSim sim;
+    sim.rng = seed * 0x9E3779B97F4A7C15ull | 1;
+    sim.player.hp = 80;
+    sim.player.max_hp = 80;
+    sim.player.energy = 3;
+
+    SimMonster& jaw_worm = sim.monsters[0];
+    jaw_worm.hp = jaw_worm.max_hp = 42;
+    jaw_worm.move_damage = 11;
+    jaw_worm.move_hits = 1;
+    jaw_worm.intent = Intent::ATTACK;
+    SimMonster& cultist = sim.monsters[1];
+    cultist.hp = cultist.max_hp = 50;
+    cultist.move_damage = 6;
+    cultist.move_hits = 1;
+    cultist.ritual = 3;
+    cultist.intent = Intent::ATTACK;
+    sim.num_monsters = 2;
+    for (size_t i = 2; i < CombatSim::kMaxMonsters; ++i) {
+        sim.monsters[i].is_gone = true;
+    }
+
+    std::vector<SimCard> deck;
+    for (int i = 0; i < 5; ++i) {
+        deck.push_back(card("Strike_R", 1, CardType::ATTACK, true));
+    }
+    for (int i = 0; i < 4; ++i) {
+        deck.push_back(card("Defend_R", 1, CardType::SKILL, false));
+    }
+    deck.push_back(card("Bash", 2, CardType::ATTACK, true));
+    std::mt19937_64 rng(seed);
+    std::shuffle(deck.begin(), deck.end(), rng);
+    for (size_t i = 0; i < deck.size(); ++i) {
+        if (i < 5) {
+            sim.hand.push(deck[i]);
+        } else {
+            sim.draw_pile.push(deck[i]);
+        }
+    }
+    return sim;
+}
+
+// One uniformly random playable card (and target), or END when there is none
+void randomStep(CombatSim& sim, std::mt19937_64& rng) {
+    int plays[CombatSim::kMaxHand * CombatSim::kMaxMonsters][2];
+    int count = 0;
+    for (int i = 0; i < static_cast<int>(sim.hand.size()); ++i) {
+        if (!sim.hand[static_cast<size_t>(i)].is(SimCard::TARGETED)) {
+            if (sim.canPlay(i)) {
+                plays[count][0] = i;
+                plays[count++][1] = -1;
+            }
+            continue;
+        }
+        for (int t = 0; t < sim.num_monsters; ++t) {
+            if (sim.canPlay(i, t)) {
+                plays[count][0] = i;
+                plays[count++][1] = t;
+            }
+        }
+    }
+    if (count == 0) {
+        sim.endTurn();
+        return;
+    }
+    int pick = static_cast<int>(rng() % static_cast<uint64_t>(count));
+    sim.playCard(plays[pick][0], plays[pick][1]);
+}
+
+void BM_SimCopy(benchmark::State& state) {
+    CombatSim root = starterCombat(1);
+    for (auto _ : state) {
+        CombatSim copy = root;
+        benchmark::DoNotOptimize(copy);
+    }
+    state.counters["bytes"] = static_cast<double>(sizeof(CombatSim));
+}
+
+// Random plays to the end of the combat; reports simulator steps per second
+void BM_SimRandomPlayout(benchmark::State& state) {
+    CombatSim root = starterCombat(1);
+    std::mt19937_64 rng(7);
+    uint64_t steps = 0;
+    for (auto _ : state) {
+        CombatSim sim = root;
+        while (!sim.isOver() && sim.turn < 50) {
+            randomStep(sim, rng);
+            ++steps;
+        }
+        benchmark::DoNotOptimize(sim);
+    }
+    state.counters["steps"] = benchmark::Counter(static_cast<double>(steps), benchmark::Counter::kIsRate);
+}
+
+// One decision with a fixed rollout count, by thread count
+void BM_SearchDecision(benchmark::State& state) {
+    SearchConfig config;
+    config.num_threads = static_cast<int>(state.range(0));
+    config.budget_ms = 10000;
+    config.max_iterations = 20000;
+    CombatSearch search(config);
+    CombatSim root = starterCombat(1);
+    uint64_t iterations = 0;
+    for (auto _ : state) {
+        SearchResult result = search.search(root);
+        iterations += result.iterations;
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["rollouts"] = benchmark::Counter(static_cast<double>(iterations), benchmark::Counter::kIsRate);
+}
+
+// Whole combats played by a policy; win rate and HP left are the quality numbers
+void BM_CombatRandomPolicy(benchmark::State& state) {
+    std::mt19937_64 rng(11);
+    uint64_t games = 0, wins = 0, hp = 0;
+    for (auto _ : state) {
+        CombatSim sim = starterCombat(games + 1);
+        while (!sim.isOver() && sim.turn < 50) {
+            randomStep(sim, rng);
+        }
+        ++games;
+        wins += sim.won();
+        hp += sim.won() ? static_cast<uint64_t>(sim.player.hp) : 0;
+    }
+    state.counters["win_rate"] = static_cast<double>(wins) / static_cast<double>(games);
+    state.counters["hp_left"] = static_cast<double>(hp) / static_cast<double>(games);
+}
+
+void BM_CombatSearchPolicy(benchmark::State& state) {
+    SearchConfig config;
+    config.budget_ms = 10000;
+    config.max_iterations = static_cast<uint64_t>(state.range(0));
+    CombatSearch search(config);
+    uint64_t games = 0, wins = 0, hp = 0;
+    for (auto _ : state) {
+        CombatSim sim = starterCombat(games + 1);
+        while (!sim.isOver() && sim.turn < 50) {
+            SearchResult result = search.search(sim);
+            if (result.status != SimStatus::OK) {
+                state.SkipWithError(result.error.c_str());
+                return;
+            }
+            // Replay the plan's indices on the simulator, as the client would send them
+            for (const Action& action : result.actions) {
+                if (action.type() == "end_turn") {
+                    sim.endTurn();
+                } else {
+                    json body = json::parse(action.body());
+                    sim.playCard(body["card_index"].get<int>(), body.value("target_index", -1));
+                }
+            }
+        }
+        ++games;
+        wins += sim.won();
+        hp += sim.won() ? static_cast<uint64_t>(sim.player.hp) : 0;
+    }
+    state.counters["win_rate"] = static_cast<double>(wins) / static_cast<double>(games);
+    state.counters["hp_left"] = static_cast<double>(hp) / static_cast<double>(games);
+}
+
+} // anonymous namespace
+
+BENCHMARK(BM_SimCopy);
+BENCHMARK(BM_SimRandomPlayout);
+BENCHMARK(BM_SearchDecision)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+BENCHMARK(BM_CombatRandomPolicy);
+BENCHMARK(BM_CombatSearchPolicy)->Arg(500)->Arg(5000)->UseRealTime();
@@ -0,0 +1,291 @@
+#include "payloads.hpp"
+#include <nlohmann/json.hpp>
+#include <array>
+
+namespace spirecomm::bench {
+
+namespace {
+
+using json = nlohmann::json;
+
+struct CardSpec {
+    const char* id;
+    const char* name;
+    const char* type;
+    const char* rarity;
+    int cost;
+    bool has_target;
+    bool exhausts;
+};
+
+// A 25-card Ironclad deck partway through act 2
+constexpr std::array<CardSpec, 25> kDeck = {{
+    {"Strike_R", "Strike", "ATTACK", "BASIC", 1, true, false},
+    {"Strike_R", "Strike", "ATTACK", "BASIC", 1, true, false},
+    {"Strike_R", "Strike", "ATTACK", "BASIC", 1, true, false},
+    {"Strike_R", "Strike", "ATTACK", "BASIC", 1, true, false},
+    {"Defend_R", "Defend", "SKILL", "BASIC", 1, false, false},
+    {"Defend_R", "Defend", "SKILL", "BASIC", 1, false, false},
+    {"Defend_R", "Defend", "SKILL", "BASIC", 1, false, false},
+    {"Defend_R", "Defend", "SKILL", "BASIC", 1, false, false},
+    {"Bash", "Bash", "ATTACK", "BASIC", 2, true, false},
+    {"Pommel Strike", "Pommel Strike", "ATTACK", "COMMON", 1, true, false},
+    {"Shrug It Off", "Shrug It Off", "SKILL", "COMMON", 1, false, false},
+    {"Twin Strike", "Twin Strike", "ATTACK", "COMMON", 1, true, false},
+    {"Anger", "Anger", "ATTACK", "COMMON", 0, true, false},
+    {"Armaments", "Armaments", "SKILL", "COMMON", 1, false, false},
+    {"Inflame", "Inflame", "POWER", "UNCOMMON", 1, false, false},
+    {"Uppercut", "Uppercut", "ATTACK", "UNCOMMON", 2, true, false},
+    {"Shockwave", "Shockwave", "SKILL", "UNCOMMON", 2, false, true},
+    {"Flame Barrier", "Flame Barrier", "SKILL", "UNCOMMON", 2, false, false},
+    {"Carnage", "Carnage", "ATTACK", "UNCOMMON", 2, true, false},
+    {"Battle Trance", "Battle Trance", "SKILL", "UNCOMMON", 0, false, false},
+    {"Whirlwind", "Whirlwind", "ATTACK", "UNCOMMON", -1, false, false},
+    {"Offering", "Offering", "SKILL", "RARE", 0, false, true},
+    {"Demon Form", "Demon Form", "POWER", "RARE", 3, false, false},
+    {"Impervious", "Impervious", "SKILL", "RARE", 2, false, true},
+    {"Ascender's Bane", "Ascender's Bane", "CURSE", "SPECIAL", -2, false, false},
+}};
+
+json card(const CardSpec& spec, int index, int price = 0) {
+    return {
+        {"id", spec.id},
+        {"name", spec.name},
+        {"type", spec.type},
+        {"rarity", spec.rarity},
+        {"upgrades", index % 4 == 0 ? 1 : 0},
+        {"has_target", spec.has_target},
+        {"cost", spec.cost},
+        {"uuid", "3f1c9a2e-7b4d-4e8a-9c61-" + std::to_string(100000000000 + index)},
+        {"misc", 0},
+        {"price", price},
+        {"is_playable", spec.cost >= -1},
+        {"exhausts", spec.exhausts}
+    };
+}
+
+json cards(int first, int count, int price = 0) {
+    json list = json::array();
+    for (int i = first; i < first + count; ++i) {
+        list.push_back(card(kDeck[i % kDeck.size()], i, price));
+    }
+    return list;
+}
+
+json relic(const char* id, int counter = -1, int price = 0) {
+    return {{"id", id}, {"name", id}, {"counter", counter}, {"price", price}};
+}
+
+json potion(const char* id, bool requires_target, int price = 0) {
+    bool empty = std::string_view(id) == "Potion Slot";
+    return {
+        {"id", id},
+        {"name", id},
+        {"can_use", !empty},
+        {"can_discard", !empty},
+        {"requires_target", requires_target},
+        {"price", price}
+    };
+}
+
+json power(const char* id, int amount, bool just_applied = false) {
+    return {
+        {"id", id},
+        {"name", id},
+        {"amount", amount},
+        {"damage", 0},
+        {"misc", 0},
+        {"just_applied", just_applied},
+        {"card", nullptr}
+    };
+}
+
+json node(int x, int y, const char* symbol) {
+    return {{"x", x}, {"y", y}, {"symbol", symbol}, {"children", json::array()}};
+}
+
+// 15 rows of up to 7 nodes, each linked to one to three nodes in the next row
+json dungeonMap() {
+    static const char* const kSymbols[] = {"M", "?", "M", "$", "M", "E", "?", "R", "M", "T"};
+    json map = json::array();
+    for (int y = 0; y < 15; ++y) {
+        for (int x = 0; x < 7; ++x) {
+            if ((x * 7 + y * 3) % 5 == 0) {
+                continue;  // Not every column has a node on every row
+            }
+            const char* symbol = y == 0 ? "M" : y == 8 ? "T" : y == 14 ? "R" : kSymbols[(x + y * 7) % 10];
+            json entry = node(x, y, symbol);
+            if (y < 14) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int child = x + dx;
+                    if (child >= 0 && child < 7 && (child + y) % 3 != 0) {
+                        entry["children"].push_back({{"x", child}, {"y", y + 1}});
+                    }
+                }
+            }
+            map.push_back(std::move(entry));
+        }
+    }
+    return map;
+}
+
+json monster(const char* name, const char* id, int max_hp, int hp, const char* intent, int damage, int hits,
+             int index, json powers) {
+    return {
+        {"name", name},
+        {"id", id},
+        {"max_hp", max_hp},
+        {"current_hp", hp},
+        {"block", index == 1 ? 12 : 0},
+        {"intent", intent},
+        {"half_dead", false},
+        {"is_gone", false},
+        {"move_id", 2},
+        {"last_move_id", 1},
+        {"second_last_move_id", 3},
+        {"move_base_damage", damage},
+        {"move_adjusted_damage", damage + 2},
+        {"move_hits", hits},
+        {"monster_index", index},
+        {"powers", std::move(powers)}
+    };
+}
+
+json combatState() {
+    return {
+        {"player", {
+            {"max_hp", 86},
+            {"current_hp", 54},
+            {"block", 7},
+            {"energy", 2},
+            {"powers", {power("Strength", 2), power("Vulnerable", 1, true), power("Flame Barrier", 4)}},
+            {"orbs", json::array()}
+        }},
+        {"monsters", {
+            monster("Centurion", "Centurion", 80, 61, "ATTACK", 12, 1, 0, {power("Strength", 3)}),
+            monster("Mystic", "Healer", 52, 45, "BUFF", -1, 0, 1, {power("Weakened", 2)}),
+            monster("Byrd", "Byrd", 28, 19, "ATTACK", 1, 5, 2, {power("Flight", 3), power("Vulnerable", 2)})
+        }},
+        {"draw_pile", cards(0, 12)},
+        {"discard_pile", cards(12, 6)},
+        {"exhaust_pile", cards(21, 1)},
+        {"hand", cards(18, 6)},
+        {"limbo", json::array()},
+        {"card_in_play", nullptr},
+        {"turn", 4},
+        {"cards_discarded_this_turn", 0},
+        {"times_damaged", 3}
+    };
+}
+
+json baseState(Screen screen) {
+    bool in_combat = screen == Screen::COMBAT;
+    json game_state = {
+        {"current_action", nullptr},
+        {"current_hp", 54},
+        {"max_hp", 86},
+        {"floor", 22},
+        {"act", 2},
+        {"gold", 312},
+        {"seed", 4612098763451234567},
+        {"character", "IRONCLAD"},
+        {"ascension_level", 10},
+        {"act_boss", "The Champ"},
+        {"relics", {
+            relic("Burning Blood"), relic("Vajra"), relic("Pen Nib", 7), relic("Bag of Preparation"),
+            relic("Kunai", 0), relic("Meat on the Bone"), relic("Shuriken", 0), relic("Ornamental Fan", 0)
+        }},
+        {"deck", cards(0, kDeck.size())},
+        {"potions", {potion("Fire Potion", true), potion("Block Potion", false), potion("Potion Slot", false)}},
+        {"map", dungeonMap()},
+        {"room_phase", in_combat ? "COMBAT" : "COMPLETE"},
+        {"room_type", in_combat ? "MonsterRoom" : screen == Screen::SHOP ? "ShopRoom" : "EventRoom"},
+        {"is_screen_up", !in_combat},
+        {"choice_available", !in_combat}
+    };
+    if (in_combat) {
+        game_state["combat_state"] = combatState();
+    }
+
+    json commands = in_combat ? json{"play", "end", "potion", "key", "click", "wait", "state"}
+                              : json{"choose", "key", "click", "wait", "state"};
+    if (screen == Screen::SHOP) {
+        commands.push_back("leave");
+    }
+    return {
+        {"in_game", true},
+        {"ready_for_command", true},
+        {"state_version", 1842},
+        {"last_action_id", 1791},
+        {"available_commands", std::move(commands)},
+        {"game_state", std::move(game_state)}
+    };
+}
+
+json screenState(Screen screen) {
+    switch (screen) {
+        case Screen::MAP:
+            return {
+                {"screen_type", "MAP"},
+                {"current_node", node(3, 6, "?")},
+                {"next_nodes", {node(2, 7, "R"), node(3, 7, "M"), node(4, 7, "E")}},
+                {"boss_available", false}
+            };
+        case Screen::SHOP:
+            return {
+                {"screen_type", "SHOP_SCREEN"},
+                {"cards", cards(9, 7, 75)},
+                {"relics", {relic("Orichalcum", -1, 165), relic("Letter Opener", -1, 247), relic("Membership Card", -1, 158)}},
+                {"potions", {potion("Strength Potion", false, 52), potion("Fear Potion", true, 50), potion("Ancient Potion", false, 74)}},
+                {"purge_available", true},
+                {"purge_cost", 100}
+            };
+        case Screen::GRID:
+            return {
+                {"screen_type", "GRID"},
+                {"cards", cards(0, kDeck.size())},
+                {"selected_cards", json::array()},
+                {"num_cards", 1},
+                {"any_number", false},
+                {"confirm_up", false},
+                {"for_upgrade", false},
+                {"for_transform", false},
+                {"for_purge", true}
+            };
+        case Screen::COMBAT:
+            break;
+    }
+    return {{"screen_type", "NONE"}};
+}
+
+std::string buildPayload(Screen screen) {
+    json state = baseState(screen);
+    json screen_json = screenState(screen);
+    state["game_state"]["screen_type"] = screen_json["screen_type"];
+    state["game_state"]["screen"] = std::move(screen_json);
+    return state.dump();
+}
+
+} // anonymous namespace
+
+std::string_view screenName(Screen screen) {
+    switch (screen) {
+        case Screen::COMBAT: return "combat";
+        case Screen::MAP:    return "map";
+        case Screen::SHOP:   return "shop";
+        case Screen::GRID:   return "grid";
+    }
+    return "unknown";
+}
+
+const std::string& statePayload(Screen screen) {
+    static const std::array<std::string, 4> payloads = {
+        buildPayload(Screen::COMBAT),
+        buildPayload(Screen::MAP),
+        buildPayload(Screen::SHOP),
+        buildPayload(Screen::GRID)
+    };
+    return payloads[static_cast<size_t>(screen)];
+}
+
+} // namespace spirecomm::bench
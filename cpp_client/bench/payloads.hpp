@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace spirecomm::bench {
+
+/**
+ * Screens with a representative /state payload
+ */
+enum class Screen {
+    COMBAT,  // Three monsters mid-fight, full piles
+    MAP,     // Map screen with the whole act's map
+    SHOP,    // Shop screen with a full stock of cards, relics and potions
+    GRID     // Card selection over the deck (e.g. a purge)
+};
+
+std::string_view screenName(Screen screen);
+
+/**
+ * Get the /state response body for a screen
+ * All payloads are the same mid-run Ironclad (act 2, 25-card deck, full map),
+ * serialized the way http_server.py does. Built once on first use.
+ */
+const std::string& statePayload(Screen screen);
+
+} // namespace spirecomm::bench
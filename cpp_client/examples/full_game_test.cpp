@@ -9,6 +9,11 @@
  *
  * Usage:
  *   ./full_game_test [--port 8080] [--host 127.0.0.1] [--verbose] [--character IRONCLAD] [--ascension 0]
+ *                    [--games 1]
+ *
+ * As a load test, run it against `python -m spirecomm.http_server --mock`:
+ * every action is answered instantly, so the reported actions per second
+ * measure the client, the HTTP layer and the coordinator queue alone.
  */
 
 #include <spirecomm/client.hpp>
@@ -20,6 +25,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <cstdio>
 
 namespace {
 using json = nlohmann::json;
@@ -29,8 +35,8 @@ using namespace spirecomm;
 std::random_device rd;
 std::mt19937 rng(rd());
 
-template<typename T>
-const T& random_choice(const std::vector<T>& vec) {
+template<typename Container>
+const auto& random_choice(const Container& vec) {
     std::uniform_int_distribution<size_t> dist(0, vec.size() - 1);
     return vec[dist(rng)];
 }
@@ -65,6 +71,7 @@ public:
           verbose_(verbose),
           actions_taken_(0),
           floors_completed_(0),
+          games_played_(0),
           leave_shop_flag_(false) {}
 
     void log(const std::string& message) {
@@ -96,6 +103,10 @@ public:
         return client_.getState();
     }
 
+    std::optional<json> waitForState(uint64_t since_version, int timeout_ms = 1000) {
+        return client_.waitForState(since_version, timeout_ms);
+    }
+
     bool startGame(const std::string& character = "IRONCLAD", int ascension = 0) {
         print("Starting new game as " + character + " (Ascension " + std::to_string(ascension) + ")...");
         bool success = client_.startGame(character, ascension);
@@ -103,67 +114,45 @@ public:
         return success;
     }
 
-    bool handleCombat(const json& state) {
-        auto game_state = state["game_state"];
-        
+    bool handleCombat(const GameState& state) {
         // Check for combat_state instead of in_combat
-        if (!game_state.contains("combat_state")) {
+        if (!state.in_combat) {
             return false;
         }
-        auto combat_state = game_state["combat_state"];
-
-        auto commands = client_.getAvailableCommands();
-        auto hand = combat_state.value("hand", json::array());
-        auto monsters = combat_state.value("monsters", json::array());
-
-        // Filter alive monsters
-        std::vector<int> alive_monster_indices;
-        for (size_t i = 0; i < monsters.size(); i++) {
-            auto m = monsters[i];
-            if (!m.value("is_gone", false) && !m.value("half_dead", false)) {
-                alive_monster_indices.push_back(i);
-            }
-        }
+        const CombatState& combat = state.combat;
 
         // 10% chance to end turn
-        if (hasCommand(commands, "end") && random_float() < 0.1) {
+        if (state.hasCommand(Command::END) && random_float() < 0.1) {
             print("  -> Ending turn");
             bool success = client_.endTurn();
             if (success) actions_taken_++;
             return success;
         }
 
-        // Try to play a random playable card
-        if (hasCommand(commands, "play") && !hand.empty()) {
-            std::vector<int> playable_indices;
-            for (size_t i = 0; i < hand.size(); i++) {
-                if (hand[i].value("is_playable", false)) {
-                    playable_indices.push_back(i);
-                }
+        // Try a random card and target among the legal plays
+        // Per-decision lists live in the client's state arena, reset with the next state
+        ArenaVector<LegalAction> plays(client_.stateArena());
+        for (const LegalAction& action : client_.legalActions()) {
+            if (action.kind == ActionKind::PLAY_CARD) {
+                plays.push_back(action);
             }
+        }
 
-            if (!playable_indices.empty()) {
-                int card_index = random_choice(playable_indices);
-                auto card = hand[card_index];
-                std::string card_name = card.value("name", "?");
-
-                if (card.value("has_target", false) && !alive_monster_indices.empty()) {
-                    int target_index = random_choice(alive_monster_indices);
-                    print("  -> Playing " + card_name + " targeting monster " + std::to_string(target_index));
-                    bool success = client_.playCard(card_index, target_index);
-                    if (success) actions_taken_++;
-                    return success;
-                } else {
-                    print("  -> Playing " + card_name);
-                    bool success = client_.playCard(card_index);
-                    if (success) actions_taken_++;
-                    return success;
-                }
+        if (!plays.empty()) {
+            const LegalAction& play = random_choice(plays);
+            std::string card_name(state.str(combat.hand[play.index].name));
+            if (play.target >= 0) {
+                print("  -> Playing " + card_name + " targeting monster " + std::to_string(play.target));
+            } else {
+                print("  -> Playing " + card_name);
             }
+            bool success = client_.sendAction(play.toAction(state));
+            if (success) actions_taken_++;
+            return success;
         }
 
         // Can't play cards, end turn
-        if (hasCommand(commands, "end")) {
+        if (state.hasCommand(Command::END)) {
             print("  -> Ending turn (no playable cards)");
             bool success = client_.endTurn();
             if (success) actions_taken_++;
@@ -173,14 +162,11 @@ public:
         return false;
     }
 
-    bool handleMap(const json& state) {
-        auto game_state = state["game_state"];
-        auto screen = game_state.value("screen", json::object());
-        auto next_nodes = screen.value("next_nodes", json::array());
-        bool boss_available = screen.value("boss_available", false);
+    bool handleMap(const GameState& state) {
+        const ScreenState& screen = state.screen;
 
         // Small chance to go to boss
-        if (boss_available && random_float() < 0.2) {
+        if (screen.boss_available && random_float() < 0.2) {
             print("  -> Choosing boss node");
             bool success = client_.chooseMapBoss();
             if (success) actions_taken_++;
@@ -188,11 +174,10 @@ public:
         }
 
         // Choose random next node
-        if (!next_nodes.empty()) {
-            int choice_index = random_int(0, next_nodes.size() - 1);
-            auto node = next_nodes[choice_index];
-            std::string symbol = node.value("symbol", "?");
-            print("  -> Choosing map node " + std::to_string(choice_index) + " to " + symbol);
+        if (!screen.next_nodes.empty()) {
+            int choice_index = random_int(0, screen.next_nodes.size() - 1);
+            const MapNode& node = screen.next_nodes[choice_index];
+            print("  -> Choosing map node " + std::to_string(choice_index) + " to " + std::string(1, node.symbol));
             bool success = client_.choose(choice_index);
             if (success) actions_taken_++;
             return success;
@@ -201,15 +186,11 @@ public:
         return false;
     }
 
-    bool handleCardReward(const json& state) {
-        auto game_state = state["game_state"];
-        auto screen = game_state.value("screen", json::object());
-        auto cards = screen.value("cards", json::array());
-        bool can_bowl = screen.value("can_bowl", false);
-        bool can_skip = screen.value("can_skip", false);
+    bool handleCardReward(const GameState& state) {
+        const ScreenState& screen = state.screen;
 
         // 20% chance to use bowl
-        if (can_bowl && random_float() < 0.2) {
+        if (screen.can_bowl && random_float() < 0.2) {
             print("  -> Using Singing Bowl");
             bool success = client_.cardReward("", true);
             if (success) actions_taken_++;
@@ -217,7 +198,7 @@ public:
         }
 
         // 30% chance to skip
-        if (can_skip && random_float() < 0.3) {
+        if (screen.can_skip && random_float() < 0.3) {
             print("  -> Skipping card reward");
             bool success = client_.proceed();
             if (success) actions_taken_++;
@@ -225,12 +206,11 @@ public:
         }
 
         // Choose random card
-        if (!cards.empty()) {
-            std::vector<json> cards_vec(cards.begin(), cards.end());
-            auto card = random_choice(cards_vec);
-            std::string card_name = card["name"];
+        if (!screen.cards.empty()) {
+            const Card& card = random_choice(screen.cards);
+            std::string card_name(state.str(card.name));
             print("  -> Choosing card: " + card_name);
-            bool success = client_.cardReward(card_name);
+            bool success = client_.cardReward(card.id);
             if (success) actions_taken_++;
             return success;
         }
@@ -238,10 +218,8 @@ public:
         return false;
     }
 
-    bool handleCombatReward(const json& state) {
-        auto game_state = state["game_state"];
-        auto screen = game_state.value("screen", json::object());
-        auto rewards = screen.value("rewards", json::array());
+    bool handleCombatReward(const GameState& state) {
+        const auto& rewards = state.screen.rewards;
 
         if (rewards.empty()) {
             print("  -> No rewards left, proceeding");
@@ -251,23 +229,19 @@ public:
         }
 
         int reward_index = random_int(0, rewards.size() - 1);
-        auto reward = rewards[reward_index];
-        std::string reward_type = reward["reward_type"];
+        std::string reward_type(toString(rewards[reward_index].type));
         print("  -> Choosing reward " + std::to_string(reward_index) + ": " + reward_type);
         bool success = client_.combatReward(reward_index);
         if (success) actions_taken_++;
         return success;
     }
 
-    bool handleBossReward(const json& state) {
-        auto game_state = state["game_state"];
-        auto screen = game_state.value("screen", json::object());
-        auto relics = screen.value("relics", json::array());
+    bool handleBossReward(const GameState& state) {
+        const auto& relics = state.screen.relics;
 
         if (!relics.empty()) {
-            std::vector<json> relics_vec(relics.begin(), relics.end());
-            auto relic = random_choice(relics_vec);
-            std::string relic_name = relic["name"];
+            const Relic& relic = random_choice(relics);
+            std::string relic_name(state.str(relic.name));
             print("  -> Choosing boss relic: " + relic_name);
             bool success = client_.bossReward(relic_name);
             if (success) actions_taken_++;
@@ -277,13 +251,10 @@ public:
         return false;
     }
 
-    bool handleRest(const json& state) {
-        auto game_state = state["game_state"];
-        auto screen = game_state.value("screen", json::object());
-        auto rest_options = screen.value("rest_options", json::array());
-        bool has_rested = screen.value("has_rested", false);
+    bool handleRest(const GameState& state) {
+        const ScreenState& screen = state.screen;
 
-        if (has_rested || rest_options.empty()) {
+        if (screen.has_rested || screen.rest_options.empty()) {
             print("  -> Already rested, proceeding");
             bool success = client_.proceed();
             if (success) actions_taken_++;
@@ -291,11 +262,7 @@ public:
         }
 
         // Choose random rest option
-        std::vector<std::string> options_vec;
-        for (const auto& opt : rest_options) {
-            options_vec.push_back(opt.get<std::string>());
-        }
-        std::string option = random_choice(options_vec);
+        std::string option(toString(random_choice(screen.rest_options)));
         std::transform(option.begin(), option.end(), option.begin(), ::tolower);
         print("  -> Choosing rest option: " + option);
         bool success = client_.rest(option);
@@ -303,7 +270,7 @@ public:
         return success;
     }
 
-    bool handleShopRoom(const json& state) {
+    bool handleShopRoom(const GameState& state) {
         if (leave_shop_flag_) {
             print("  -> Leaving shop");
             leave_shop_flag_ = false;
@@ -317,10 +284,9 @@ public:
         return success;
     }
 
-    bool handleShop(const json& state) {
-        auto game_state = state["game_state"];
-        auto screen = game_state.value("screen", json::object());
-        int gold = game_state.value("gold", 0);
+    bool handleShop(const GameState& state) {
+        const ScreenState& screen = state.screen;
+        int gold = state.gold;
 
         // 50% chance to leave immediately
         if (random_float() < 0.5) {
@@ -332,61 +298,55 @@ public:
         }
 
         // Try to buy something
-        std::vector<std::pair<std::string, json>> buyable_items;
-
-        for (const auto& card : screen.value("cards", json::array())) {
-            if (card.value("price", 999) <= gold) {
-                buyable_items.push_back({"card", card});
+        struct ShopItem {
+            std::string type;
+            std::string name;
+            int price;
+        };
+        std::vector<ShopItem> buyable_items;
+
+        for (const auto& card : screen.cards) {
+            if (card.price <= gold) {
+                buyable_items.push_back({"card", std::string(state.str(card.name)), card.price});
             }
         }
 
-        for (const auto& relic : screen.value("relics", json::array())) {
-            if (relic.value("price", 999) <= gold) {
-                buyable_items.push_back({"relic", relic});
+        for (const auto& relic : screen.relics) {
+            if (relic.price <= gold) {
+                buyable_items.push_back({"relic", std::string(state.str(relic.name)), relic.price});
             }
         }
 
-        for (const auto& potion : screen.value("potions", json::array())) {
-            if (potion.value("price", 999) <= gold) {
-                buyable_items.push_back({"potion", potion});
+        for (const auto& potion : screen.potions) {
+            if (potion.price <= gold) {
+                buyable_items.push_back({"potion", std::string(state.str(potion.name)), potion.price});
             }
         }
 
-        if (screen.value("purge_available", false)) {
-            int purge_cost = screen.value("purge_cost", 75);
-            if (purge_cost <= gold) {
-                json purge_item = {{"price", purge_cost}};
-                buyable_items.push_back({"purge", purge_item});
-            }
+        if (screen.purge_available && screen.purge_cost <= gold) {
+            buyable_items.push_back({"purge", "", screen.purge_cost});
         }
 
         if (!buyable_items.empty()) {
-            auto [item_type, item] = random_choice(buyable_items);
+            const ShopItem& item = random_choice(buyable_items);
 
-            if (item_type == "card") {
-                std::string name = item["name"];
-                int price = item["price"];
-                print("  -> Buying card: " + name + " for " + std::to_string(price) + " gold");
-                bool success = client_.buyCard(name);
+            if (item.type == "card") {
+                print("  -> Buying card: " + item.name + " for " + std::to_string(item.price) + " gold");
+                bool success = client_.buyCard(item.name);
                 if (success) actions_taken_++;
                 return success;
-            } else if (item_type == "relic") {
-                std::string name = item["name"];
-                int price = item["price"];
-                print("  -> Buying relic: " + name + " for " + std::to_string(price) + " gold");
-                bool success = client_.buyRelic(name);
+            } else if (item.type == "relic") {
+                print("  -> Buying relic: " + item.name + " for " + std::to_string(item.price) + " gold");
+                bool success = client_.buyRelic(item.name);
                 if (success) actions_taken_++;
                 return success;
-            } else if (item_type == "potion") {
-                std::string name = item["name"];
-                int price = item["price"];
-                print("  -> Buying potion: " + name + " for " + std::to_string(price) + " gold");
-                bool success = client_.buyPotion(name);
+            } else if (item.type == "potion") {
+                print("  -> Buying potion: " + item.name + " for " + std::to_string(item.price) + " gold");
+                bool success = client_.buyPotion(item.name);
                 if (success) actions_taken_++;
                 return success;
-            } else if (item_type == "purge") {
-                int price = item["price"];
-                print("  -> Buying card removal for " + std::to_string(price) + " gold");
+            } else if (item.type == "purge") {
+                print("  -> Buying card removal for " + std::to_string(item.price) + " gold");
                 bool success = client_.buyPurge();
                 if (success) actions_taken_++;
                 return success;
@@ -402,24 +362,22 @@ public:
         return false;
     }
 
-    bool handleEvent(const json& state) {
-        auto game_state = state["game_state"];
-        auto screen = game_state.value("screen", json::object());
-        auto options = screen.value("options", json::array());
-        std::string event_name = screen.value("event_name", "Unknown Event");
+    bool handleEvent(const GameState& state) {
+        const ScreenState& screen = state.screen;
+        std::string event_name = screen.event_name.empty() ? "Unknown Event" : std::string(state.str(screen.event_name));
 
         // Filter enabled options
-        std::vector<json> enabled_options;
-        for (const auto& opt : options) {
-            if (!opt.value("disabled", false)) {
+        ArenaVector<EventOption> enabled_options(client_.stateArena());
+        for (const auto& opt : screen.options) {
+            if (!opt.disabled) {
                 enabled_options.push_back(opt);
             }
         }
 
         if (!enabled_options.empty()) {
-            auto option = random_choice(enabled_options);
-            int choice_index = option.value("choice_index", 0);
-            std::string label = option.value("label", "?");
+            const EventOption& option = random_choice(enabled_options);
+            int choice_index = option.choice_index >= 0 ? option.choice_index : 0;
+            std::string label = option.label.empty() ? "?" : std::string(state.str(option.label));
             print("  -> Event '" + event_name + "': choosing option " + std::to_string(choice_index) + " (" + label + ")");
             bool success = client_.eventOption(choice_index);
             if (success) actions_taken_++;
@@ -429,12 +387,8 @@ public:
         return false;
     }
 
-    bool handleChest(const json& state) {
-        auto game_state = state["game_state"];
-        auto screen = game_state.value("screen", json::object());
-        bool chest_open = screen.value("chest_open", false);
-
-        if (chest_open) {
+    bool handleChest(const GameState& state) {
+        if (state.screen.chest_open) {
             print("  -> Chest already open, proceeding");
             bool success = client_.proceed();
             if (success) actions_taken_++;
@@ -447,20 +401,15 @@ public:
         }
     }
 
-    bool handleGridSelect(const json& state) {
-        auto game_state = state["game_state"];
-        auto screen = game_state.value("screen", json::object());
-        auto cards = screen.value("cards", json::array());
-        auto selected_cards = screen.value("selected_cards", json::array());
-        int num_cards = screen.value("num_cards", 1);
-        bool any_number = screen.value("any_number", false);
-        bool can_pick_zero = screen.value("can_pick_zero", false);
+    bool handleGridSelect(const GameState& state) {
+        const ScreenState& screen = state.screen;
+        int num_cards = screen.num_cards;
 
-        int num_selected = selected_cards.size();
+        int num_selected = screen.selected_cards.size();
         int num_remaining = num_cards - num_selected;
 
         // If enough selected, or randomly skip
-        if (num_remaining <= 0 || (can_pick_zero && random_float() < 0.3)) {
+        if (num_remaining <= 0 || (screen.can_pick_zero && random_float() < 0.3)) {
             print("  -> Confirming card selection");
             bool success = client_.proceed();
             if (success) actions_taken_++;
@@ -468,17 +417,17 @@ public:
         }
 
         // Build list of available cards (not already selected)
-        std::vector<json> available_cards;
-        for (const auto& card : cards) {
+        ArenaVector<std::string_view> available_cards(client_.stateArena());
+        for (const auto& card : screen.cards) {
             bool is_selected = false;
-            for (const auto& sel : selected_cards) {
-                if (card["name"] == sel["name"]) {
+            for (const auto& sel : screen.selected_cards) {
+                if (state.str(card.name) == state.str(sel.name)) {
                     is_selected = true;
                     break;
                 }
             }
             if (!is_selected) {
-                available_cards.push_back(card);
+                available_cards.emplace_back(state.str(card.name));
             }
         }
 
@@ -490,7 +439,7 @@ public:
         }
 
         // Select 1 to num_remaining cards
-        int num_to_select = any_number ?
+        int num_to_select = screen.any_number ?
             random_int(1, std::min(num_remaining, (int)available_cards.size())) :
             std::min(num_remaining, (int)available_cards.size());
 
@@ -498,7 +447,7 @@ public:
         std::shuffle(available_cards.begin(), available_cards.end(), rng);
 
         for (int i = 0; i < num_to_select && i < available_cards.size(); i++) {
-            card_names.push_back(available_cards[i]["name"]);
+            card_names.emplace_back(available_cards[i]);
         }
 
         print("  -> Selecting " + std::to_string(card_names.size()) + " cards");
@@ -507,7 +456,7 @@ public:
         return success;
     }
 
-    bool run(const std::string& character = "IRONCLAD", int ascension = 0) {
+    bool run(const std::string& character = "IRONCLAD", int ascension = 0, int games = 1) {
         print("Checking server connection...");
         
         for (int attempt = 0; attempt < 10; attempt++) {
@@ -527,7 +476,7 @@ public:
         std::this_thread::sleep_for(std::chrono::seconds(1));
 
         auto state = getState();
-        if (state && state->value("in_game", false)) {
+        if (state && client_.isInGame()) {
             print("Already in a game, continuing from current state...");
         } else {
             print("Not in game, starting new game...");
@@ -542,54 +491,58 @@ public:
         int consecutive_failures = 0;
         const int max_failures = 100;
 
+        uint64_t version = 0;
+        bool force_refresh = true;
+        int starting_actions = actions_taken_;
+        auto started = std::chrono::steady_clock::now();
+
         while (consecutive_failures < max_failures) {
-            auto state_opt = getState();
+            // Long-poll for the next state; after a failed action re-read the current one
+            auto state_opt = force_refresh ? getState() : waitForState(version);
+            force_refresh = false;
             if (!state_opt) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                if (!client_.isConnected()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
                 continue;
             }
 
-            auto state = *state_opt;
+            const GameState& state = client_.getGameState();
+            version = state.state_version;
 
-            if (!state.value("ready_for_command", false)) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (!state.ready_for_command) {
                 continue;
             }
 
-            if (!state.value("in_game", false)) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (!state.in_game) {
+                // Back at the main menu after a game over
+                if (games_played_ < games && !startGame(character, ascension)) {
+                    consecutive_failures++;
+                    force_refresh = true;
+                }
                 continue;
             }
 
-            auto game_state = state["game_state"];
-            std::string screen_type = game_state.value("screen_type", "NONE");
-            std::string room_type = game_state.value("room_type", "NONE");
-            std::string room_phase = game_state.value("room_phase", "INCOMPLETE");
+            ScreenType screen_type = state.screen_type;
 
             // Track floor progression
-            int floor = game_state.value("floor", 0);
-            if (floor > floors_completed_) {
-                floors_completed_ = floor;
-                int act = game_state.value("act", 0);
-                int current_hp = game_state.value("current_hp", 0);
-                int max_hp = game_state.value("max_hp", 0);
-                int gold = game_state.value("gold", 0);
+            if (state.floor > floors_completed_) {
+                floors_completed_ = state.floor;
 
                 print("\n" + std::string(60, '='));
-                print("Floor " + std::to_string(floor) + " | Act " + std::to_string(act) +
-                      " | HP: " + std::to_string(current_hp) + "/" + std::to_string(max_hp) +
-                      " | Gold: " + std::to_string(gold));
-                print("Screen: " + screen_type +
-                      " | Room: " + room_type + 
-                      " | Phase: " + room_phase);
+                print("Floor " + std::to_string(state.floor) + " | Act " + std::to_string(state.act) +
+                      " | HP: " + std::to_string(state.current_hp) + "/" + std::to_string(state.max_hp) +
+                      " | Gold: " + std::to_string(state.gold));
+                print("Screen: " + std::string(toString(screen_type)) +
+                      " | Room: " + std::string(toString(state.room_type)) +
+                      " | Phase: " + std::string(toString(state.room_phase)));
                 print(std::string(60, '='));
             }
 
             // Handle game over
-            if (screen_type == "GAME_OVER") {
-                auto screen = game_state.value("screen", json::object());
-                bool victory = screen.value("victory", false);
-                int score = screen.value("score", 0);
+            if (screen_type == ScreenType::GAME_OVER) {
+                bool victory = state.screen.victory;
+                int score = state.screen.score;
 
                 print("\n" + std::string(60, '='));
                 print("GAME OVER - " + std::string(victory ? "VICTORY!" : "Defeat"));
@@ -597,10 +550,21 @@ public:
                 print("Actions taken: " + std::to_string(actions_taken_));
                 print("Floors completed: " + std::to_string(floors_completed_));
                 print(std::string(60, '='));
-                break;
+
+                if (++games_played_ >= games) {
+                    break;
+                }
+                floors_completed_ = 0;
+                if (client_.proceed()) {
+                    actions_taken_++;
+                } else {
+                    consecutive_failures++;
+                    force_refresh = true;
+                }
+                continue;
             }
 
-            if (screen_type == "COMPLETE") {
+            if (screen_type == ScreenType::COMPLETE) {
                 print("\nRun complete!");
                 break;
             }
@@ -609,42 +573,51 @@ public:
             bool success = false;
 
             // Check for combat using room_type and room_phase (like Python version)
-            if ((room_type == "MonsterRoom" || room_type == "MonsterEliteRoom" || room_type == "MonsterBossRoom") 
-                && room_phase == "COMBAT") {
+            bool in_monster_room = state.room_type == RoomType::MONSTER ||
+                                   state.room_type == RoomType::MONSTER_ELITE ||
+                                   state.room_type == RoomType::MONSTER_BOSS;
+            if (in_monster_room && state.room_phase == RoomPhase::COMBAT) {
                 success = handleCombat(state);
-            } else if (screen_type == "MAP") {
+            } else if (screen_type == ScreenType::MAP) {
                 success = handleMap(state);
-            } else if (screen_type == "CARD_REWARD") {
+            } else if (screen_type == ScreenType::CARD_REWARD) {
                 success = handleCardReward(state);
-            } else if (screen_type == "COMBAT_REWARD") {
+            } else if (screen_type == ScreenType::COMBAT_REWARD) {
                 success = handleCombatReward(state);
-            } else if (screen_type == "BOSS_REWARD") {
+            } else if (screen_type == ScreenType::BOSS_REWARD) {
                 success = handleBossReward(state);
-            } else if (screen_type == "REST") {
+            } else if (screen_type == ScreenType::REST) {
                 success = handleRest(state);
-            } else if (screen_type == "SHOP_ROOM") {
+            } else if (screen_type == ScreenType::SHOP_ROOM) {
                 success = handleShopRoom(state);
-            } else if (screen_type == "SHOP_SCREEN") {
+            } else if (screen_type == ScreenType::SHOP_SCREEN) {
                 success = handleShop(state);
-            } else if (screen_type == "EVENT") {
+            } else if (screen_type == ScreenType::EVENT) {
                 success = handleEvent(state);
-            } else if (screen_type == "CHEST") {
+            } else if (screen_type == ScreenType::CHEST) {
                 success = handleChest(state);
-            } else if (screen_type == "GRID" || screen_type == "HAND_SELECT") {
+            } else if (screen_type == ScreenType::GRID || screen_type == ScreenType::HAND_SELECT) {
                 success = handleGridSelect(state);
             } else {
-                log("Unknown screen type: " + screen_type);
+                log("Unknown screen type: " + std::string(toString(screen_type)));
             }
 
             if (success) {
                 consecutive_failures = 0;
-                std::this_thread::sleep_for(std::chrono::milliseconds(200));
             } else {
                 consecutive_failures++;
                 std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                force_refresh = true;
             }
         }
 
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        int actions = actions_taken_ - starting_actions;
+        char rate[128];
+        std::snprintf(rate, sizeof(rate), "%d actions in %.2fs (%.1f actions/s) over %d game(s)",
+                      actions, seconds, seconds > 0 ? actions / seconds : 0.0, games_played_);
+        print(rate);
+
         if (consecutive_failures >= max_failures) {
             std::cerr << "\nERROR: " << max_failures << " consecutive action failures, stopping test" << std::endl;
             return false;
@@ -659,11 +632,8 @@ private:
     bool verbose_;
     int actions_taken_;
     int floors_completed_;
+    int games_played_;
     bool leave_shop_flag_;
-
-    bool hasCommand(const std::vector<std::string>& commands, const std::string& cmd) {
-        return std::find(commands.begin(), commands.end(), cmd) != commands.end();
-    }
 };
 
 
@@ -674,6 +644,7 @@ int main(int argc, char* argv[]) {
     bool verbose = false;
     std::string character = "IRONCLAD";
     int ascension = 0;
+    int games = 1;
 
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -687,6 +658,8 @@ int main(int argc, char* argv[]) {
             character = argv[++i];
         } else if (arg == "--ascension" && i + 1 < argc) {
             ascension = std::stoi(argv[++i]);
+        } else if (arg == "--games" && i + 1 < argc) {
+            games = std::stoi(argv[++i]);
         } else if (arg == "--help" || arg == "-h") {
             std::cout << "Usage: " << argv[0] << " [OPTIONS]\n"
                       << "\nOptions:\n"
@@ -695,6 +668,7 @@ int main(int argc, char* argv[]) {
                       << "  --verbose             Enable verbose logging\n"
                       << "  --character CHAR      Character (IRONCLAD, THE_SILENT, DEFECT, WATCHER)\n"
                       << "  --ascension LEVEL     Ascension level 0-20 (default: 0)\n"
+                      << "  --games N             Games to play back to back (default: 1)\n"
                       << "  --help, -h            Show this help message\n";
             return 0;
         }
@@ -706,6 +680,6 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    bool success = client.run(character, ascension);
+    bool success = client.run(character, ascension, games);
     return success ? 0 : 1;
 }
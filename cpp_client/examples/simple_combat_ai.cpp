@@ -3,30 +3,41 @@
  *
  * Demonstrates how to use SpireCommClient to interface with Slay the Spire.
  * This AI implements basic random combat logic: randomly plays playable cards
- * or ends turn, and proceeds through other screens.
+ * or ends turn, and proceeds through other screens. With --search it plans
+ * each turn with CombatSearch instead, falling back to random play for
+ * combats the simulator does not model.
  *
  * Usage:
  *   1. Start Slay the Spire with Communication Mod configured to run http_server.py
  *   2. Run this executable: ./simple_ai
  *   3. Start a run in the game
  *   4. Watch the AI play!
+ *
+ *   ./simple_ai --search 100    # Search each turn for 100 ms
  */
 
 #include <spirecomm/client.hpp>
-#include <nlohmann/json.hpp>
+#include <spirecomm/search.hpp>
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <memory>
 #include <random>
 
 namespace {
-using json = nlohmann::json;
 using namespace spirecomm;
 } // anonymous namespace
 
 class SimpleAI {
 public:
-    SimpleAI(const ClientConfig& config) : client(config), rng(std::random_device{}()) {}
+    SimpleAI(const ClientConfig& config, int search_ms)
+        : client(config), rng(std::random_device{}()), replaying(!config.replay_path.empty()) {
+        if (search_ms > 0) {
+            SearchConfig search_config;
+            search_config.budget_ms = search_ms;
+            search = std::make_unique<CombatSearch>(search_config);
+        }
+    }
 
     bool initialize() {
         std::cout << "Connecting to server..." << std::endl;
@@ -42,47 +53,54 @@ public:
     }
 
     void run() {
-        while (true) {
-            // Get latest state
-            auto state_opt = client.getState();
+        uint64_t version = 0;
 
-            if (!state_opt) {
-                // No state available, wait briefly
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        while (true) {
+            // Block until the state changes instead of sleep-polling; only the
+            // typed state is used, so skip building the JSON DOM
+            if (!client.waitForGameState(version, 1000)) {
+                // Timed out without a change; back off only if the server is unreachable
+                if (!client.isConnected()) {
+                    if (replaying) {
+                        std::cout << "Replay finished: " << client.getStats().toString() << std::endl;
+                        return;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
                 continue;
             }
 
+            // Typed view of the state, parsed once by the client
+            const GameState& state = client.getGameState();
+            version = state.state_version;
+
             // Check if game is ready for command
-            if (!client.isReadyForCommand()) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            if (!state.ready_for_command) {
                 continue;
             }
 
-            // Get state
-            auto state = *state_opt;
-
             // Log current status
             logStatus(state);
 
             // Make decision based on available commands
-            auto commands = client.getAvailableCommands();
-
-            if (hasCommand(commands, "play")) {
+            if (state.hasCommand(Command::PLAY) && search && makeSearchedCombatDecision(state)) {
+                continue;
+            }
+            if (state.hasCommand(Command::PLAY)) {
                 // In combat - random card play
                 if (makeRandomCombatDecision(state)) {
-                    // Made a move, continue
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    // Made a move, wait for the resulting state
                     continue;
                 }
             }
 
             // Default actions for non-combat screens
-            if (hasCommand(commands, "end")) {
+            if (state.hasCommand(Command::END)) {
                 // End turn in combat
                 std::cout << "  -> Ending turn" << std::endl;
                 client.endTurn();
 
-            } else if (hasCommand(commands, "proceed")) {
+            } else if (state.hasCommand(Command::PROCEED)) {
                 // Proceed to next screen
                 std::cout << "  -> Proceeding" << std::endl;
                 client.proceed();
@@ -91,114 +109,74 @@ public:
                 // No known command available, just wait
                 std::cout << "  -> Waiting (no action available)" << std::endl;
             }
-
-            // Wait before next decision
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
     }
 
 private:
     SpireCommClient client;
     std::mt19937 rng;
+    bool replaying;  // Playing a recorded trace: stop at its end
+    std::unique_ptr<CombatSearch> search;  // Set with --search
 
-    void logStatus(const json& state) {
-        try {
-            if (state.contains("game_state")) {
-                auto game_state = state["game_state"];
-                int floor = game_state.value("floor", 0);
-                int hp = game_state.value("current_hp", 0);
-                int max_hp = game_state.value("max_hp", 0);
-                std::string screen_type = game_state.value("screen_type", "UNKNOWN");
-
-                std::cout << "Floor " << floor << " | " << screen_type
-                          << " | HP: " << hp << "/" << max_hp << std::endl;
-            }
-        } catch (...) {
-            // Ignore logging errors
+    void logStatus(const GameState& state) {
+        if (state.has_game_state) {
+            std::cout << "Floor " << state.floor << " | " << toString(state.screen_type)
+                      << " | HP: " << state.current_hp << "/" << state.max_hp << std::endl;
         }
     }
 
-    bool hasCommand(const std::vector<std::string>& commands, const std::string& cmd) {
-        for (const auto& command : commands) {
-            if (command == cmd) {
-                return true;
-            }
+    bool makeSearchedCombatDecision(const GameState& state) {
+        SearchResult result = search->search(state);
+        if (result.status != SimStatus::OK) {
+            std::cout << "  -> Not simulated (" << result.error << "), playing randomly" << std::endl;
+            return false;
         }
-        return false;
-    }
 
-    bool makeRandomCombatDecision(const json& state) {
-        try {
-            // Check if we have combat state
-            if (!state.contains("game_state") ||
-                !state["game_state"].contains("combat_state")) {
-                return false;
-            }
+        std::cout << "  -> Searched " << result.iterations << " rollouts in " << result.elapsed_ms
+                  << " ms, value " << result.value << ": " << result.actions.size() << " action(s)" << std::endl;
+        client.sendActions(result.actions);
+        return true;
+    }
 
-            auto combat_state = state["game_state"]["combat_state"];
-            auto hand = combat_state["hand"];
+    bool makeRandomCombatDecision(const GameState& state) {
+        // Check if we have combat state
+        if (!state.in_combat) {
+            return false;
+        }
 
-            // 70% chance to play a card, 30% chance to end turn
-            std::uniform_real_distribution<> dist(0.0, 1.0);
-            if (dist(rng) > 0.7) {
-                return false; // End turn instead
-            }
+        const CombatState& combat = state.combat;
 
-            // Find playable cards
-            std::vector<int> playable_indices;
-            for (size_t i = 0; i < hand.size(); ++i) {
-                if (hand[i].value("is_playable", false)) {
-                    playable_indices.push_back(static_cast<int>(i));
-                }
-            }
+        // 70% chance to play a card, 30% chance to end turn
+        std::uniform_real_distribution<> dist(0.0, 1.0);
+        if (dist(rng) > 0.7) {
+            return false; // End turn instead
+        }
 
-            if (playable_indices.empty()) {
-                return false; // No playable cards
+        // Every playable card with each target it can take, enumerated once per state
+        // (the filtered list comes from the client's state arena, reset with the next state)
+        ArenaVector<LegalAction> plays(client.stateArena());
+        for (const LegalAction& action : client.legalActions()) {
+            if (action.kind == ActionKind::PLAY_CARD) {
+                plays.push_back(action);
             }
+        }
 
-            // Pick random playable card
-            std::uniform_int_distribution<> card_dist(0, static_cast<int>(playable_indices.size()) - 1);
-            int card_index = playable_indices[card_dist(rng)];
-            auto card = hand[card_index];
-            std::string card_name = card.value("name", "Unknown");
-
-            // Check if card needs target
-            if (card.value("has_target", false)) {
-                // Find alive monsters
-                auto monsters = combat_state["monsters"];
-                std::vector<int> alive_indices;
-
-                for (size_t i = 0; i < monsters.size(); ++i) {
-                    if (!monsters[i].value("is_gone", false) &&
-                        monsters[i].value("current_hp", 0) > 0) {
-                        alive_indices.push_back(static_cast<int>(i));
-                    }
-                }
-
-                if (alive_indices.empty()) {
-                    return false; // No valid targets
-                }
-
-                // Pick random target
-                std::uniform_int_distribution<> target_dist(0, static_cast<int>(alive_indices.size()) - 1);
-                int target_index = alive_indices[target_dist(rng)];
-
-                std::cout << "  -> Playing " << card_name << " (card #" << card_index
-                          << ") -> Monster " << target_index << std::endl;
-                client.playCard(card_index, target_index);
-                return true;
+        if (plays.empty()) {
+            return false; // No playable cards or no valid targets
+        }
 
-            } else {
-                // No target needed
-                std::cout << "  -> Playing " << card_name << " (card #" << card_index << ")" << std::endl;
-                client.playCard(card_index);
-                return true;
-            }
+        // Pick a random card and target
+        std::uniform_int_distribution<> play_dist(0, static_cast<int>(plays.size()) - 1);
+        const LegalAction& play = plays[play_dist(rng)];
+        std::string_view card_name = state.str(combat.hand[play.index].name);
 
-        } catch (const json::exception& e) {
-            std::cerr << "Error making combat decision: " << e.what() << std::endl;
-            return false;
+        std::cout << "  -> Playing " << card_name << " (card #" << play.index << ")";
+        if (play.target >= 0) {
+            std::cout << " -> Monster " << play.target;
         }
+        std::cout << std::endl;
+        client.sendAction(play.toAction(state));
+        return true;
     }
 };
 
@@ -206,6 +184,8 @@ int main(int argc, char* argv[]) {
     // Parse command-line arguments
     ClientConfig config;
     config.debug = false;
+    int search_ms = 0;
+    config.state_sections = StateSections::COMBAT;  // The AI never looks at the deck, map or screens
 
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -215,11 +195,20 @@ int main(int argc, char* argv[]) {
             config.port = std::stoi(argv[++i]);
         } else if (arg == "--host" && i + 1 < argc) {
             config.host = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            config.record_path = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            config.replay_path = argv[++i];
+        } else if (arg == "--search" && i + 1 < argc) {
+            search_ms = std::stoi(argv[++i]);
         } else if (arg == "--help" || arg == "-h") {
             std::cout << "Usage: " << argv[0] << " [OPTIONS]\n"
                       << "\nOptions:\n"
                       << "  --host HOST    Server host (default: 127.0.0.1)\n"
                       << "  --port PORT    Server port (default: 8080)\n"
+                      << "  --record FILE  Record every state and action to a trace file\n"
+                      << "  --replay FILE  Play against a recorded trace instead of a server\n"
+                      << "  --search MS    Plan each turn with Monte Carlo search for MS milliseconds\n"
                       << "  --debug        Enable debug logging\n"
                       << "  --help, -h     Show this help message\n";
             return 0;
@@ -232,7 +221,7 @@ int main(int argc, char* argv[]) {
               << "Connecting to http://" << config.host << ":" << config.port << "\n"
               << std::string(60, '=') << "\n" << std::endl;
 
-    SimpleAI ai(config);
+    SimpleAI ai(config, search_ms);
 
     if (!ai.initialize()) {
         return 1;
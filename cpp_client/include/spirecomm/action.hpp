@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "spirecomm/ids.hpp"
+
+namespace spirecomm {
+
+struct GameState;
+
+/**
+ * Action to queue on the server
+ *
+ * Value type holding the pre-serialized JSON body of one POST /action
+ * request. The static factories mirror the SpireCommClient action methods, so
+ * a planner can build a whole turn up front and submit it in a single request
+ * with sendActions().
+ *
+ * The body is written once, by the factory, into an inline buffer: building
+ * and sending an action does not allocate unless its string arguments (card,
+ * relic or potion names) push the body past kInlineCapacity.
+ *
+ * The game picks cards, relics and potions by display name. The overloads
+ * taking IDs look the ID up in a typed state (the screen's cards, relics or
+ * potions; the deck for buyPurge()) and send the name of the first match, or
+ * the game ID itself if nothing on the screen has that ID.
+ *
+ * Usage:
+ *   std::vector<Action> turn = {
+ *       Action::playCard(0, 1),
+ *       Action::playCard(0),     // indices refer to the hand after the previous play
+ *       Action::endTurn()
+ *   };
+ *   client.sendActions(turn);
+ */
+class Action {
+public:
+    // Bodies up to this many bytes are stored inline
+    static constexpr size_t kInlineCapacity = 120;
+
+    static Action playCard(int card_index);
+    static Action playCard(int card_index, int target_index);
+    static Action endTurn();
+    static Action usePotion(int potion_index);
+    static Action usePotion(int potion_index, int target_index);
+    static Action discardPotion(int potion_index);
+    static Action proceed();
+    static Action cancel();
+    static Action choose(int choice_index);
+    static Action chooseByName(std::string_view name);
+    static Action rest(std::string_view option);
+    static Action cardReward(std::string_view card_name = "", bool bowl = false);
+    static Action combatReward(int reward_index);
+    static Action bossReward(std::string_view relic_name);
+    static Action buyCard(std::string_view card_name);
+    static Action buyRelic(std::string_view relic_name);
+    static Action buyPotion(std::string_view potion_name);
+    static Action buyPurge(std::string_view card_name = "");
+    static Action cardSelect(const std::vector<std::string>& card_names);
+    static Action chooseMapNode(int x, int y);
+    static Action chooseMapBoss();
+    static Action openChest();
+    static Action eventOption(int choice_index);
+    static Action startGame(std::string_view character, int ascension = 0, std::string_view seed = "");
+
+    static Action cardReward(const GameState& state, CardId card);
+    static Action bossReward(const GameState& state, RelicId relic);
+    static Action buyCard(const GameState& state, CardId card);
+    static Action buyRelic(const GameState& state, RelicId relic);
+    static Action buyPotion(const GameState& state, PotionId potion);
+    static Action buyPurge(const GameState& state, CardId card);
+    static Action cardSelect(const GameState& state, const std::vector<CardId>& cards);
+
+    /**
+     * Get the action type (e.g., "play_card", "end_turn")
+     */
+    std::string_view type() const { return action_type; }
+
+    /**
+     * Get the JSON body sent to POST /action
+     * @return View into this action, valid while it is alive and unmodified
+     */
+    std::string_view body() const {
+        return heap_body.empty() ? std::string_view(inline_body.data(), inline_size) : std::string_view(heap_body);
+    }
+
+private:
+    // Appends JSON to an action's body (defined in action.cpp)
+    class Writer;
+
+    explicit Action(std::string_view type) : action_type(type) {}
+
+    std::string_view action_type;                 // Always a string literal
+    std::array<char, kInlineCapacity> inline_body;
+    uint32_t inline_size = 0;
+    std::string heap_body;                        // Used only once the body outgrows inline_body
+};
+
+} // namespace spirecomm
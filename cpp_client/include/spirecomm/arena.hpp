@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace spirecomm {
+
+/**
+ * Bump allocator that is freed wholesale
+ *
+ * Hands out memory from large blocks by advancing an offset; individual
+ * frees are no-ops and reset() makes all of it reusable at once. After a
+ * reset the blocks are kept (merged into one if the last cycle needed
+ * several), so a workload that repeats allocates from the system only on
+ * its first few cycles. Not thread-safe: give each thread or client its own.
+ *
+ * SpireCommClient::stateArena() is one of these, reset whenever a new state
+ * is parsed, for the temporaries of a single decision.
+ *
+ * Usage:
+ *   Arena& arena = client.stateArena();
+ *   ArenaVector<int> playable(arena);
+ *   for (size_t i = 0; i < state.combat.hand.size(); ++i) {
+ *       if (state.combat.hand[i].is_playable) {
+ *           playable.push_back(static_cast<int>(i));
+ *       }
+ *   }
+ */
+class Arena {
+public:
+    static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+    explicit Arena(size_t block_size = kDefaultBlockSize);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * Allocate uninitialized memory, valid until the next reset()
+     * @param alignment Power of two
+     */
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * Release everything allocated so far
+     * Objects in the arena are not destroyed; only put trivially destructible
+     * data here, or containers that are gone before the reset.
+     */
+    void reset();
+
+    /**
+     * Get bytes handed out since the last reset (including alignment padding)
+     */
+    size_t bytesUsed() const { return used + offset; }
+
+    /**
+     * Get bytes held from the system
+     */
+    size_t bytesReserved() const;
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size = 0;
+    };
+
+    size_t block_size;
+    std::vector<Block> blocks;
+    size_t current = 0;   // Block being filled
+    size_t offset = 0;    // Next free byte in blocks[current]
+    size_t used = 0;      // Bytes in blocks before current
+};
+
+/**
+ * Standard allocator drawing from an Arena
+ * deallocate() is a no-op; memory comes back when the arena is reset.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator(Arena& arena) noexcept : source(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : source(other.arena()) {}
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(source->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    Arena* arena() const noexcept { return source; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return source == other.arena(); }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return source != other.arena(); }
+
+private:
+    Arena* source;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace spirecomm
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "spirecomm/client.hpp"
+
+namespace spirecomm {
+
+/**
+ * Asynchronous SpireComm HTTP Client
+ *
+ * Runs all HTTP traffic on background I/O threads so the AI thread never
+ * blocks on the network: a state thread keeps a long-poll open on /state and
+ * publishes every new typed GameState, and an action thread drains submitted
+ * actions to /action. The AI can therefore evaluate the latest state while
+ * the previous action is still in flight.
+ *
+ * Published states are immutable snapshots shared with the consumer through
+ * an atomic shared_ptr, so latestState() never blocks on the client's mutex
+ * or waits for the state thread, and a snapshot stays valid for as long as
+ * the caller holds it. (The atomic itself is not lock-free in libstdc++ and
+ * may take a short internal lock.)
+ *
+ * Usage:
+ *   SpireCommAsyncClient client(config);
+ *   if (client.start()) {
+ *       uint64_t version = 0;
+ *       while (true) {
+ *           auto state = client.nextState(version).get();
+ *           if (!state) {
+ *               break;  // client stopped
+ *           }
+ *           version = state->state_version;
+ *           if (state->ready_for_command && state->hasCommand("end")) {
+ *               client.sendActionAsync(Action::endTurn());
+ *           }
+ *       }
+ *   }
+ */
+class SpireCommAsyncClient {
+public:
+    using StatePtr = std::shared_ptr<const GameState>;
+    using StateCallback = std::function<void(const StatePtr&)>;
+
+    /**
+     * Create client with configuration (no threads are started yet)
+     */
+    explicit SpireCommAsyncClient(const ClientConfig& config = ClientConfig());
+
+    /**
+     * Destructor (stops the I/O threads)
+     */
+    ~SpireCommAsyncClient();
+
+    // Owns threads; neither copyable nor movable
+    SpireCommAsyncClient(const SpireCommAsyncClient&) = delete;
+    SpireCommAsyncClient& operator=(const SpireCommAsyncClient&) = delete;
+
+    /**
+     * Connect to server and start the I/O threads
+     * Each thread has its own connection, so config.shm_path, replay_path
+     * and record_path are rejected (see getLastError()); use SpireCommClient
+     * for those.
+     * @return true if server is reachable and the threads were started
+     */
+    bool start();
+
+    /**
+     * Stop the I/O threads
+     * Pending nextState() futures resolve to nullptr and queued actions that
+     * were not sent yet resolve to false. Blocks until any request in flight
+     * completes (at most one long-poll interval).
+     */
+    void stop();
+
+    /**
+     * Check if the I/O threads are running
+     */
+    bool isRunning() const;
+
+    /**
+     * Check if the server responded to the last state request
+     */
+    bool isConnected() const;
+
+    /**
+     * Get last error message from either I/O thread
+     */
+    std::string getLastError() const;
+
+    /**
+     * Get the newest published state without blocking
+     * @return Latest state snapshot, nullptr before the first state arrives
+     */
+    StatePtr latestState() const;
+
+    /**
+     * Get a future for the first state newer than since_version
+     * Resolves immediately if such a state was already published.
+     * @param since_version Version the caller has already seen (0 for any state)
+     * @return Future resolving to the new state, or nullptr if the client stops first
+     */
+    std::future<StatePtr> nextState(uint64_t since_version);
+
+    /**
+     * Register a callback invoked for every new state
+     * Called on the state thread right after the state is published; keep it
+     * short (e.g. hand the pointer to the AI thread) or it delays the next poll.
+     * @param callback Function to call, or an empty function to unregister
+     */
+    void setStateCallback(StateCallback callback);
+
+    /**
+     * Queue an action on the action thread
+     * @param action Action to send
+     * @return Future resolving to true once the server queued the action
+     */
+    std::future<bool> sendActionAsync(Action action);
+
+    /**
+     * Queue a batch of actions on the action thread, see SpireCommClient::sendActions()
+     * @param actions Actions to queue, in execution order
+     * @param abort_on_divergence Drop the rest of the batch if the state diverges
+     * @return Future resolving to true once the server queued the whole batch
+     */
+    std::future<bool> sendActionsAsync(std::vector<Action> actions, bool abort_on_divergence = true);
+
+private:
+    // PIMPL idiom to hide implementation details
+    struct Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace spirecomm
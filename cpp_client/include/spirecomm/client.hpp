@@ -1,10 +1,17 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <optional>
 #include <vector>
 #include <nlohmann/json.hpp>
+#include "spirecomm/action.hpp"
+#include "spirecomm/arena.hpp"
+#include "spirecomm/game_state.hpp"
+#include "spirecomm/legal_actions.hpp"
+#include "spirecomm/stats.hpp"
 
 namespace spirecomm {
 
@@ -14,8 +21,21 @@ namespace spirecomm {
 struct ClientConfig {
     std::string host = "127.0.0.1";  // Server host
     int port = 8080;                  // Server port
+    std::string unix_socket;          // Unix domain socket path to connect to instead of host:port (empty = TCP)
+    std::string shm_path;             // Shared-memory file from http_server.py --shm; replaces HTTP entirely (empty = HTTP)
+    std::string record_path;          // Write every parsed state and sent action to this trace file (empty = off)
+    std::string replay_path;          // Replay a recorded trace instead of talking to a server (empty = live)
     int timeout_ms = 5000;            // HTTP request timeout
     bool debug = false;               // Enable debug logging
+    bool delta_updates = false;       // Request JSON-patch deltas against the cached state
+    uint32_t state_sections = StateSections::ALL;  // Sections parsed into the typed GameState
+    WireFormat wire_format = WireFormat::JSON;     // Encoding requested for /state responses
+    bool publish_snapshots = false;   // Publish each new GameState as an immutable snapshot() other threads may read
+    int stats_interval_ms = 0;        // Dump getStats() to stderr this often (0 = never)
+    bool keep_alive = true;           // Reuse one TCP connection across requests
+    bool tcp_nodelay = true;          // Disable Nagle's algorithm (small requests are sent immediately)
+    int socket_send_buffer = 0;       // SO_SNDBUF in bytes (0 = OS default)
+    int socket_recv_buffer = 0;       // SO_RCVBUF in bytes (0 = OS default)
 };
 
 /**
@@ -32,14 +52,25 @@ struct ClientConfig {
  *   SpireCommClient client(config);
  *
  *   if (client.connect()) {
+ *       uint64_t version = 0;
  *       while (true) {
- *           auto state = client.getState();
- *           if (state && client.isReadyForCommand()) {
+ *           auto state = client.waitForState(version);
+ *           if (!state) {
+ *               continue;  // timed out without a change
+ *           }
+ *           version = client.stateVersion();
+ *           if (client.isReadyForCommand()) {
  *               client.endTurn();
  *           }
- *           std::this_thread::sleep_for(std::chrono::milliseconds(50));
  *       }
  *   }
+ *
+ * A client is driven by one thread. With config.publish_snapshots set, that
+ * thread also publishes every new typed state as an immutable snapshot, and
+ * snapshot(), stateVersion(), isInGame(), isReadyForCommand() and
+ * getAvailableCommands() may then be called from any other thread; they read
+ * the snapshot and never wait for the driving thread's requests or parses.
+ * Everything else, getGameState() included, stays on the driving thread.
  */
 class SpireCommClient {
 public:
@@ -69,7 +100,7 @@ public:
 
     /**
      * Check if connected to server
-     * @return true if last connection attempt succeeded
+     * @return true if the server responded to the last request
      */
     bool isConnected() const;
 
@@ -79,34 +110,199 @@ public:
      */
     std::string getLastError() const;
 
+    /**
+     * Get instrumentation counters
+     * Round-trip histograms and byte counts per endpoint, parse time per state,
+     * latency from an accepted action to the next state ready for a command,
+     * and state requests per decision. Always collected; not safe to call
+     * while another thread uses the client.
+     * @return Snapshot of the counters since construction or resetStats()
+     */
+    ClientStats getStats() const;
+
+    /**
+     * Reset all instrumentation counters
+     */
+    void resetStats();
+
     /**
      * Get current game state
-     * Returns the full JSON state object from the server.
+     * Returns the full JSON state object from the server. The cached version is
+     * sent as If-None-Match, so an unchanged state costs a 304 with no body and
+     * no JSON parse; the cached state is returned in that case.
      * @return Game state JSON if available, empty optional otherwise
      */
     std::optional<nlohmann::json> getState();
 
+    /**
+     * Wait for a game state newer than since_version (long-poll)
+     * Blocks on the server until the state version moves past since_version
+     * (a new message from the game, or ready_for_command flipping), so callers
+     * do not need to sleep between polls. Pass stateVersion() to wait for the
+     * next change, or 0 to return as soon as any state exists.
+     * @param since_version Version the caller has already seen
+     * @param timeout_ms Maximum time to wait on the server
+     * @return New game state JSON, or empty optional on timeout or error
+     */
+    std::optional<nlohmann::json> waitForState(uint64_t since_version, int timeout_ms = 1000);
+
+    /**
+     * Fetch the current game state into the typed view only
+     * Streams the response straight into getGameState() without building a
+     * JSON DOM, skipping every section not in config.state_sections. Use this
+     * instead of getState() when only the typed state is needed; the JSON
+     * cache is left untouched, so getState() will download a full copy.
+     * @return true if a state is available (new or unchanged since last fetch)
+     */
+    bool fetchGameState();
+
+    /**
+     * Wait for a game state newer than since_version into the typed view only
+     * Long-poll counterpart of fetchGameState(), see waitForState().
+     * @param since_version Version the caller has already seen
+     * @param timeout_ms Maximum time to wait on the server
+     * @return true if a newer state was parsed, false on timeout or error
+     */
+    bool waitForGameState(uint64_t since_version, int timeout_ms = 1000);
+
+    /**
+     * Subscribe to pushed state updates (Server-Sent Events on /stream)
+     * Blocks the calling thread on one persistent connection; every state the
+     * server publishes is parsed into getGameState() (honouring
+     * config.state_sections) and passed to callback as soon as it arrives, with
+     * no polling. The stream uses its own connection, so the callback may send
+     * actions through this client.
+     * @param callback Called with each new state; return false to unsubscribe
+     * @param since_version Version the caller has already seen (0 to receive the current state first)
+     * @return true if the callback ended the subscription, false if the stream failed or was closed
+     */
+    bool subscribe(const std::function<bool(const GameState&)>& callback, uint64_t since_version = 0);
+
+    /**
+     * Get version of the cached state
+     * Monotonic sequence number stamped by the server ("state_version").
+     * Thread-safe with config.publish_snapshots.
+     * @return Version of the last state received, 0 if none yet
+     */
+    uint64_t stateVersion() const;
+
+    /**
+     * Get typed view of the cached state
+     * Parsed once whenever a new state version arrives (and not on 304), so
+     * AI code can read fields directly instead of looking up JSON keys.
+     * The reference stays valid for the lifetime of the client; its contents
+     * are overwritten by the next getState()/waitForState() that returns a
+     * new version, so copy it to keep a snapshot.
+     * @return Typed state (empty GameState before the first state arrives)
+     */
+    const GameState& getGameState() const;
+
+    /**
+     * Get the scratch arena for the current state
+     * Reset wholesale each time a new state is parsed into getGameState(),
+     * so per-decision temporaries (ArenaVector of candidate plays, targets,
+     * ...) cost no heap allocation or allocator lock once it has warmed up.
+     * Memory from it is only valid until the next state arrives.
+     * @return Arena owned by the client
+     */
+    Arena& stateArena();
+
+    /**
+     * Get an immutable snapshot of the typed state
+     * With config.publish_snapshots, every new state is copied once into a
+     * snapshot that is swapped in atomically (RCU-style), and this returns the
+     * current one from any thread without waiting for the driving thread. The
+     * atomic load is not lock-free in libstdc++ and may take a short internal
+     * lock, as may dropping a snapshot's last reference. A snapshot never changes,
+     * and stays valid for as long as the caller holds it; the client reuses
+     * its storage for a later state only once no caller holds it any more.
+     * Without publish_snapshots, returns a fresh copy of getGameState() and
+     * must be called from the driving thread.
+     * @return Latest state (empty GameState before the first state arrives)
+     */
+    std::shared_ptr<const GameState> snapshot() const;
+
     /**
      * Check if currently in game
-     * Parses cached state for "in_game" field.
+     * Reads "in_game" from the typed state (from snapshot() with config.publish_snapshots).
      * @return true if in an active game
      */
     bool isInGame() const;
 
     /**
      * Check if game is ready for command
-     * Parses cached state for "ready_for_command" field.
+     * Reads "ready_for_command" from the typed state (from snapshot() with config.publish_snapshots).
      * @return true if ready to accept actions
      */
     bool isReadyForCommand() const;
 
     /**
      * Get list of available commands
-     * Parses cached state for "available_commands" field.
+     * Reads "available_commands" from the typed state (from snapshot() with config.publish_snapshots).
+     * Prefer getGameState().hasCommand(Command::PLAY) etc., which tests a bit
+     * instead of building strings.
      * @return Vector of command names (e.g., ["play", "end", "proceed"])
      */
     std::vector<std::string> getAvailableCommands() const;
 
+    /**
+     * Get the actions available in the typed state
+     * Enumerated by enumerateLegalActions() on the first call after each new
+     * state and cached until the next one, so every card/target pair, potion
+     * use and screen choice is computed once per version. Turn an entry into
+     * the request with toAction(getGameState()).
+     * @return Actions for getGameState(), valid until the next state arrives
+     */
+    const std::vector<LegalAction>& legalActions();
+
+    /**
+     * Queue a single action
+     * @param action Action built with one of the Action factories
+     * @return true if action sent successfully
+     */
+    bool sendAction(const Action& action);
+
+    /**
+     * Queue several actions in one request
+     * Posts the whole plan (e.g. every card of a turn followed by endTurn) as a
+     * single POST /action; the server executes the actions in order as the game
+     * becomes ready. Indices are resolved when each action executes, so they
+     * must account for the earlier actions (playing card 0 shifts the hand).
+     * @param actions Actions to queue, in execution order
+     * @param abort_on_divergence If true, the server drops the rest of the batch
+     *        when the game reports an error or the screen type or room phase
+     *        changes (e.g. the last monster died mid-turn)
+     * @return true if the whole batch was queued (nothing is queued on failure)
+     */
+    bool sendActions(const std::vector<Action>& actions, bool abort_on_divergence = true);
+
+    /**
+     * Queue an action and wait for the state it results in
+     * Replaces sleeping and polling after sendAction(): the server gives each
+     * action an id and reports the newest one the game has answered in
+     * last_action_id, so this returns at the first state that reflects the
+     * action and is ready for a command; the stale pre-action state is never
+     * returned. The state is then available from getGameState().
+     * If the action is discarded without running (/clear), the wait ends at the
+     * next ready state.
+     * @param action Action built with one of the Action factories
+     * @param timeout_ms Maximum total time to wait
+     * @return true if the resulting state arrived; false on send failure or timeout
+     */
+    bool executeAndWait(const Action& action, int timeout_ms = 5000);
+
+    /**
+     * Queue several actions in one request and wait for the state after the last
+     * Same as sendActions() followed by waiting as in executeAndWait(). If the
+     * batch diverges, the dropped actions count as answered, so the wait ends at
+     * the state that caused the divergence.
+     * @param actions Actions to queue, in execution order
+     * @param abort_on_divergence See sendActions()
+     * @param timeout_ms Maximum total time to wait
+     * @return true if the resulting state arrived; false on send failure or timeout
+     */
+    bool executeAllAndWait(const std::vector<Action>& actions, bool abort_on_divergence = true, int timeout_ms = 5000);
+
     // Type-safe action methods
 
     /**
@@ -242,6 +438,19 @@ public:
      */
     bool cardSelect(const std::vector<std::string>& card_names);
 
+    /**
+     * Choose, buy or select by ID instead of by name
+     * The names sent are looked up in getGameState(), see Action.
+     * @return true if action sent successfully
+     */
+    bool cardReward(CardId card);
+    bool bossReward(RelicId relic);
+    bool buyCard(CardId card);
+    bool buyRelic(RelicId relic);
+    bool buyPotion(PotionId potion);
+    bool buyPurge(CardId card);
+    bool cardSelect(const std::vector<CardId>& cards);
+
     /**
      * Choose a map node by coordinates
      * @param x Node X coordinate
@@ -279,6 +488,9 @@ public:
     bool startGame(const std::string& character, int ascension = 0, const std::string& seed = "");
 
 private:
+    // Wait for a ready state newer than sent_at_version with last_action_id >= action_id
+    bool waitForActionResult(uint64_t action_id, uint64_t sent_at_version, int timeout_ms);
+
     // PIMPL idiom to hide implementation details
     struct Impl;
     std::unique_ptr<Impl> pImpl;
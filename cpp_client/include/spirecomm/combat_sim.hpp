@@ -0,0 +1,271 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "spirecomm/game_state.hpp"
+
+namespace spirecomm {
+
+/**
+ * Outcome of a CombatSim step
+ * UNSUPPORTED means the model cannot represent the step (an unmodelled card,
+ * power or mechanic); the state is left unchanged and the caller should fall
+ * back to the live game. ILLEGAL means the game would refuse it too
+ * (not enough energy, bad index or target, combat already over).
+ */
+enum class SimStatus : uint8_t {
+    OK, UNSUPPORTED, ILLEGAL
+};
+
+/**
+ * Cards the simulator knows the effect of; everything else loads as UNKNOWN
+ */
+enum class SimCardId : uint8_t {
+    UNKNOWN,
+    // Starter cards of every class
+    STRIKE, DEFEND, BASH, NEUTRALIZE,
+    // Ironclad
+    ANGER, BODY_SLAM, CLASH, CLEAVE, CLOTHESLINE, FLEX, HEAVY_BLADE, IRON_WAVE,
+    PERFECTED_STRIKE, POMMEL_STRIKE, SHRUG_IT_OFF, SWORD_BOOMERANG, THUNDERCLAP,
+    TWIN_STRIKE, WILD_STRIKE, BATTLE_TRANCE, BLOODLETTING, CARNAGE, GHOSTLY_ARMOR,
+    HEMOKINESIS, INFLAME, METALLICIZE, POWER_THROUGH, SEEING_RED, SHOCKWAVE,
+    UPPERCUT, WHIRLWIND, BLUDGEON, DEMON_FORM, IMPERVIOUS, OFFERING,
+    // Silent
+    BACKFLIP, DAGGER_SPRAY, DEADLY_POISON, DEFLECT, POISONED_STAB, QUICK_SLASH, SLICE,
+    // Colorless
+    BANDAGE_UP, DRAMATIC_ENTRANCE, FINESSE, FLASH_OF_STEEL, GOOD_INSTINCTS, SWIFT_STRIKE,
+    // Status and curse cards with an effect
+    WOUND, DAZED, SLIMED, BURN, DECAY, DOUBT, REGRET, SHAME,
+    // Any other status or curse: unplayable and inert
+    INERT
+};
+
+/**
+ * Card in a simulated pile, 4 bytes so piles copy as flat arrays
+ */
+struct SimCard {
+    enum : uint8_t {
+        UPGRADED   = 1u << 0,
+        TARGETED   = 1u << 1,
+        EXHAUSTS   = 1u << 2,
+        ETHEREAL   = 1u << 3,
+        UNPLAYABLE = 1u << 4,
+        STRIKE     = 1u << 5,   // Counts for Perfected Strike
+    };
+
+    SimCardId id = SimCardId::UNKNOWN;
+    int8_t cost = 0;            // -1 for X cost
+    CardType type = CardType::UNKNOWN;
+    uint8_t flags = 0;
+
+    bool is(uint8_t flag) const { return (flags & flag) != 0; }
+};
+
+/**
+ * Fixed-capacity pile of cards; order is kept (hand indices match the game)
+ */
+template <size_t N>
+struct SimPile {
+    static constexpr size_t kCapacity = N;
+
+    std::array<SimCard, N> cards{};
+    uint8_t count = 0;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+    const SimCard& operator[](size_t i) const { return cards[i]; }
+    SimCard& operator[](size_t i) { return cards[i]; }
+    const SimCard* begin() const { return cards.data(); }
+    const SimCard* end() const { return cards.data() + count; }
+
+    bool push(const SimCard& card) {
+        if (count == N) {
+            return false;
+        }
+        cards[count++] = card;
+        return true;
+    }
+
+    SimCard erase(size_t i) {
+        SimCard card = cards[i];
+        for (size_t j = i + 1; j < count; ++j) {
+            cards[j - 1] = cards[j];
+        }
+        --count;
+        return card;
+    }
+};
+
+/**
+ * Bits of SimPlayer::fresh and SimMonster::fresh
+ * A fresh debuff was applied by its owner's opponent this round and skips
+ * one end-of-round tick, like the game's just_applied.
+ */
+struct SimFresh {
+    enum : uint8_t {
+        VULNERABLE = 1u << 0,
+        WEAK       = 1u << 1,
+        FRAIL      = 1u << 2,
+        RITUAL     = 1u << 3,
+    };
+};
+
+struct SimPlayer {
+    int32_t hp = 0;
+    int32_t max_hp = 0;
+    int32_t block = 0;
+    int32_t energy = 0;
+    int16_t strength = 0;
+    int16_t dexterity = 0;
+    int16_t vulnerable = 0;
+    int16_t weak = 0;
+    int16_t frail = 0;
+    int16_t metallicize = 0;
+    int16_t plated_armor = 0;
+    int16_t flex = 0;           // Strength lost at end of turn
+    int16_t demon_form = 0;     // Strength gained at start of turn
+    bool no_draw = false;
+    uint8_t fresh = 0;          // SimFresh bits
+};
+
+struct SimMonster {
+    int32_t hp = 0;
+    int32_t max_hp = 0;
+    int32_t block = 0;
+    int32_t move_damage = -1;   // Base damage per hit of the current intent, -1 if it does not attack
+    int32_t move_hits = 0;
+    int16_t strength = 0;
+    int16_t vulnerable = 0;
+    int16_t weak = 0;
+    int16_t poison = 0;
+    int16_t artifact = 0;
+    int16_t ritual = 0;
+    int16_t metallicize = 0;
+    int16_t plated_armor = 0;
+    int16_t thorns = 0;
+    int16_t angry = 0;
+    int16_t curl_up = 0;
+    Intent intent = Intent::UNKNOWN;
+    bool half_dead = false;
+    bool is_gone = false;
+    uint8_t fresh = 0;          // SimFresh bits
+
+    bool isTargetable() const { return !is_gone && !half_dead && hp > 0; }
+};
+
+/**
+ * Headless forward model of a combat
+ *
+ * Value type loaded from the typed CombatState that applies card plays and
+ * turn ends in-process, so a search can expand thousands of lines per
+ * second without a round trip to the game. It is trivially copyable and
+ * never allocates: branching is `CombatSim next = sim;`.
+ *
+ * Coverage is deliberately partial. The starter and common cards listed in
+ * SimCardId, Strength, Dexterity, Vulnerable, Weak, Frail, Poison, Artifact
+ * and a handful of monster powers are modelled exactly; anything else
+ * answers SimStatus::UNSUPPORTED instead of guessing:
+ *  - load() refuses combats with unmodelled powers, orbs, a card mid-play or
+ *    piles over capacity
+ *  - playCard() refuses cards that load as SimCardId::UNKNOWN
+ *
+ * What is approximated:
+ *  - Draws are sampled from the draw pile with the simulator's seeded RNG
+ *    (the game's pile order is not assumed), so lines past a draw are samples
+ *  - endTurn() resolves only the damage part of each monster's intent and
+ *    assumes monsters repeat that intent next turn
+ *  - Relics and potions are not modelled; energy and draw per turn come from
+ *    energy_per_turn / cards_per_turn
+ *
+ * Indices follow the client: hand_index is 0-based into the current hand and
+ * target_index into the monster list, so a line found here replays with
+ * Action::playCard() and Action::endTurn().
+ *
+ * Usage:
+ *   CombatSim root;
+ *   if (root.load(client.getGameState()) == SimStatus::OK) {
+ *       CombatSim line = root;
+ *       if (line.playCard(0, 1) == SimStatus::OK && line.monsters[1].hp == 0) {
+ *           client.playCard(0, 1);
+ *       }
+ *   }
+ */
+class CombatSim {
+public:
+    static constexpr size_t kMaxMonsters = 6;
+    static constexpr size_t kMaxHand = 10;
+    static constexpr size_t kMaxPile = 80;
+
+    SimPlayer player;
+    std::array<SimMonster, kMaxMonsters> monsters{};
+    uint8_t num_monsters = 0;
+    SimPile<kMaxHand> hand;
+    SimPile<kMaxPile> draw_pile;
+    SimPile<kMaxPile> discard_pile;
+    int32_t exhausted = 0;      // Cards exhausted since load
+    int32_t turn = 0;
+    int32_t energy_per_turn = 3;
+    int32_t cards_per_turn = 5;
+    uint64_t rng = 0;
+
+    /**
+     * Load the combat from a parsed state
+     * @param state State with in_combat set (COMBAT section parsed)
+     * @param seed Seed for draws and random targets
+     * @param reason Set to why the combat cannot be modelled, if not null
+     * @return OK, UNSUPPORTED, or ILLEGAL when the state is not in combat
+     */
+    SimStatus load(const GameState& state, uint64_t seed = 0, std::string* reason = nullptr);
+
+    /**
+     * Play a card from the hand
+     * @param hand_index Index into hand
+     * @param target_index Monster index, ignored for untargeted cards
+     * @return OK, or UNSUPPORTED / ILLEGAL with the state unchanged
+     */
+    SimStatus playCard(int hand_index, int target_index = -1);
+
+    /**
+     * End the turn: end-of-turn effects, monster attacks, then the next
+     * player turn up to the draw
+     * @return OK, or ILLEGAL if the combat is over
+     */
+    SimStatus endTurn();
+
+    /**
+     * Check if playCard(hand_index, target_index) would be legal
+     * Unmodelled cards are reported as playable when the game would allow them.
+     */
+    bool canPlay(int hand_index, int target_index = -1) const;
+
+    bool won() const;
+    bool lost() const { return player.hp <= 0; }
+    bool isOver() const { return lost() || won(); }
+
+    /**
+     * Get the id the simulator uses for a card id from the game (e.g. "Strike_R")
+     */
+    static SimCardId cardId(std::string_view game_id);
+
+private:
+    bool payable(const SimCard& card) const;
+    uint32_t random(uint32_t bound);
+    void drawCards(int n);
+    int32_t attackDamage(int32_t base, const SimMonster& target, int strength_multiplier = 1) const;
+    int32_t cardBlock(int32_t base) const;
+    void hitMonster(size_t index, int32_t damage);
+    void hitAll(int32_t damage);
+    void hitPlayer(int32_t damage);
+    void loseHp(int32_t amount);
+    void debuffMonster(SimMonster& monster, int16_t SimMonster::*debuff, int16_t amount);
+    void endPlayerTurn();
+    void monsterTurn();
+    void endRound();
+    void startPlayerTurn();
+};
+
+} // namespace spirecomm
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "spirecomm/game_state.hpp"
+#include "spirecomm/ids.hpp"
+
+namespace spirecomm {
+
+/**
+ * Round a feature count up to a whole number of 256-bit registers
+ */
+constexpr uint32_t alignFeatures(uint32_t count) { return (count + 7) / 8 * 8; }
+
+/**
+ * Indices of the features encodeFeatures() writes, one float each
+ *
+ * Counts and amounts are written as raw values (HP 54 is 54.0f), flags as
+ * 0 or 1 and enums one-hot; normalizing is left to the model. Hand and
+ * monster slots past the end of the state are all zero.
+ *
+ * Cards, relics and powers are indexed by their known IDs from ids.hpp
+ * (cardIndex(), relicIndex(), powerIndex()); index 0 collects every ID the
+ * tables don't know, such as mod content. Each section starts on a multiple
+ * of 8 floats, so a row-major encoding can be read section by section with
+ * aligned loads.
+ *
+ * Datasets store this layout, so kLayoutVersion changes whenever an index
+ * or a table does; check it before feeding stored features to a model.
+ *
+ * Usage:
+ *   batch.at(row, Feature::CURRENT_HP);
+ *   batch.at(row, Feature::hand(0, Feature::CARD_COST));
+ *   batch.at(row, Feature::monster(1, Feature::MONSTER_HP));
+ *   batch.at(row, Feature::DECK + Feature::cardIndex("Bash"));
+ */
+struct Feature {
+    static constexpr uint32_t kLayoutVersion = 2;
+
+    static constexpr uint32_t kHandSlots = 10;
+    static constexpr uint32_t kMonsterSlots = 6;
+    static constexpr uint32_t kScreenTypes = static_cast<uint32_t>(ScreenType::UNKNOWN) + 1;
+    static constexpr uint32_t kCharacters = static_cast<uint32_t>(PlayerClass::UNKNOWN) + 1;
+    static constexpr uint32_t kMapSymbols = 7;  // M ? $ R E T, then any other symbol
+    static constexpr uint32_t kCardIds = std::size(kKnownCardIds) + 1;  // Including the unknown index 0
+    static constexpr uint32_t kRelicIds = std::size(kKnownRelicIds) + 1;
+    static constexpr uint32_t kPowerIds = std::size(kKnownPowerIds) + 1;
+    static constexpr uint32_t kPowerStride = alignFeatures(kPowerIds);
+
+    // Fields of each hand slot, see hand()
+    enum : uint32_t {
+        CARD_PRESENT, CARD_ID, CARD_COST, CARD_PLAYABLE, CARD_HAS_TARGET,
+        CARD_ATTACK, CARD_SKILL, CARD_POWER, CARD_UPGRADED,
+        kCardFields
+    };
+
+    // Fields of each monster slot, see monster()
+    enum : uint32_t {
+        MONSTER_TARGETABLE, MONSTER_HP, MONSTER_MAX_HP, MONSTER_BLOCK,
+        MONSTER_ATTACKING, MONSTER_DAMAGE, MONSTER_HITS, MONSTER_POWERS,
+        kMonsterFields
+    };
+
+    enum : uint32_t {
+        // Run
+        IN_GAME, IN_COMBAT, FLOOR, ACT, ASCENSION, GOLD, CURRENT_HP, MAX_HP,
+        SCREEN,                                                  // One-hot ScreenType
+        CHARACTER = SCREEN + kScreenTypes,                       // One-hot PlayerClass
+        RELICS = alignFeatures(CHARACTER + kCharacters),         // 1 per relic held, by relicIndex()
+        DECK = alignFeatures(RELICS + kRelicIds),                // Copies by cardIndex()
+        MAP_NODES = alignFeatures(DECK + kCardIds),              // Act map nodes by symbol
+        MAP_NEXT = MAP_NODES + kMapSymbols,                      // Next nodes by symbol (MAP screen only)
+        // Combat (zero outside combat)
+        BLOCK = alignFeatures(MAP_NEXT + kMapSymbols), ENERGY, TURN, PLAYER_POWERS,
+        HAND_SIZE, DRAW_PILE_SIZE, DISCARD_PILE_SIZE, EXHAUST_PILE_SIZE,
+        PLAYER_POWER_AMOUNTS = alignFeatures(EXHAUST_PILE_SIZE + 1),   // Amounts by powerIndex()
+        DRAW_PILE = alignFeatures(PLAYER_POWER_AMOUNTS + kPowerIds),   // Copies by cardIndex()
+        DISCARD_PILE = alignFeatures(DRAW_PILE + kCardIds),
+        EXHAUST_PILE = alignFeatures(DISCARD_PILE + kCardIds),
+        HAND = alignFeatures(EXHAUST_PILE + kCardIds),                 // kHandSlots x kCardFields
+        MONSTERS = alignFeatures(HAND + kHandSlots * kCardFields),     // kMonsterSlots x kMonsterFields
+        MONSTER_POWER_AMOUNTS = alignFeatures(MONSTERS + kMonsterSlots * kMonsterFields),  // kMonsterSlots x kPowerStride
+        COUNT = MONSTER_POWER_AMOUNTS + kMonsterSlots * kPowerStride
+    };
+
+    static constexpr uint32_t hand(uint32_t slot, uint32_t field) { return HAND + slot * kCardFields + field; }
+    static constexpr uint32_t monster(uint32_t slot, uint32_t field) { return MONSTERS + slot * kMonsterFields + field; }
+    static constexpr uint32_t monsterPower(uint32_t slot, uint32_t power) {
+        return MONSTER_POWER_AMOUNTS + slot * kPowerStride + power;
+    }
+
+    /**
+     * Get the index of a card, relic or power ID
+     * @param id Card::id, Relic::id or Power::id
+     * @return Index below kCardIds, kRelicIds or kPowerIds; 0 if the ID isn't a known one
+     */
+    static constexpr uint32_t cardIndex(CardId id) { return isKnown(id) ? static_cast<uint32_t>(id) : 0; }
+    static constexpr uint32_t relicIndex(RelicId id) { return isKnown(id) ? static_cast<uint32_t>(id) : 0; }
+    static constexpr uint32_t powerIndex(PowerId id) { return isKnown(id) ? static_cast<uint32_t>(id) : 0; }
+
+    /**
+     * Get the index of a game ID (not the display name), e.g. "Bash"
+     */
+    static constexpr uint32_t cardIndex(std::string_view id) { return cardIndex(knownCardId(id)); }
+    static constexpr uint32_t relicIndex(std::string_view id) { return relicIndex(knownRelicId(id)); }
+    static constexpr uint32_t powerIndex(std::string_view id) { return powerIndex(knownPowerId(id)); }
+};
+
+/**
+ * Features of many states in structure-of-arrays layout
+ *
+ * Each feature is a contiguous column of size() floats, so a model (or a
+ * SIMD loop) can read one feature across the whole batch without striding.
+ * Columns are padded to a multiple of kRowAlignment rows (plus one more
+ * block when that would be a multiple of kColumnSkew, which makes encoding a
+ * row thrash the cache); the padding is zero. Storage is kept across
+ * reset() calls.
+ *
+ * Element (row, feature) is at data()[feature * stride() + row].
+ */
+class FeatureBatch {
+public:
+    static constexpr size_t kRowAlignment = 8;  // Floats in a 256-bit register
+    static constexpr size_t kColumnSkew = 64;   // Column strides avoided (256 bytes)
+
+    /**
+     * Resize to rows states with every feature zero
+     */
+    void reset(size_t rows);
+
+    /**
+     * Get number of states in the batch
+     */
+    size_t size() const { return rows; }
+
+    /**
+     * Get distance in floats between the starts of consecutive columns
+     */
+    size_t stride() const { return column_stride; }
+
+    const float* data() const { return values.data(); }
+    float* data() { return values.data(); }
+
+    const float* column(uint32_t feature) const { return values.data() + feature * column_stride; }
+    float* column(uint32_t feature) { return values.data() + feature * column_stride; }
+
+    float at(size_t row, uint32_t feature) const { return column(feature)[row]; }
+
+    /**
+     * Encode one state into a row
+     * @param row Row to overwrite (< size())
+     * @param state Typed state (needs the COMBAT section for the combat features)
+     */
+    void encode(size_t row, const GameState& state);
+
+private:
+    std::vector<float> values;
+    std::vector<uint8_t> encoded;  // Rows written since reset()
+    size_t rows = 0;
+    size_t column_stride = 0;
+};
+
+/**
+ * Write the Feature::COUNT features of a state
+ * Feature f goes to out[f * stride], so the same call fills a row of a
+ * FeatureBatch (out = data() + row, stride = stride()) or a plain array
+ * (stride = 1). Every feature is written, zeros included, and nothing is
+ * allocated, so encoding into caller-owned memory is safe on a hot path.
+ * @param state Typed state
+ * @param out First feature's slot
+ * @param stride Distance in floats between consecutive features
+ */
+void encodeFeatures(const GameState& state, float* out, size_t stride = 1);
+
+} // namespace spirecomm
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "spirecomm/client.hpp"
+#include "spirecomm/features.hpp"
+
+namespace spirecomm {
+
+/**
+ * Configuration for SpireCommFleet
+ */
+struct FleetConfig {
+    ClientConfig client;          // Settings shared by every instance (port is replaced; shm_path, record_path and replay_path must be empty)
+    int first_port = 8080;        // Port of the first http_server.py instance
+    int num_instances = 1;        // Instances on consecutive ports starting at first_port
+    std::vector<std::string> unix_sockets;  // Socket paths, one per instance (replaces the port range when non-empty)
+    int num_threads = 0;          // Worker threads (0 = hardware concurrency), capped at num_instances
+    int poll_timeout_ms = 100;    // Long-poll budget when a worker has no other game to serve
+    int poll_slice_ms = 5;        // Long-poll budget per step while other games wait for a worker (at least 1)
+    int max_batch = 0;            // startBatched(): most states per policy call (0 = every instance)
+    int max_batch_wait_us = 2000; // startBatched(): longest a ready game waits for its batch to fill
+};
+
+/**
+ * Agent driving a single game of the fleet
+ * One agent is created per instance and is only ever called from one worker
+ * at a time, so it may keep per-game state without locking.
+ */
+class FleetAgent {
+public:
+    virtual ~FleetAgent() = default;
+
+    /**
+     * Decide on the next action(s) for a new state
+     * Called once per state version that is ready for a command.
+     * @param instance Index of the game within the fleet
+     * @param client Client connected to this game's server (send actions through it)
+     * @param state New typed state
+     * @return true to keep playing, false to retire this instance
+     */
+    virtual bool step(size_t instance, SpireCommClient& client, const GameState& state) = 0;
+};
+
+/**
+ * Creates the agent for an instance
+ */
+using FleetAgentFactory = std::function<std::unique_ptr<FleetAgent>(size_t instance)>;
+
+/**
+ * One game waiting in a batch
+ * The pointers are valid for the duration of the policy call.
+ */
+struct BatchEntry {
+    size_t instance = 0;                                   // Index of the game within the fleet
+    const GameState* state = nullptr;                      // New state, ready for a command
+    const std::vector<LegalAction>* legal_actions = nullptr;  // Its client's legalActions()
+};
+
+/**
+ * What a batch policy answers for one game
+ */
+struct BatchDecision {
+    std::vector<Action> actions;  // Sent in one request on the game's next turn of a worker (empty = none)
+    bool keep_playing = true;     // false retires this instance
+};
+
+/**
+ * Decides for a whole batch of games at once
+ * Row i of features, entries[i] and decisions[i] belong to the same game;
+ * decisions arrives sized to the batch with every entry empty. Called from
+ * one worker at a time.
+ */
+using BatchPolicy = std::function<void(const FeatureBatch& features, const std::vector<BatchEntry>& entries,
+                                       std::vector<BatchDecision>& decisions)>;
+
+/**
+ * Aggregate fleet statistics
+ */
+struct FleetStats {
+    size_t instances = 0;        // Connected instances
+    size_t active = 0;           // Instances whose agent has not retired
+    uint64_t states = 0;         // New states received across the fleet
+    uint64_t steps = 0;          // Agent steps (states ready for a command)
+    uint64_t steals = 0;         // Games a worker took from another worker's queue
+    uint64_t batches = 0;        // Policy calls made by startBatched() (steps / batches = mean batch size)
+    double elapsed_seconds = 0;  // Time since start()
+    double steps_per_second = 0;
+    std::vector<uint64_t> steps_per_instance;
+};
+
+/**
+ * Pool of SpireCommClient connections driving many games concurrently
+ *
+ * Owns one client per http_server.py instance over a port range and
+ * schedules agent work across a pool of worker threads. Each game is a task
+ * that is requeued after every step; workers serve their own queue first and
+ * steal from the others when it runs dry, so a game that is slow to respond
+ * never holds up the rest. A worker only blocks on a long-poll when it has
+ * nothing else to do.
+ *
+ * startBatched() replaces the per-game agents with one policy called on
+ * batches of ready states, for models that score many games per call.
+ *
+ * Usage:
+ *   FleetConfig config;
+ *   config.first_port = 8080;
+ *   config.num_instances = 16;
+ *
+ *   SpireCommFleet fleet(config);
+ *   fleet.connect();
+ *   fleet.start([](size_t) { return std::make_unique<MyAgent>(); });
+ *   fleet.wait();  // until every agent retires, or stop() is called
+ *   std::cout << fleet.getStats().steps_per_second << std::endl;
+ */
+class SpireCommFleet {
+public:
+    /**
+     * Create fleet with configuration (nothing is connected yet)
+     */
+    explicit SpireCommFleet(const FleetConfig& config = FleetConfig());
+
+    /**
+     * Destructor (stops the workers)
+     */
+    ~SpireCommFleet();
+
+    // Owns threads; neither copyable nor movable
+    SpireCommFleet(const SpireCommFleet&) = delete;
+    SpireCommFleet& operator=(const SpireCommFleet&) = delete;
+
+    /**
+     * Connect to every instance in the port range (or every socket in unix_sockets)
+     * Instances that do not answer the health check are left out of the fleet.
+     * Connects nothing if config.client sets shm_path, record_path or replay_path.
+     * @return Number of connected instances
+     */
+    size_t connect();
+
+    /**
+     * Start driving the connected instances
+     * @param factory Creates the agent for each instance
+     * @return true if the workers were started (false if nothing is connected or already running)
+     */
+    bool start(const FleetAgentFactory& factory);
+
+    /**
+     * Start driving the connected instances with one policy for all of them
+     * Instead of stepping each game on its own, ready states are parked
+     * until config.max_batch of them are waiting (or every active game is),
+     * or the oldest has waited config.max_batch_wait_us. The batch is then
+     * encoded into a FeatureBatch and handed to policy in a single call, and
+     * each game is requeued with its decision, so a model runs one forward
+     * pass per batch instead of one per game.
+     * @param policy Called with each batch
+     * @return true if the workers were started (false if nothing is connected or already running)
+     */
+    bool startBatched(const BatchPolicy& policy);
+
+    /**
+     * Block until every agent has retired or stop() is called
+     */
+    void wait();
+
+    /**
+     * Stop the workers after their current step
+     */
+    void stop();
+
+    /**
+     * Check if the workers are running
+     */
+    bool isRunning() const;
+
+    /**
+     * Get number of connected instances
+     */
+    size_t size() const;
+
+    /**
+     * Get port of an instance
+     * @param instance Index of the game within the fleet
+     * @return Port, or 0 for an instance reached over a Unix domain socket
+     */
+    int port(size_t instance) const;
+
+    /**
+     * Get address of an instance ("host:port" or "unix:path")
+     * @param instance Index of the game within the fleet
+     */
+    std::string address(size_t instance) const;
+
+    /**
+     * Get aggregate statistics (safe to call while running)
+     */
+    FleetStats getStats() const;
+
+    /**
+     * Get last error message
+     */
+    std::string getLastError() const;
+
+private:
+    // PIMPL idiom to hide implementation details
+    struct Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace spirecomm
@@ -0,0 +1,450 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "spirecomm/ids.hpp"
+#include "spirecomm/wire_format.hpp"
+
+namespace spirecomm {
+
+/**
+ * Typed view of a /state response
+ *
+ * Flat structs mirroring the schema in GAME_STATE_SPECIFICATION.md, parsed
+ * once per state version so AI code reads plain fields instead of looking up
+ * JSON keys. Every element is trivially copyable; strings live in a single
+ * pool owned by GameState and are referenced by StrRef (card, relic, potion
+ * and power game IDs are 16-bit IDs from ids.hpp instead), and variable-length
+ * children (powers, map edges) are index ranges into shared vectors. Copying
+ * a GameState is therefore a handful of vector copies, cheap enough to take
+ * snapshots into a search tree.
+ *
+ * Usage:
+ *   const GameState& gs = client.getGameState();
+ *   if (gs.in_combat) {
+ *       for (const Card& card : gs.combat.hand) {
+ *           if (card.is_playable) {
+ *               std::cout << gs.str(card.name) << std::endl;
+ *           }
+ *       }
+ *   }
+ */
+
+// Enumerations mirror the Python spirecomm.spire enums; UNKNOWN covers missing or unrecognized values
+
+enum class ScreenType : uint8_t {
+    NONE, EVENT, CHEST, SHOP_ROOM, REST, CARD_REWARD, COMBAT_REWARD, MAP,
+    BOSS_REWARD, SHOP_SCREEN, GRID, HAND_SELECT, GAME_OVER, COMPLETE, UNKNOWN
+};
+
+enum class RoomPhase : uint8_t {
+    COMBAT, EVENT, COMPLETE, INCOMPLETE, UNKNOWN
+};
+
+enum class RoomType : uint8_t {
+    MONSTER, MONSTER_ELITE, MONSTER_BOSS, SHOP, REST, EVENT, TREASURE, NEOW, UNKNOWN
+};
+
+enum class PlayerClass : uint8_t {
+    IRONCLAD, THE_SILENT, DEFECT, WATCHER, UNKNOWN
+};
+
+enum class CardType : uint8_t {
+    ATTACK, SKILL, POWER, STATUS, CURSE, UNKNOWN
+};
+
+enum class CardRarity : uint8_t {
+    BASIC, COMMON, UNCOMMON, RARE, SPECIAL, CURSE, UNKNOWN
+};
+
+enum class Intent : uint8_t {
+    ATTACK, ATTACK_BUFF, ATTACK_DEBUFF, ATTACK_DEFEND, BUFF, DEBUFF, STRONG_DEBUFF,
+    DEBUG, DEFEND, DEFEND_DEBUFF, DEFEND_BUFF, ESCAPE, MAGIC, NONE, SLEEP, STUN, UNKNOWN
+};
+
+enum class ChestType : uint8_t {
+    SMALL, MEDIUM, LARGE, BOSS, UNKNOWN
+};
+
+enum class RewardType : uint8_t {
+    CARD, GOLD, RELIC, POTION, STOLEN_GOLD, EMERALD_KEY, SAPPHIRE_KEY, UNKNOWN
+};
+
+enum class RestOption : uint8_t {
+    DIG, LIFT, RECALL, REST, SMITH, TOKE, UNKNOWN
+};
+
+/**
+ * Sections of game_state that can be parsed or skipped
+ * Combine with |; sections left out are not parsed and stay empty
+ * (in_combat stays false when COMBAT is left out).
+ */
+struct StateSections {
+    enum : uint32_t {
+        COMBAT = 1u << 0,  // combat_state
+        DECK   = 1u << 1,  // deck
+        MAP    = 1u << 2,  // map (the dungeon layout, not the map screen)
+        SCREEN = 1u << 3,  // screen (events, rewards, shop, map choices, card selection)
+        ITEMS  = 1u << 4,  // relics and potions
+        ALL    = 0xFFFFFFFFu
+    };
+};
+
+/**
+ * Bits of GameState::commands, one per command name in available_commands
+ * Combine with | and test with GameState::hasCommand() instead of comparing
+ * strings. Synonyms the game sends keep their own bit (for example CONFIRM
+ * next to PROCEED, and RETURN, SKIP and LEAVE next to CANCEL).
+ */
+struct Command {
+    enum : uint32_t {
+        PLAY    = 1u << 0,
+        END     = 1u << 1,
+        POTION  = 1u << 2,
+        CHOOSE  = 1u << 3,
+        PROCEED = 1u << 4,
+        CONFIRM = 1u << 5,
+        CANCEL  = 1u << 6,
+        RETURN  = 1u << 7,
+        SKIP    = 1u << 8,
+        LEAVE   = 1u << 9,
+        START   = 1u << 10,
+        STATE   = 1u << 11,
+        KEY     = 1u << 12,
+        CLICK   = 1u << 13,
+        WAIT    = 1u << 14,
+        OTHER   = 1u << 31   // Any name not listed above
+    };
+};
+
+/**
+ * Reference to a string in GameState::strings
+ */
+struct StrRef {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+
+    bool empty() const { return length == 0; }
+};
+
+struct Card {
+    CardId id = CardId::NONE;
+    StrRef name;
+    StrRef uuid;
+    int32_t cost = 0;
+    int32_t upgrades = 0;
+    int32_t misc = 0;
+    int32_t price = 0;
+    CardType type = CardType::UNKNOWN;
+    CardRarity rarity = CardRarity::UNKNOWN;
+    bool has_target = false;
+    bool is_playable = false;
+    bool exhausts = false;
+};
+
+struct Power {
+    PowerId id = PowerId::NONE;
+    StrRef name;
+    int32_t amount = 0;
+    int32_t damage = 0;
+    int32_t misc = 0;
+    bool just_applied = false;
+};
+
+/**
+ * Range of powers within CombatState::powers
+ */
+struct PowerRange {
+    uint32_t begin = 0;
+    uint32_t count = 0;
+};
+
+struct Orb {
+    StrRef id;
+    StrRef name;
+    int32_t evoke_amount = 0;
+    int32_t passive_amount = 0;
+};
+
+struct Player {
+    int32_t current_hp = 0;
+    int32_t max_hp = 0;
+    int32_t block = 0;
+    int32_t energy = 0;
+    PowerRange powers;
+};
+
+struct Monster {
+    StrRef id;
+    StrRef name;
+    int32_t current_hp = 0;
+    int32_t max_hp = 0;
+    int32_t block = 0;
+    int32_t move_id = -1;
+    int32_t last_move_id = -1;           // -1 if none
+    int32_t second_last_move_id = -1;    // -1 if none
+    int32_t move_base_damage = 0;
+    int32_t move_adjusted_damage = 0;
+    int32_t move_hits = 0;
+    PowerRange powers;
+    Intent intent = Intent::UNKNOWN;
+    bool half_dead = false;
+    bool is_gone = false;
+
+    /**
+     * Check if the monster can be targeted by a card or potion
+     */
+    bool isTargetable() const { return !is_gone && !half_dead && current_hp > 0; }
+};
+
+struct Relic {
+    RelicId id = RelicId::NONE;
+    StrRef name;
+    int32_t counter = 0;
+    int32_t price = 0;
+};
+
+struct Potion {
+    PotionId id = PotionId::NONE;
+    StrRef name;
+    int32_t price = 0;
+    bool can_use = false;
+    bool can_discard = false;
+    bool requires_target = false;
+};
+
+/**
+ * Map node; children are a range within GameState::map_children
+ */
+struct MapNode {
+    int32_t x = 0;
+    int32_t y = 0;
+    uint32_t first_child = 0;
+    uint32_t num_children = 0;
+    char symbol = '?';
+};
+
+struct MapCoord {
+    int32_t x = 0;
+    int32_t y = 0;
+};
+
+struct EventOption {
+    StrRef label;
+    StrRef text;
+    int32_t choice_index = -1;  // -1 if the server sent null; use the array index instead
+    bool disabled = false;
+};
+
+struct Reward {
+    RewardType type = RewardType::UNKNOWN;
+    int32_t gold = 0;
+    int32_t relic = -1;   // Index into ScreenState::relics, -1 if none
+    int32_t potion = -1;  // Index into ScreenState::potions, -1 if none
+};
+
+/**
+ * Combat state (valid when GameState::in_combat is set)
+ */
+struct CombatState {
+    Player player;
+    std::vector<Monster> monsters;
+    std::vector<Card> hand;
+    std::vector<Card> draw_pile;
+    std::vector<Card> discard_pile;
+    std::vector<Card> exhaust_pile;
+    std::vector<Card> limbo;
+    std::vector<Power> powers;  // Player and monster powers, see PowerRange
+    std::vector<Orb> orbs;
+    Card card_in_play;
+    bool has_card_in_play = false;
+    int32_t turn = 0;
+    int32_t cards_discarded_this_turn = 0;
+
+    /**
+     * Resolve a power range to a pointer into powers
+     */
+    const Power* powersBegin(PowerRange range) const { return powers.data() + range.begin; }
+    const Power* powersEnd(PowerRange range) const { return powers.data() + range.begin + range.count; }
+
+    void clear();
+};
+
+/**
+ * Screen state
+ * Union of the fields used by every screen type; only the fields for
+ * GameState::screen_type are meaningful.
+ */
+struct ScreenState {
+    ScreenType screen_type = ScreenType::NONE;
+
+    // EVENT
+    StrRef event_name;
+    StrRef event_id;
+    StrRef body_text;
+    std::vector<EventOption> options;
+
+    // CHEST
+    ChestType chest_type = ChestType::UNKNOWN;
+    bool chest_open = false;
+
+    // REST
+    bool has_rested = false;
+    std::vector<RestOption> rest_options;
+
+    // CARD_REWARD, SHOP_SCREEN, GRID, HAND_SELECT
+    std::vector<Card> cards;
+    std::vector<Card> selected_cards;
+    bool can_bowl = false;
+    bool can_skip = false;
+
+    // COMBAT_REWARD
+    std::vector<Reward> rewards;
+
+    // MAP
+    MapNode current_node;
+    bool has_current_node = false;
+    std::vector<MapNode> next_nodes;
+    bool boss_available = false;
+
+    // BOSS_REWARD, SHOP_SCREEN (and relics/potions referenced by rewards)
+    std::vector<Relic> relics;
+    std::vector<Potion> potions;
+    bool purge_available = false;
+    int32_t purge_cost = 0;
+
+    // GRID, HAND_SELECT
+    int32_t num_cards = 0;
+    bool any_number = false;
+    bool confirm_up = false;
+    bool for_upgrade = false;
+    bool for_transform = false;
+    bool for_purge = false;
+    bool can_pick_zero = false;
+
+    // GAME_OVER
+    int32_t score = 0;
+    bool victory = false;
+
+    void clear();
+};
+
+/**
+ * Game state
+ */
+struct GameState {
+    uint64_t state_version = 0;
+    uint64_t last_action_id = 0;  // Newest action the game has answered (or that was discarded)
+    bool in_game = false;
+    bool ready_for_command = false;
+    std::vector<StrRef> available_commands;
+    uint32_t commands = 0;  // Command bits of available_commands
+
+    // Set when the response contained a game_state object
+    bool has_game_state = false;
+
+    StrRef current_action;
+    int32_t current_hp = 0;
+    int32_t max_hp = 0;
+    int32_t floor = 0;
+    int32_t act = 0;
+    int32_t gold = 0;
+    int64_t seed = 0;
+    int32_t ascension_level = 0;
+    StrRef act_boss;
+    PlayerClass character = PlayerClass::UNKNOWN;
+    ScreenType screen_type = ScreenType::NONE;
+    RoomPhase room_phase = RoomPhase::UNKNOWN;
+    RoomType room_type = RoomType::UNKNOWN;
+    bool is_screen_up = false;
+    bool choice_available = false;
+
+    std::vector<Relic> relics;
+    std::vector<Card> deck;
+    std::vector<Potion> potions;
+    std::vector<MapNode> map;
+    std::vector<MapCoord> map_children;  // Children of map, current_node and next_nodes
+
+    bool in_combat = false;
+    CombatState combat;
+
+    ScreenState screen;
+
+    // Backing storage for every StrRef in this state
+    std::string strings;
+
+    /**
+     * Resolve a string reference
+     * @param ref Reference from any field of this state
+     * @return View into strings, valid until the state is next parsed
+     */
+    std::string_view str(StrRef ref) const { return std::string_view(strings).substr(ref.offset, ref.length); }
+
+    /**
+     * Check if a command is currently available
+     * @param command Command name (e.g., "play", "end", "proceed")
+     */
+    bool hasCommand(std::string_view command) const;
+
+    /**
+     * Check if any of the given commands is currently available
+     * @param command_bits Command bits, e.g. Command::PROCEED | Command::CONFIRM
+     */
+    bool hasCommand(uint32_t command_bits) const { return (commands & command_bits) != 0; }
+
+    /**
+     * Reset to an empty state, keeping allocated capacity
+     */
+    void clear();
+};
+
+/**
+ * Enum names as sent by the server (e.g., "COMBAT_REWARD", "MonsterRoomElite")
+ * @return Name of the value, "UNKNOWN" for UNKNOWN
+ */
+std::string_view toString(ScreenType value);
+std::string_view toString(RoomPhase value);
+std::string_view toString(RoomType value);
+std::string_view toString(PlayerClass value);
+std::string_view toString(CardType value);
+std::string_view toString(CardRarity value);
+std::string_view toString(Intent value);
+std::string_view toString(ChestType value);
+std::string_view toString(RewardType value);
+std::string_view toString(RestOption value);
+
+/**
+ * Command bit for a name in available_commands
+ * @return Bit from Command, Command::OTHER if the name is not recognized
+ */
+uint32_t commandBit(std::string_view name);
+
+/**
+ * Populate a GameState from a parsed /state response
+ * Reuses the vectors and string pool already held by out, so parsing every
+ * version into the same object does not allocate once capacities settle.
+ * Missing or null fields take their default values.
+ * @param state Full /state response (with in_game, game_state, etc.)
+ * @param out State to overwrite
+ * @param sections StateSections to parse
+ */
+void parseGameState(const nlohmann::json& state, GameState& out, uint32_t sections = StateSections::ALL);
+
+/**
+ * Populate a GameState directly from a /state response body
+ * Streams the body through a SAX parser without building a JSON DOM; the
+ * sections that are left out are skipped token by token without
+ * allocating. Produces the same result as parsing the DOM.
+ * @param body Raw /state response body
+ * @param out State to overwrite (cleared if the body is malformed)
+ * @param sections StateSections to parse
+ * @param format Encoding of body (JSON text, MessagePack or CBOR)
+ * @return true on success, false if the body is malformed
+ */
+bool parseGameStateBody(std::string_view body, GameState& out, uint32_t sections = StateSections::ALL,
+                        WireFormat format = WireFormat::JSON);
+
+} // namespace spirecomm
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+namespace spirecomm {
+
+/**
+ * Compact IDs for card, relic, potion and power game IDs
+ *
+ * Each kind has a fixed table of the base game's IDs, covering all four
+ * characters, colorless cards, curses, statuses and monster powers. An ID
+ * from the table is its position + 1 and is the same in every build and
+ * process, so it can be used as a compile-time constant:
+ *
+ *   constexpr CardId kBash = knownCardId("Bash");
+ *   if (card.id == kBash) { ... }
+ *
+ * IDs the tables don't know (mod content, new patches) are interned the
+ * first time cardId() and friends see them and numbered after the table.
+ * Interned numbers are shared by every client in the process but depend on
+ * the order IDs were first seen, so only isKnown() IDs should be stored.
+ * NONE (0) stands for a missing ID, or an unknown one once the 16-bit range
+ * is used up.
+ */
+enum class CardId : uint16_t { NONE = 0 };
+enum class RelicId : uint16_t { NONE = 0 };
+enum class PotionId : uint16_t { NONE = 0 };
+enum class PowerId : uint16_t { NONE = 0 };
+
+// Known game IDs, sorted; position i is ID i + 1. Appending or removing any
+// entry renumbers IDs (and changes Feature::kLayoutVersion).
+inline constexpr std::string_view kKnownCardIds[] = {
+    "A Thousand Cuts", "Accuracy", "Acrobatics", "Adaptation", "Adrenaline", "After Image",
+    "Aggregate", "All For One", "All Out Attack", "Alpha", "Amplify", "Anger", "Apotheosis",
+    "Apparition", "Armaments", "AscendersBane", "Auto Shields", "Backflip", "Backstab",
+    "Ball Lightning", "Bandage Up", "Bane", "Barrage", "Barricade", "Bash", "Battle Trance",
+    "BattleHymn", "Beam Cell", "BecomeAlmighty", "Berserk", "Beta", "Biased Cognition", "Bite",
+    "Blade Dance", "Blasphemy", "Blind", "Blizzard", "Blood for Blood", "Bloodletting", "Bludgeon",
+    "Blur", "Body Slam", "BootSequence", "Bouncing Flask", "BowlingBash", "Brilliance", "Brutality",
+    "Buffer", "Bullet Time", "Burn", "Burning Pact", "Burst", "Calculated Gamble", "Caltrops",
+    "Capacitor", "Carnage", "CarveReality", "Catalyst", "Chaos", "Chill", "Choke", "Chrysalis",
+    "Clash", "ClearTheMind", "Cleave", "Cloak And Dagger", "Clothesline", "Clumsy", "Cold Snap",
+    "Collect", "Combust", "Compile Driver", "Concentrate", "Conclude", "ConjureBlade", "Consecrate",
+    "Conserve Battery", "Consume", "Coolheaded", "Core Surge", "Corpse Explosion", "Corruption",
+    "Creative AI", "Crescendo", "Crippling Poison", "CrushJoints", "CurseOfTheBell",
+    "CutThroughFate", "Dagger Spray", "Dagger Throw", "Dark Embrace", "Dark Shackles", "Darkness",
+    "Dash", "Dazed", "Deadly Poison", "Decay", "DeceiveReality", "Deep Breath", "Defend_B",
+    "Defend_G", "Defend_P", "Defend_R", "Deflect", "Defragment", "Demon Form", "DeusExMachina",
+    "DevaForm", "Devotion", "Die Die Die", "Disarm", "Discovery", "Distraction", "Dodge and Roll",
+    "Doom and Gloom", "Doppelganger", "Double Energy", "Double Tap", "Doubt", "Dramatic Entrance",
+    "Dropkick", "Dual Wield", "Dualcast", "Echo Form", "Electrodynamics", "EmptyBody", "EmptyFist",
+    "EmptyMind", "Endless Agony", "Enlightenment", "Entrench", "Envenom", "Eruption", "Escape Plan",
+    "Establishment", "Evaluate", "Eviscerate", "Evolve", "Exhume", "Expertise", "Expunger", "FTL",
+    "FameAndFortune", "Fasting2", "FearNoEvil", "Feed", "Feel No Pain", "Fiend Fire", "Finesse",
+    "Finisher", "Fire Breathing", "Fission", "Flame Barrier", "Flash of Steel", "Flechettes",
+    "Flex", "FlurryOfBlows", "Flying Knee", "FlyingSleeves", "FollowUp", "Footwork", "Force Field",
+    "ForeignInfluence", "Forethought", "Fusion", "Gash", "Genetic Algorithm", "Ghostly",
+    "Ghostly Armor", "Glacier", "Glass Knife", "Go for the Eyes", "Good Instincts", "Grand Finale",
+    "Halt", "HandOfGreed", "Havoc", "Headbutt", "Heatsinks", "Heavy Blade", "Heel Hook",
+    "Hello World", "Hemokinesis", "Hologram", "Hyperbeam", "Immolate", "Impatience", "Impervious",
+    "Indignation", "Infernal Blade", "Infinite Blades", "Inflame", "Injury", "InnerPeace",
+    "Insight", "Intimidate", "Iron Wave", "J.A.X.", "Jack Of All Trades", "Judgement", "Juggernaut",
+    "JustLucky", "Leap", "Leg Sweep", "LessonLearned", "LikeWater", "Limit Break", "LiveForever",
+    "Lockon", "Loop", "Machine Learning", "Madness", "Magnetism", "Malaise", "Master of Strategy",
+    "MasterReality", "Masterful Stab", "Mayhem", "Meditate", "Melter", "MentalFortress",
+    "Metallicize", "Metamorphosis", "Meteor Strike", "Mind Blast", "Miracle", "Multi-Cast",
+    "Necronomicurse", "Neutralize", "Night Terror", "Nirvana", "Normality", "Noxious Fumes",
+    "Offering", "Omega", "Omniscience", "Outmaneuver", "Pain", "Panacea", "Panache", "PanicButton",
+    "Parasite", "PathToVictory", "Perfected Strike", "Perseverance", "Phantasmal Killer",
+    "PiercingWail", "Poisoned Stab", "Pommel Strike", "Power Through", "Pray", "Predator",
+    "Prepared", "Pride", "Prostrate", "Protect", "Pummel", "Purity", "Quick Slash", "Rage",
+    "Ragnarok", "Rainbow", "Rampage", "ReachHeaven", "Reaper", "Reboot", "Rebound",
+    "Reckless Charge", "Recycle", "Redo", "Reflex", "Regret", "Reinforced Body", "Reprogram",
+    "Riddle With Holes", "Rip and Tear", "RitualDagger", "Rupture", "Sadistic Nature", "Safety",
+    "Sanctity", "SandsOfTime", "SashWhip", "Scrape", "Scrawl", "Searing Blow", "Second Wind",
+    "Secret Technique", "Secret Weapon", "Seeing Red", "Seek", "Self Repair", "Sentinel", "Setup",
+    "Sever Soul", "Shame", "Shiv", "Shockwave", "Shrug It Off", "SignatureMove", "Skewer", "Skim",
+    "Slice", "Slimed", "Smite", "SpiritShield", "Spot Weakness", "Stack", "Static Discharge",
+    "Steam", "Steam Power", "Storm", "Storm of Steel", "Streamline", "Strike_B", "Strike_G",
+    "Strike_P", "Strike_R", "Study", "Sucker Punch", "Sunder", "Survivor", "Sweeping Beam",
+    "Swift Strike", "Swivel", "Sword Boomerang", "Tactician", "TalkToTheHand", "Tantrum", "Tempest",
+    "Terror", "The Bomb", "Thinking Ahead", "ThirdEye", "ThroughViolence", "Thunder Strike",
+    "Thunderclap", "Tools of the Trade", "Transmutation", "Trip", "True Grit", "Turbo",
+    "Twin Strike", "Underhanded Strike", "Undo", "Unload", "Uppercut", "Vault", "Vengeance",
+    "Venomology", "Vigilance", "Violence", "Void", "Wallop", "Warcry", "WaveOfTheHand", "Weave",
+    "Well Laid Plans", "WheelKick", "Whirlwind", "White Noise", "Wild Strike", "WindmillStrike",
+    "Wireheading", "Wish", "Worship", "Wound", "Wraith Form v2", "WreathOfFlame", "Writhe", "Zap"
+};
+
+inline constexpr std::string_view kKnownRelicIds[] = {
+    "Akabeko", "Anchor", "Ancient Tea Set", "Art of War", "Astrolabe", "Bag of Marbles",
+    "Bag of Preparation", "Bird Faced Urn", "Black Blood", "Black Star", "Blood Vial",
+    "Bloody Idol", "Blue Candle", "Boot", "Bottled Flame", "Bottled Lightning", "Bottled Tornado",
+    "Brimstone", "Bronze Scales", "Burning Blood", "Busted Crown", "Calipers", "Calling Bell",
+    "CaptainsWheel", "Cauldron", "Centennial Puzzle", "CeramicFish", "Champion Belt",
+    "Charon's Ashes", "Chemical X", "Circlet", "CloakClasp", "ClockworkSouvenir", "Coffee Dripper",
+    "Cracked Core", "CultistMask", "Cursed Key", "Damaru", "Darkstone Periapt", "Data Disk",
+    "Dead Branch", "DollysMirror", "Dream Catcher", "Du-Vu Doll", "Ectoplasm", "Emotion Chip",
+    "Empty Cage", "Enchiridion", "Eternal Feather", "FaceOfCleric", "FossilizedHelix",
+    "Frozen Egg 2", "Frozen Eye", "FrozenCore", "Fusion Hammer", "Gambling Chip", "Ginger", "Girya",
+    "Gold-Plated Cables", "Golden Idol", "GoldenEye", "Gremlin Horn", "GremlinMask", "HandDrill",
+    "Happy Flower", "HolyWater", "HornCleat", "HoveringKite", "Ice Cream", "Incense Burner",
+    "InkBottle", "Inserter", "Juzu Bracelet", "Kunai", "Lantern", "Lee's Waffle", "Letter Opener",
+    "Lizard Tail", "Magic Flower", "Mango", "Mark of Pain", "Mark of the Bloom", "Matryoshka",
+    "MawBank", "MealTicket", "Meat on the Bone", "Medical Kit", "Melange", "Membership Card",
+    "Mercury Hourglass", "Molten Egg 2", "Mummified Hand", "MutagenicStrength", "Necronomicon",
+    "NeowsBlessing", "Nilry's Codex", "Ninja Scroll", "Nloth's Gift", "NlothsMask",
+    "Nuclear Battery", "Nunchaku", "Odd Mushroom", "Oddly Smooth Stone", "Old Coin", "Omamori",
+    "OrangePellets", "Orichalcum", "Ornamental Fan", "Orrery", "Pandora's Box", "Pantograph",
+    "Paper Crane", "Paper Frog", "Peace Pipe", "Pear", "Pen Nib", "Philosopher's Stone",
+    "Pocketwatch", "Potion Belt", "Prayer Wheel", "PreservedInsect", "PrismaticShard", "PureWater",
+    "Question Card", "Red Circlet", "Red Mask", "Red Skull", "Regal Pillow", "Ring of the Serpent",
+    "Ring of the Snake", "Runic Capacitor", "Runic Cube", "Runic Dome", "Runic Pyramid",
+    "SacredBark", "Self Forming Clay", "Shovel", "Shuriken", "Singing Bowl", "SlaversCollar",
+    "Sling", "Smiling Mask", "Snake Skull", "Snecko Eye", "Sozu", "Spirit Poop", "SsserpentHead",
+    "StoneCalendar", "Strange Spoon", "Strawberry", "StrikeDummy", "Sundial", "Symbiotic Virus",
+    "TeardropLocket", "The Courier", "The Specimen", "TheAbacus", "Thread and Needle", "Tingsha",
+    "Tiny Chest", "Tiny House", "Toolbox", "Torii", "Tough Bandages", "Toxic Egg 2",
+    "Toy Ornithopter", "TungstenRod", "Turnip", "TwistedFunnel", "Unceasing Top", "Vajra",
+    "Velvet Choker", "VioletLotus", "War Paint", "WarpedTongs", "Whetstone", "White Beast Statue",
+    "WingedGreaves", "WristBlade", "Yang"
+};
+
+inline constexpr std::string_view kKnownPotionIds[] = {
+    "Ambrosia", "Ancient Potion", "AttackPotion", "BlessingOfTheForge", "Block Potion",
+    "BloodPotion", "BottledMiracle", "ColorlessPotion", "Cultist Potion", "CunningPotion",
+    "Dexterity Potion", "DistilledChaos", "DuplicationPotion", "ElixirPotion", "Energy Potion",
+    "EntropicBrew", "Essence of Steel", "EssenceOfDarkness", "Explosive Potion", "FairyPotion",
+    "FearPotion", "Fire Potion", "FocusPotion", "Fruit Juice", "GamblersBrew", "GhostInAJar",
+    "HeartOfIron", "LiquidBronze", "LiquidMemories", "Poison Potion", "Potion Slot",
+    "PotionOfCapacity", "PowerPotion", "Regen Potion", "SkillPotion", "SmokeBomb", "SneckoOil",
+    "SpeedPotion", "StancePotion", "Steroid Potion", "Strength Potion", "Swift Potion",
+    "Weak Potion"
+};
+
+inline constexpr std::string_view kKnownPowerIds[] = {
+    "Accuracy", "Adaptation", "After Image", "Amplify", "Angry", "Artifact", "BackAttack",
+    "Barricade", "BattleHymn", "Beat of Death", "Berserk", "Bias", "BlockReturnPower", "Blur",
+    "Brutality", "Buffer", "Burst", "CannotChangeStancePower", "Choked", "CollectPower", "Combust",
+    "Confusion", "Conserve", "Constricted", "Controlled", "Corruption", "Creative AI", "Curiosity",
+    "Curl Up", "Dark Embrace", "Demon Form", "DevaForm", "DevotionPower", "Dexterity",
+    "Double Damage", "Double Tap", "Draw Card", "Draw Reduction", "DuplicationPower", "Echo Form",
+    "Electro", "EndTurnDeath", "Energized", "EnergizedBlue", "EnergyDownPower", "Entangled",
+    "Envenom", "Equilibrium", "EstablishmentPower", "Evolve", "Explosive", "Fading", "Feel No Pain",
+    "Fire Breathing", "Flame Barrier", "Flex", "Flight", "Focus", "Frail", "FreeAttackPower",
+    "Generic Strength Up", "Heatsink", "Hello", "Hex", "Infinite Blades", "Intangible",
+    "IntangiblePlayer", "Invincible", "Juggernaut", "LikeWaterPower", "Lockon", "Loop",
+    "Lose Dexterity", "Lose Strength", "Magnetism", "Malleable", "Mantra", "MasterRealityPower",
+    "Mayhem", "Metallicize", "Minion", "Mode Shift", "Next Turn Block", "Nightmare", "Nirvana",
+    "No Draw", "Noxious Fumes", "OmegaPower", "Painful Stabs", "Panache", "PathToVictoryPower",
+    "Pen Nib", "Phantasmal", "Plated Armor", "Poison", "Rage", "Reactive", "Rebound", "Regenerate",
+    "Regeneration", "Regrow", "Repair", "Retain Cards", "Ritual", "Rupture", "Sadistic",
+    "Sharp Hide", "Shifting", "Skill Burn", "Slow", "Split", "Spore Cloud", "Stasis",
+    "StaticDischarge", "Storm", "Strength", "Study", "Surrounded", "Thievery", "Thorns",
+    "Thousand Cuts", "Time Warp", "Tools Of The Trade", "Unawakened", "Vigor", "Vulnerable",
+    "WaveOfTheHandPower", "Weakened", "WireheadingPower", "Wraith Form v2", "WrathNextTurnPower"
+};
+
+template <typename Id, size_t N>
+constexpr Id findKnownId(const std::string_view (&table)[N], std::string_view name) {
+    const std::string_view* it = std::lower_bound(std::begin(table), std::end(table), name);
+    return it != std::end(table) && *it == name ? static_cast<Id>(it - std::begin(table) + 1) : Id::NONE;
+}
+
+/**
+ * Look up a game ID in the known table only
+ * @param id Game ID, e.g. "Strike_R" (not the display name "Strike")
+ * @return Its ID, NONE if the table doesn't have it
+ */
+constexpr CardId knownCardId(std::string_view id) { return findKnownId<CardId>(kKnownCardIds, id); }
+constexpr RelicId knownRelicId(std::string_view id) { return findKnownId<RelicId>(kKnownRelicIds, id); }
+constexpr PotionId knownPotionId(std::string_view id) { return findKnownId<PotionId>(kKnownPotionIds, id); }
+constexpr PowerId knownPowerId(std::string_view id) { return findKnownId<PowerId>(kKnownPowerIds, id); }
+
+/**
+ * Check if an ID comes from the known table (and is stable across processes)
+ */
+constexpr bool isKnown(CardId id) { return id != CardId::NONE && static_cast<size_t>(id) <= std::size(kKnownCardIds); }
+constexpr bool isKnown(RelicId id) { return id != RelicId::NONE && static_cast<size_t>(id) <= std::size(kKnownRelicIds); }
+constexpr bool isKnown(PotionId id) { return id != PotionId::NONE && static_cast<size_t>(id) <= std::size(kKnownPotionIds); }
+constexpr bool isKnown(PowerId id) { return id != PowerId::NONE && static_cast<size_t>(id) <= std::size(kKnownPowerIds); }
+
+/**
+ * Get the ID of a game ID, interning it if no table knows it
+ * Known IDs are found with a hash lookup and no locking; thread-safe.
+ * @param id Game ID as sent by the server
+ * @return Its ID, NONE if id is empty or the interner is full
+ */
+CardId cardId(std::string_view id);
+RelicId relicId(std::string_view id);
+PotionId potionId(std::string_view id);
+PowerId powerId(std::string_view id);
+
+/**
+ * Get the game ID an ID stands for
+ * @return The game ID ("" for NONE); valid for the life of the process
+ */
+std::string_view toString(CardId id);
+std::string_view toString(RelicId id);
+std::string_view toString(PotionId id);
+std::string_view toString(PowerId id);
+
+} // namespace spirecomm
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "spirecomm/action.hpp"
+#include "spirecomm/game_state.hpp"
+
+namespace spirecomm {
+
+/**
+ * What a LegalAction does; each maps onto one Action factory
+ */
+enum class ActionKind : uint8_t {
+    PLAY_CARD,       // index = hand card, target = monster or -1
+    END_TURN,
+    USE_POTION,      // index = potion slot, target = monster or -1
+    DISCARD_POTION,  // index = potion slot
+    PROCEED,
+    CANCEL,
+    CHOOSE,          // index = choice
+    EVENT_OPTION,    // index = ScreenState::options
+    MAP_NODE,        // index = ScreenState::next_nodes
+    MAP_BOSS,
+    COMBAT_REWARD,   // index = ScreenState::rewards
+    CARD_REWARD,     // index = ScreenState::cards
+    SINGING_BOWL,
+    BOSS_REWARD,     // index = ScreenState::relics
+    BUY_CARD,        // index = ScreenState::cards
+    BUY_RELIC,       // index = ScreenState::relics
+    BUY_POTION,      // index = ScreenState::potions
+    BUY_PURGE,
+    REST,            // index = ScreenState::rest_options
+    OPEN_CHEST
+};
+
+/**
+ * One action the game accepts in a state
+ * Indices refer to the GameState it was enumerated from; names (cards,
+ * relics, rest options) are looked up from it again by toAction().
+ */
+struct LegalAction {
+    ActionKind kind = ActionKind::END_TURN;
+    int16_t index = -1;
+    int16_t target = -1;
+
+    /**
+     * Build the Action to send
+     * @param state State this action was enumerated from
+     */
+    Action toAction(const GameState& state) const;
+};
+
+/**
+ * Enumerate the actions available in a state
+ * Cards with every targetable monster they can hit, potions, the choices of
+ * the current screen and proceed / cancel, each only when its command is in
+ * available_commands. Shop items the player cannot afford are left out.
+ * Screens whose choice list is not part of the typed state (e.g. SHOP_ROOM)
+ * get a single CHOOSE 0. start, key, click, wait and state are never listed.
+ * Empty unless the state is ready for a command.
+ * @param state Typed state (needs the COMBAT, SCREEN and ITEMS sections for the matching actions)
+ * @param out Cleared and filled; keeps its capacity across calls
+ */
+void enumerateLegalActions(const GameState& state, std::vector<LegalAction>& out);
+
+} // namespace spirecomm
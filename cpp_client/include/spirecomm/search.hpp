@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "spirecomm/action.hpp"
+#include "spirecomm/combat_sim.hpp"
+
+namespace spirecomm {
+
+/**
+ * Configuration for CombatSearch
+ */
+struct SearchConfig {
+    int num_threads = 0;          // Worker threads (0 = hardware concurrency)
+    int num_trees = 0;            // Independent root-parallel trees (0 = one per thread)
+    int budget_ms = 50;           // Wall-clock budget per search
+    uint64_t max_iterations = 0;  // Stop early after this many rollouts in total (0 = budget only)
+    size_t max_nodes = 1 << 18;   // Node cap per tree; past it leaves are rolled out without expanding
+    double exploration = 0.7;     // UCT exploration constant (values are in [0, 1])
+    int rollout_turns = 8;        // Turns a rollout plays past the leaf before it is scored
+    uint64_t seed = 0;            // Seed for rollouts and sampled draws
+};
+
+/**
+ * Outcome of CombatSearch::search()
+ */
+struct SearchResult {
+    SimStatus status = SimStatus::ILLEGAL;  // OK when actions holds a plan
+    std::string error;                      // Why the combat could not be searched
+    std::vector<Action> actions;            // Plan for the current turn, ready for sendActions()
+    double value = 0;                       // Mean score of the first action, in [0, 1]
+    uint64_t iterations = 0;                // Rollouts across all trees
+    uint64_t nodes = 0;                     // Tree nodes across all trees
+    uint64_t steals = 0;                    // Tree slices a worker took from another worker's queue
+    double elapsed_ms = 0;
+    bool skipped_unsupported = false;       // Some playable cards were left out because the model cannot play them
+};
+
+/**
+ * Monte Carlo tree search over CombatSim
+ *
+ * Runs UCT rollouts from a combat across a pool of worker threads within a
+ * wall-clock budget and returns the best line for the current turn. The
+ * search is root-parallel: every tree searches the same root with its own
+ * random stream, and their root statistics are summed before choosing. Each
+ * tree is a task that is requeued after every slice of iterations; workers
+ * serve their own queue first and steal from the others when it runs dry.
+ *
+ * Nothing is allocated per rollout. Tree nodes live in per-tree arenas that
+ * keep their capacity between searches, and nodes do not store states: the
+ * root is shared read-only by every tree, and each iteration copies it into
+ * a worker-local scratch CombatSim only to write to it (a flat copy, since
+ * CombatSim never allocates).
+ *
+ * Moves are identified by card (id, cost, upgrade) and target rather than by
+ * hand index, so a node means the same play whatever was drawn before it.
+ * Scores are 0 for a loss, above 0.6 for a win (more with more HP left) and
+ * in between by HP and damage dealt when a rollout hits its turn limit.
+ *
+ * The plan stops at END, or right after a play that draws or picks a random
+ * target, since what follows depends on cards the game has not revealed
+ * yet; search again on the resulting state.
+ *
+ * Usage:
+ *   CombatSearch search;   // Threads start here and are reused by every search
+ *   SearchResult result = search.search(client.getGameState());
+ *   if (result.status == SimStatus::OK) {
+ *       client.sendActions(result.actions);
+ *   } else {
+ *       // Not modelled: fall back to another policy
+ *   }
+ */
+class CombatSearch {
+public:
+    explicit CombatSearch(const SearchConfig& config = SearchConfig());
+    ~CombatSearch();
+
+    // Non-copyable, non-movable (owns the worker threads)
+    CombatSearch(const CombatSearch&) = delete;
+    CombatSearch& operator=(const CombatSearch&) = delete;
+
+    /**
+     * Search from a loaded simulator state
+     * Not thread-safe: one search runs at a time per CombatSearch.
+     * @param root Combat to search (not modified)
+     * @return Best plan, or ILLEGAL if the combat is over
+     */
+    SearchResult search(const CombatSim& root);
+
+    /**
+     * Load the combat from a state and search it
+     * @param state State with in_combat set
+     * @return As above, or UNSUPPORTED with error set if the simulator cannot load it
+     */
+    SearchResult search(const GameState& state);
+
+    /**
+     * Get number of worker threads
+     */
+    size_t numThreads() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace spirecomm
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace spirecomm {
+
+/**
+ * Fixed-size histogram with power-of-two buckets
+ * Bucket 0 holds 0, bucket i holds [2^(i-1), 2^i); the last bucket is
+ * open-ended. Recording never allocates, so it is cheap enough to leave on.
+ * Used for latencies in microseconds and for small counts.
+ */
+struct Histogram {
+    static constexpr size_t kBuckets = 32;
+
+    std::array<uint64_t, kBuckets> buckets{};
+    uint64_t count = 0;
+    uint64_t total = 0;
+    uint64_t max = 0;
+
+    /**
+     * Record one sample
+     */
+    void record(uint64_t value);
+
+    /**
+     * Get mean of all samples (0 if empty)
+     */
+    double mean() const;
+
+    /**
+     * Get an upper bound on a percentile
+     * @param p Fraction in [0, 1] (e.g. 0.99)
+     * @return Upper edge of the bucket holding the percentile, capped at max
+     */
+    uint64_t percentile(double p) const;
+};
+
+/**
+ * Counters for one HTTP endpoint
+ * Byte counts are body sizes (headers are not visible to the client).
+ */
+struct EndpointStats {
+    uint64_t requests = 0;
+    uint64_t failures = 0;        // No response, or a 4xx/5xx status
+    uint64_t not_modified = 0;    // 304 answers (state unchanged)
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    Histogram round_trip_us;      // Request sent to response read
+};
+
+/**
+ * Client instrumentation, see SpireCommClient::getStats()
+ */
+struct ClientStats {
+    EndpointStats health;         // GET /health
+    EndpointStats state;          // GET /state (plain, long-poll and delta resync)
+    EndpointStats action;         // POST /action (single actions and batches)
+    EndpointStats stream;         // GET /stream (one request per subscribe(), failed if it ends unrequested)
+
+    uint64_t states = 0;          // New state versions parsed
+    uint64_t decisions = 0;       // Successful POST /action calls
+    Histogram parse_us;           // Decode + parse time per new state (DOM or SAX)
+    Histogram action_to_ready_us; // Action accepted to the next state ready for a command
+    Histogram polls_per_decision; // State requests between consecutive actions
+
+    double elapsed_seconds = 0;   // Since the client was created or stats were reset
+
+    /**
+     * Format as a multi-line human-readable report
+     */
+    std::string toString() const;
+};
+
+} // namespace spirecomm
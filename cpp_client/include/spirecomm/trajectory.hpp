@@ -0,0 +1,240 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "spirecomm/action.hpp"
+#include "spirecomm/features.hpp"
+#include "spirecomm/game_state.hpp"
+#include "spirecomm/legal_actions.hpp"
+
+namespace spirecomm {
+
+/**
+ * Trajectory files: (state, action, next state) transitions for offline
+ * training, with states stored as encodeFeatures() rows
+ *
+ * Layout (little-endian): a 32-byte file header, then chunks of up to
+ * chunk_rows transitions. Each chunk is a 32-byte chunk header followed by
+ * four sections, each padded to 32 bytes:
+ *   records      rows x TransitionRecord
+ *   states       rows x feature_count floats, row-major
+ *   next states  rows x feature_count floats, row-major
+ *   strings      action bodies, referenced by TransitionRecord
+ * Feature rows start 32-byte aligned in the file, so a mapped chunk can be
+ * handed to a model or an aligned SIMD loop without copying.
+ */
+namespace trajectory {
+
+constexpr uint32_t kMagic = 0x4A525453;       // "STRJ"
+constexpr uint32_t kChunkMagic = 0x4B484354;  // "TCHK"
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kAlignment = 32;
+constexpr size_t kFileHeaderSize = 32;
+constexpr size_t kChunkHeaderSize = 32;
+constexpr uint8_t kNoActionKind = 0xFF;  // TransitionRecord::action_kind of a plain Action
+
+} // namespace trajectory
+
+/**
+ * Fixed-width part of one transition
+ */
+struct TransitionRecord {
+    uint64_t state_version = 0;
+    uint64_t next_state_version = 0;
+    uint32_t action_offset = 0;   // Action body within the chunk's strings
+    uint32_t action_length = 0;
+    float reward = 0.0f;
+    uint8_t action_kind = trajectory::kNoActionKind;  // ActionKind when logged from a LegalAction
+    uint8_t done = 0;
+    int16_t action_index = -1;    // LegalAction::index and target, -1 for a plain Action
+    int16_t action_target = -1;
+    uint16_t reserved = 0;
+};
+
+static_assert(sizeof(TransitionRecord) == 40, "TransitionRecord is part of the file format");
+
+/**
+ * Appends transitions to a trajectory file without blocking the caller
+ *
+ * append() encodes both states straight into the current chunk and, once
+ * the chunk buffers are warm, allocates nothing. Full chunks are handed to
+ * a background thread that writes them to disk (the only time append()
+ * takes a lock), and their buffers come back for reuse. If the disk falls
+ * behind, chunks queue up in memory rather than stall the play loop.
+ *
+ * A writer is used from one thread. The file is complete once close() (or
+ * the destructor) returns; a crash loses at most the chunks not yet written,
+ * and readers ignore a truncated last chunk.
+ *
+ * Usage:
+ *   TrajectoryWriter log;
+ *   log.open("run.strj", error);
+ *   GameState before = client.getGameState();   // Reuse across steps
+ *   if (client.executeAndWait(action)) {
+ *       const GameState& after = client.getGameState();
+ *       log.append(before, action, after, reward, after.screen_type == ScreenType::GAME_OVER);
+ *   }
+ */
+class TrajectoryWriter {
+public:
+    static constexpr size_t kDefaultChunkRows = 256;
+
+    /**
+     * @param chunk_rows Transitions per chunk (at least 1)
+     */
+    explicit TrajectoryWriter(size_t chunk_rows = kDefaultChunkRows);
+
+    /**
+     * Destructor (closes the file)
+     */
+    ~TrajectoryWriter();
+
+    // Owns a thread; neither copyable nor movable
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    /**
+     * Create (or truncate) the file, write its header and start the writer thread
+     * @return false with error set if the file cannot be created
+     */
+    bool open(const std::string& path, std::string& error);
+
+    /**
+     * Append one transition
+     * @param state State the action was chosen in
+     * @param action Action sent (its body is stored as JSON)
+     * @param next_state State the action resulted in
+     * @param reward Reward to store with the transition
+     * @param done Whether next_state ends the episode
+     */
+    void append(const GameState& state, const Action& action, const GameState& next_state,
+                float reward = 0.0f, bool done = false);
+
+    /**
+     * Append one transition whose action came from legalActions()
+     * Stores the action's kind, index and target next to its body.
+     */
+    void append(const GameState& state, const LegalAction& action, const GameState& next_state,
+                float reward = 0.0f, bool done = false);
+
+    /**
+     * Hand the current chunk to the writer thread and wait until every
+     * appended transition is on disk
+     * @return false if a write has failed, see getLastError()
+     */
+    bool flush();
+
+    /**
+     * Flush, stop the writer thread and close the file
+     */
+    void close();
+
+    bool isOpen() const;
+
+    /**
+     * Get number of transitions appended since open()
+     */
+    uint64_t transitions() const;
+
+    /**
+     * Get number of chunks handed to the writer thread and not yet written
+     */
+    size_t pendingChunks() const;
+
+    /**
+     * Get the error of the first failed write, empty if none
+     */
+    std::string getLastError() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+/**
+ * One chunk of a mapped trajectory file
+ * Pointers are into the mapping and valid while the reader stays open.
+ */
+struct TrajectoryChunk {
+    const TransitionRecord* records = nullptr;
+    const float* states = nullptr;        // rows x feature_count, row-major
+    const float* next_states = nullptr;
+    std::string_view strings;
+    size_t rows = 0;
+    size_t feature_count = 0;
+
+    const float* state(size_t row) const { return states + row * feature_count; }
+    const float* nextState(size_t row) const { return next_states + row * feature_count; }
+    std::string_view action(size_t row) const {
+        return strings.substr(records[row].action_offset, records[row].action_length);
+    }
+};
+
+/**
+ * Reads a trajectory file through a read-only memory mapping
+ *
+ * open() only walks the chunk headers; feature rows are read in place, so
+ * a data loader can sample transitions or feed whole chunks to a model
+ * without copying or parsing. Several readers (or processes) may map the
+ * same file at once.
+ *
+ * Usage:
+ *   TrajectoryReader reader;
+ *   if (reader.open("run.strj", error) && reader.layoutVersion() == Feature::kLayoutVersion) {
+ *       for (size_t c = 0; c < reader.chunks(); ++c) {
+ *           TrajectoryChunk chunk = reader.chunk(c);
+ *           train(chunk.states, chunk.next_states, chunk.records, chunk.rows);
+ *       }
+ *   }
+ */
+class TrajectoryReader {
+public:
+    TrajectoryReader();
+    ~TrajectoryReader();
+
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+    /**
+     * Map a trajectory file and index its chunks
+     * A truncated last chunk (the writer did not finish) is ignored.
+     * @return false with error set if the file is missing or not a trajectory file
+     */
+    bool open(const std::string& path, std::string& error);
+
+    void close();
+
+    /**
+     * Get Feature::kLayoutVersion of the writer; check it before training
+     */
+    uint32_t layoutVersion() const;
+
+    /**
+     * Get floats per feature row
+     */
+    size_t featureCount() const;
+
+    size_t chunks() const;
+    TrajectoryChunk chunk(size_t index) const;
+
+    /**
+     * Get total number of transitions
+     */
+    uint64_t size() const;
+
+    /**
+     * Find a transition by its position in the file
+     * @param index Transition index (< size())
+     * @param row Set to the row within the returned chunk
+     */
+    TrajectoryChunk locate(uint64_t index, size_t& row) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace spirecomm
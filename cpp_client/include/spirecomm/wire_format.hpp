@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+namespace spirecomm {
+
+/**
+ * Encoding of HTTP bodies exchanged with the server
+ * Binary formats carry the same document as JSON; they are smaller and
+ * cheaper to parse for large states (full deck, full map).
+ */
+enum class WireFormat : uint8_t {
+    JSON,     // application/json
+    MSGPACK,  // application/msgpack
+    CBOR      // application/cbor
+};
+
+/**
+ * Get the media type for a format (used for Accept and Content-Type)
+ */
+std::string_view contentType(WireFormat format);
+
+/**
+ * Get the format of a response from its Content-Type header
+ * @param content_type Header value, possibly with parameters (e.g. "application/json; charset=utf-8")
+ * @return Matching format, JSON if empty or unrecognized
+ */
+WireFormat wireFormatFromContentType(std::string_view content_type);
+
+/**
+ * Decode a body into a JSON DOM
+ * @param body Raw HTTP body
+ * @param format Encoding of body
+ * @return Parsed document
+ * @throws nlohmann::json::exception if the body is malformed
+ */
+nlohmann::json decodeBody(std::string_view body, WireFormat format);
+
+} // namespace spirecomm
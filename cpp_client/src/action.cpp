@@ -0,0 +1,276 @@
+#include "spirecomm/action.hpp"
+#include "spirecomm/game_state.hpp"
+#include <charconv>
+#include <cstring>
+#include <utility>
+
+namespace spirecomm {
+
+namespace {
+
+// Display name of the first item with the ID, or the game ID if none has it
+template <typename Item, typename Id>
+std::string_view nameOf(const GameState& state, const std::vector<Item>& items, Id id) {
+    for (const Item& item : items) {
+        if (item.id == id) {
+            return state.str(item.name);
+        }
+    }
+    return toString(id);
+}
+
+} // anonymous namespace
+
+// Builds the body {"type":"...",<fields>} field by field, straight into the action's buffer
+class Action::Writer {
+public:
+    explicit Writer(std::string_view type) : action(type) {
+        raw("{\"type\":\"");
+        raw(type);
+        raw("\"");
+    }
+
+    Writer& intField(std::string_view name, int value) {
+        key(name);
+        char digits[16];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        raw(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+        return *this;
+    }
+
+    Writer& boolField(std::string_view name, bool value) {
+        key(name);
+        raw(value ? "true" : "false");
+        return *this;
+    }
+
+    Writer& stringField(std::string_view name, std::string_view value) {
+        key(name);
+        string(value);
+        return *this;
+    }
+
+    // Array of count strings, element i given by value(i)
+    template <typename Value>
+    Writer& stringArrayField(std::string_view name, size_t count, Value value) {
+        key(name);
+        raw("[");
+        for (size_t i = 0; i < count; ++i) {
+            if (i != 0) {
+                raw(",");
+            }
+            string(value(i));
+        }
+        raw("]");
+        return *this;
+    }
+
+    Action finish() {
+        raw("}");
+        return std::move(action);
+    }
+
+private:
+    Action action;
+
+    void key(std::string_view name) {
+        raw(",\"");
+        raw(name);
+        raw("\":");
+    }
+
+    // Quoted JSON string; runs of plain characters are copied in one go
+    void string(std::string_view value) {
+        raw("\"");
+        size_t run = 0;
+        for (size_t i = 0; i < value.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(value[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            raw(value.substr(run, i - run));
+            run = i + 1;
+            if (c == '"') {
+                raw("\\\"");
+            } else if (c == '\\') {
+                raw("\\\\");
+            } else {
+                static const char hex[] = "0123456789abcdef";
+                char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                raw(std::string_view(escaped, sizeof(escaped)));
+            }
+        }
+        raw(value.substr(run));
+        raw("\"");
+    }
+
+    void raw(std::string_view text) {
+        if (action.heap_body.empty() && action.inline_size + text.size() <= kInlineCapacity) {
+            std::memcpy(action.inline_body.data() + action.inline_size, text.data(), text.size());
+            action.inline_size += static_cast<uint32_t>(text.size());
+            return;
+        }
+        if (action.heap_body.empty()) {
+            // Spill once; the inline buffer is ignored from here on
+            action.heap_body.reserve(kInlineCapacity * 2);
+            action.heap_body.assign(action.inline_body.data(), action.inline_size);
+        }
+        action.heap_body.append(text);
+    }
+};
+
+// Action: Play card (no target)
+Action Action::playCard(int card_index) {
+    return Writer("play_card").intField("card_index", card_index).finish();
+}
+
+// Action: Play card (with target)
+Action Action::playCard(int card_index, int target_index) {
+    return Writer("play_card").intField("card_index", card_index).intField("target_index", target_index).finish();
+}
+
+// Action: End turn
+Action Action::endTurn() {
+    return Writer("end_turn").finish();
+}
+
+// Action: Use potion (no target)
+Action Action::usePotion(int potion_index) {
+    return Writer("use_potion").intField("potion_index", potion_index).finish();
+}
+
+// Action: Use potion (with target)
+Action Action::usePotion(int potion_index, int target_index) {
+    return Writer("use_potion").intField("potion_index", potion_index).intField("target_index", target_index).finish();
+}
+
+// Action: Discard potion
+Action Action::discardPotion(int potion_index) {
+    return Writer("discard_potion").intField("potion_index", potion_index).finish();
+}
+
+// Action: Proceed
+Action Action::proceed() {
+    return Writer("proceed").finish();
+}
+
+Action Action::cancel() {
+    return Writer("cancel").finish();
+}
+
+Action Action::choose(int choice_index) {
+    return Writer("choose").intField("choice_index", choice_index).finish();
+}
+
+Action Action::chooseByName(std::string_view name) {
+    // Note: Generic choose with name is NOT supported by CommunicationMod.
+    // This method exists for compatibility but callers should use specific
+    // action methods (buyCard, rest, etc.) instead.
+    return Writer("choose").stringField("name", name).finish();
+}
+
+Action Action::rest(std::string_view option) {
+    return Writer("rest").stringField("option", option).finish();
+}
+
+Action Action::cardReward(std::string_view card_name, bool bowl) {
+    Writer writer("card_reward");
+    if (bowl) {
+        writer.boolField("bowl", true);
+    } else if (!card_name.empty()) {
+        writer.stringField("card_name", card_name);
+    }
+    return writer.finish();
+}
+
+Action Action::combatReward(int reward_index) {
+    // Combat rewards use choose with index
+    return choose(reward_index);
+}
+
+Action Action::bossReward(std::string_view relic_name) {
+    return Writer("boss_reward").stringField("relic_name", relic_name).finish();
+}
+
+Action Action::buyCard(std::string_view card_name) {
+    return Writer("buy_card").stringField("card_name", card_name).finish();
+}
+
+Action Action::buyRelic(std::string_view relic_name) {
+    return Writer("buy_relic").stringField("relic_name", relic_name).finish();
+}
+
+Action Action::buyPotion(std::string_view potion_name) {
+    return Writer("buy_potion").stringField("potion_name", potion_name).finish();
+}
+
+Action Action::buyPurge(std::string_view card_name) {
+    Writer writer("buy_purge");
+    if (!card_name.empty()) {
+        writer.stringField("card_name", card_name);
+    }
+    return writer.finish();
+}
+
+Action Action::cardSelect(const std::vector<std::string>& card_names) {
+    return Writer("card_select")
+        .stringArrayField("card_names", card_names.size(), [&](size_t i) { return std::string_view(card_names[i]); })
+        .finish();
+}
+
+Action Action::chooseMapNode(int x, int y) {
+    return Writer("choose_map_node").intField("x", x).intField("y", y).finish();
+}
+
+Action Action::chooseMapBoss() {
+    return Writer("choose_map_boss").finish();
+}
+
+Action Action::openChest() {
+    return Writer("open_chest").finish();
+}
+
+Action Action::eventOption(int choice_index) {
+    return Writer("event_option").intField("choice_index", choice_index).finish();
+}
+
+Action Action::startGame(std::string_view character, int ascension, std::string_view seed) {
+    Writer writer("start_game");
+    writer.stringField("character", character).intField("ascension", ascension);
+    if (!seed.empty()) {
+        writer.stringField("seed", seed);
+    }
+    return writer.finish();
+}
+
+Action Action::cardReward(const GameState& state, CardId card) {
+    return cardReward(nameOf(state, state.screen.cards, card));
+}
+
+Action Action::bossReward(const GameState& state, RelicId relic) {
+    return bossReward(nameOf(state, state.screen.relics, relic));
+}
+
+Action Action::buyCard(const GameState& state, CardId card) {
+    return buyCard(nameOf(state, state.screen.cards, card));
+}
+
+Action Action::buyRelic(const GameState& state, RelicId relic) {
+    return buyRelic(nameOf(state, state.screen.relics, relic));
+}
+
+Action Action::buyPotion(const GameState& state, PotionId potion) {
+    return buyPotion(nameOf(state, state.screen.potions, potion));
+}
+
+Action Action::buyPurge(const GameState& state, CardId card) {
+    return buyPurge(nameOf(state, state.deck, card));
+}
+
+Action Action::cardSelect(const GameState& state, const std::vector<CardId>& cards) {
+    return Writer("card_select")
+        .stringArrayField("card_names", cards.size(), [&](size_t i) { return nameOf(state, state.screen.cards, cards[i]); })
+        .finish();
+}
+
+} // namespace spirecomm
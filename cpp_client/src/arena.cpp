@@ -0,0 +1,62 @@
+#include "spirecomm/arena.hpp"
+#include <algorithm>
+
+namespace spirecomm {
+
+Arena::Arena(size_t block_size) : block_size(std::max<size_t>(block_size, 256)) {}
+
+void* Arena::allocate(size_t bytes, size_t alignment) {
+    while (true) {
+        if (current < blocks.size()) {
+            Block& block = blocks[current];
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+            size_t aligned = static_cast<size_t>(((base + offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base);
+            if (aligned + bytes <= block.size) {
+                offset = aligned + bytes;
+                return block.data.get() + aligned;
+            }
+            if (current + 1 < blocks.size()) {
+                used += offset;
+                ++current;
+                offset = 0;
+                continue;
+            }
+        }
+
+        // Out of blocks: add one big enough for this request
+        Block block;
+        block.size = std::max(block_size, bytes + alignment);
+        block.data = std::unique_ptr<std::byte[]>(new std::byte[block.size]);
+        if (!blocks.empty()) {
+            used += offset;
+        }
+        blocks.push_back(std::move(block));
+        current = blocks.size() - 1;
+        offset = 0;
+    }
+}
+
+void Arena::reset() {
+    if (blocks.size() > 1) {
+        // The last cycle needed several blocks: keep one that holds all of it
+        size_t total = bytesReserved();
+        blocks.clear();
+        Block block;
+        block.size = total;
+        block.data = std::unique_ptr<std::byte[]>(new std::byte[total]);
+        blocks.push_back(std::move(block));
+    }
+    current = 0;
+    offset = 0;
+    used = 0;
+}
+
+size_t Arena::bytesReserved() const {
+    size_t total = 0;
+    for (const Block& block : blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+} // namespace spirecomm
@@ -0,0 +1,295 @@
+#include "spirecomm/async_client.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace spirecomm {
+
+namespace {
+
+// How long each /state long-poll is held; bounds how long stop() waits for the state thread
+constexpr int kPollTimeoutMs = 500;
+
+// Back-off between state requests while the server is unreachable
+constexpr auto kReconnectDelay = std::chrono::milliseconds(100);
+
+} // anonymous namespace
+
+// PIMPL implementation
+struct SpireCommAsyncClient::Impl {
+    // One queued call to /action
+    struct ActionRequest {
+        std::vector<Action> actions;
+        bool batch = false;
+        bool abort_on_divergence = true;
+        std::promise<bool> done;
+    };
+
+    ClientConfig config;
+    SpireCommClient state_client;   // Used only by the state thread
+    SpireCommClient action_client;  // Used only by the action thread
+
+    std::atomic<StatePtr> latest;
+    std::atomic<bool> running{false};
+    std::atomic<bool> connected{false};
+
+    // Consumers waiting for a state newer than a version, and the state callback
+    std::mutex state_mutex;
+    std::vector<std::pair<uint64_t, std::promise<StatePtr>>> waiters;
+    StateCallback callback;
+
+    std::mutex action_mutex;
+    std::condition_variable action_cv;
+    std::deque<ActionRequest> action_queue;
+
+    mutable std::mutex error_mutex;
+    std::string last_error;
+
+    std::thread state_thread;
+    std::thread action_thread;
+
+    Impl(const ClientConfig& cfg) : config(cfg), state_client(snapshotConfig(cfg)), action_client(cfg) {}
+
+    // The state client publishes the snapshots handed to consumers
+    static ClientConfig snapshotConfig(ClientConfig cfg) {
+        cfg.publish_snapshots = true;
+        return cfg;
+    }
+
+    // Parts are streamed only when debug is enabled
+    template <typename... Parts>
+    void log(const Parts&... parts) {
+        if (config.debug) {
+            std::cerr << "[ASYNC] ";
+            (std::cerr << ... << parts);
+            std::cerr << std::endl;
+        }
+    }
+
+    void setError(const std::string& error) {
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            last_error = error;
+        }
+        log("Error: ", error);
+    }
+
+    // Make a new state visible to latestState(), pending futures and the callback
+    void publish(StatePtr state) {
+        latest.store(state);
+
+        StateCallback cb;
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            for (auto it = waiters.begin(); it != waiters.end();) {
+                if (state->state_version > it->first) {
+                    it->second.set_value(state);
+                    it = waiters.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            cb = callback;
+        }
+
+        if (cb) {
+            cb(state);
+        }
+    }
+
+    void stateLoop() {
+        uint64_t version = 0;
+        while (running.load()) {
+            if (state_client.waitForGameState(version, kPollTimeoutMs)) {
+                connected.store(true);
+                StatePtr state = state_client.snapshot();
+                version = state->state_version;
+                log("Published state version ", version);
+                publish(std::move(state));
+                continue;
+            }
+
+            // Timed out without a change, or the request failed
+            connected.store(state_client.isConnected());
+            if (!state_client.isConnected()) {
+                setError(state_client.getLastError());
+                std::this_thread::sleep_for(kReconnectDelay);
+            }
+        }
+    }
+
+    void actionLoop() {
+        while (true) {
+            ActionRequest request;
+            {
+                std::unique_lock<std::mutex> lock(action_mutex);
+                action_cv.wait(lock, [this] { return !running.load() || !action_queue.empty(); });
+                if (!running.load()) {
+                    return;  // stop() fails whatever is left in the queue
+                }
+                request = std::move(action_queue.front());
+                action_queue.pop_front();
+            }
+
+            bool ok = request.batch
+                ? action_client.sendActions(request.actions, request.abort_on_divergence)
+                : action_client.sendAction(request.actions.front());
+            if (!ok) {
+                setError(action_client.getLastError());
+            }
+            request.done.set_value(ok);
+        }
+    }
+
+    std::future<bool> enqueue(ActionRequest request) {
+        std::future<bool> result = request.done.get_future();
+        {
+            std::lock_guard<std::mutex> lock(action_mutex);
+            if (running.load()) {
+                action_queue.push_back(std::move(request));
+                action_cv.notify_one();
+                return result;
+            }
+        }
+
+        setError("Client not running");
+        request.done.set_value(false);
+        return result;
+    }
+};
+
+// Constructor
+SpireCommAsyncClient::SpireCommAsyncClient(const ClientConfig& config)
+    : pImpl(std::make_unique<Impl>(config)) {}
+
+// Destructor
+SpireCommAsyncClient::~SpireCommAsyncClient() {
+    stop();
+}
+
+// Connect and start the I/O threads
+bool SpireCommAsyncClient::start() {
+    if (pImpl->running.load()) {
+        return true;
+    }
+
+    // Both threads would need the one mapped ring or trace; only SpireCommClient supports those
+    const ClientConfig& config = pImpl->config;
+    if (!config.shm_path.empty() || !config.replay_path.empty() || !config.record_path.empty()) {
+        pImpl->setError("SpireCommAsyncClient does not support shm_path, replay_path or record_path; "
+                        "use SpireCommClient");
+        return false;
+    }
+
+    if (!pImpl->state_client.connect()) {
+        pImpl->setError(pImpl->state_client.getLastError());
+        return false;
+    }
+    if (!pImpl->action_client.connect()) {
+        pImpl->setError(pImpl->action_client.getLastError());
+        return false;
+    }
+
+    pImpl->connected.store(true);
+    pImpl->running.store(true);
+    pImpl->state_thread = std::thread([this] { pImpl->stateLoop(); });
+    pImpl->action_thread = std::thread([this] { pImpl->actionLoop(); });
+    pImpl->log("I/O threads started");
+    return true;
+}
+
+// Stop the I/O threads and fail anything still pending
+void SpireCommAsyncClient::stop() {
+    {
+        // Flip under the lock so the action thread cannot miss the wake-up
+        std::lock_guard<std::mutex> lock(pImpl->action_mutex);
+        if (!pImpl->running.exchange(false)) {
+            return;
+        }
+    }
+    pImpl->action_cv.notify_all();
+
+    if (pImpl->state_thread.joinable()) {
+        pImpl->state_thread.join();
+    }
+    if (pImpl->action_thread.joinable()) {
+        pImpl->action_thread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pImpl->action_mutex);
+        for (auto& request : pImpl->action_queue) {
+            request.done.set_value(false);
+        }
+        pImpl->action_queue.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(pImpl->state_mutex);
+        for (auto& waiter : pImpl->waiters) {
+            waiter.second.set_value(nullptr);
+        }
+        pImpl->waiters.clear();
+    }
+    pImpl->log("I/O threads stopped");
+}
+
+bool SpireCommAsyncClient::isRunning() const {
+    return pImpl->running.load();
+}
+
+bool SpireCommAsyncClient::isConnected() const {
+    return pImpl->connected.load();
+}
+
+std::string SpireCommAsyncClient::getLastError() const {
+    std::lock_guard<std::mutex> lock(pImpl->error_mutex);
+    return pImpl->last_error;
+}
+
+// Read of the newest snapshot, without the state mutex
+SpireCommAsyncClient::StatePtr SpireCommAsyncClient::latestState() const {
+    return pImpl->latest.load();
+}
+
+std::future<SpireCommAsyncClient::StatePtr> SpireCommAsyncClient::nextState(uint64_t since_version) {
+    std::promise<StatePtr> promise;
+    std::future<StatePtr> result = promise.get_future();
+
+    // Checked under the lock publish() fulfills waiters with, so no state is missed
+    std::lock_guard<std::mutex> lock(pImpl->state_mutex);
+    StatePtr state = pImpl->latest.load();
+    if (state && state->state_version > since_version) {
+        promise.set_value(std::move(state));
+    } else if (!pImpl->running.load()) {
+        promise.set_value(nullptr);
+    } else {
+        pImpl->waiters.emplace_back(since_version, std::move(promise));
+    }
+    return result;
+}
+
+void SpireCommAsyncClient::setStateCallback(StateCallback callback) {
+    std::lock_guard<std::mutex> lock(pImpl->state_mutex);
+    pImpl->callback = std::move(callback);
+}
+
+std::future<bool> SpireCommAsyncClient::sendActionAsync(Action action) {
+    Impl::ActionRequest request;
+    request.actions.push_back(std::move(action));
+    return pImpl->enqueue(std::move(request));
+}
+
+std::future<bool> SpireCommAsyncClient::sendActionsAsync(std::vector<Action> actions, bool abort_on_divergence) {
+    Impl::ActionRequest request;
+    request.actions = std::move(actions);
+    request.batch = true;
+    request.abort_on_divergence = abort_on_divergence;
+    return pImpl->enqueue(std::move(request));
+}
+
+} // namespace spirecomm
@@ -1,60 +1,648 @@
 #include "spirecomm/client.hpp"
 #include <nlohmann/json.hpp>
 #include <httplib.h>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <utility>
+#include "shm_transport.hpp"
+#include "trace.hpp"
 
 namespace spirecomm {
 
 using json = nlohmann::json;
 
+namespace {
+
+// Times a local state is re-read when the server overwrites it mid-parse
+constexpr int kLocalReadAttempts = 8;
+
+// How long subscribe() waits on a local transport per round
+constexpr int kLocalSubscribeWaitMs = 1000;
+
+// Storage of a retired snapshot, waiting to be refilled with a later state
+struct SnapshotPool {
+    std::mutex mutex;
+    std::unique_ptr<GameState> spare;
+};
+
+// Deleter of published snapshots: whichever thread drops the last reference
+// hands the storage back instead of freeing it. Holds the pool, so snapshots
+// may outlive the client.
+struct SnapshotRecycler {
+    std::shared_ptr<SnapshotPool> pool;
+
+    void operator()(const GameState* state) const {
+        std::unique_ptr<GameState> retired(const_cast<GameState*>(state));
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        std::swap(pool->spare, retired);  // An older spare, if any, is freed after unlocking
+    }
+};
+
+} // anonymous namespace
+
 // PIMPL implementation
 struct SpireCommClient::Impl {
+    using Clock = std::chrono::steady_clock;
+
     ClientConfig config;
     std::unique_ptr<httplib::Client> http_client;
+    std::unique_ptr<httplib::Client> stream_client;  // Dedicated /stream connection, created on first subscribe()
     json cached_state;
+    uint64_t state_version = 0;  // Version of cached_state (0 = nothing cached)
+    GameState game_state;        // Typed view of cached_state, rebuilt per version
+    Arena state_arena;           // Per-decision scratch, reset with every new game_state
+    std::vector<LegalAction> legal_actions;
+    std::optional<uint64_t> legal_actions_version;  // Version legal_actions was enumerated for, unset after a parse
+    std::atomic<std::shared_ptr<const GameState>> published;  // Copy of game_state for other threads (publish_snapshots)
+    std::shared_ptr<SnapshotPool> snapshot_pool = std::make_shared<SnapshotPool>();
+    GameState state_scratch;     // Parse target for state bodies, swapped into game_state once parsed (and validated)
+    std::unique_ptr<LocalTransport> local;  // Shared-memory or replay backend, replacing HTTP when set
+    std::unique_ptr<TraceWriter> recorder;  // Set when config.record_path is
+    std::string record_scratch;  // Copy of a local state body for the recorder
     bool connected = false;
     std::string last_error;
 
+    ClientStats stats;
+    Clock::time_point stats_start = Clock::now();
+    Clock::time_point last_dump = stats_start;
+    std::optional<Clock::time_point> action_sent_at;  // Latest accepted action not yet followed by a ready state
+    uint64_t polls_since_action = 0;
+
     Impl(const ClientConfig& cfg) : config(cfg) {
         // Create HTTP client
-        http_client = std::make_unique<httplib::Client>(
-            config.host.c_str(), config.port
-        );
-        http_client->set_connection_timeout(0, config.timeout_ms * 1000); // sec, usec
-        http_client->set_read_timeout(config.timeout_ms / 1000, (config.timeout_ms % 1000) * 1000);
+        http_client = makeConnection(config.timeout_ms);
+        if (!config.replay_path.empty()) {
+            local = std::make_unique<ReplayTransport>();
+        } else if (!config.shm_path.empty()) {
+            local = std::make_unique<ShmTransport>();
+        }
+        if (config.publish_snapshots) {
+            published.store(std::make_shared<const GameState>());
+        }
+    }
+
+    // Where the server is, for log and error messages
+    std::string address() const {
+        if (!config.replay_path.empty()) {
+            return "replay:" + config.replay_path;
+        }
+        if (!config.shm_path.empty()) {
+            return "shm:" + config.shm_path;
+        }
+        return config.unix_socket.empty() ? config.host + ":" + std::to_string(config.port) : "unix:" + config.unix_socket;
     }
 
-    void log(const std::string& message) {
+    // New connection to the server (TCP or Unix domain socket) with the configured tuning
+    std::unique_ptr<httplib::Client> makeConnection(int read_timeout_ms) const {
+        std::unique_ptr<httplib::Client> client;
+        if (config.unix_socket.empty()) {
+            client = std::make_unique<httplib::Client>(config.host.c_str(), config.port);
+        } else {
+            // For AF_UNIX httplib takes the socket path as the host; the port is unused
+            client = std::make_unique<httplib::Client>(config.unix_socket.c_str(), 80);
+            client->set_address_family(AF_UNIX);
+        }
+        client->set_connection_timeout(0, config.timeout_ms * 1000); // sec, usec
+        client->set_read_timeout(read_timeout_ms / 1000, (read_timeout_ms % 1000) * 1000);
+        configureConnection(*client);
+        return client;
+    }
+
+    // Persistent-connection and socket tuning shared by every connection of this client
+    void configureConnection(httplib::Client& client) const {
+        client.set_keep_alive(config.keep_alive);
+        client.set_tcp_nodelay(config.tcp_nodelay && config.unix_socket.empty());
+
+        if (config.socket_send_buffer > 0 || config.socket_recv_buffer > 0) {
+            // Replaces httplib's default options, which only matter for listening sockets
+            int send_buffer = config.socket_send_buffer;
+            int recv_buffer = config.socket_recv_buffer;
+            client.set_socket_options([send_buffer, recv_buffer](httplib::socket_t sock) {
+                if (send_buffer > 0) {
+                    setsockopt(sock, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&send_buffer), sizeof(send_buffer));
+                }
+                if (recv_buffer > 0) {
+                    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&recv_buffer), sizeof(recv_buffer));
+                }
+            });
+        }
+    }
+
+    // Parts are streamed only when debug is enabled, so disabled logging never formats or allocates
+    template <typename... Parts>
+    void log(const Parts&... parts) {
         if (config.debug) {
-            std::cerr << "[CLIENT] " << message << std::endl;
+            std::cerr << "[CLIENT] ";
+            (std::cerr << ... << parts);
+            std::cerr << std::endl;
         }
     }
 
     void setError(const std::string& error) {
         last_error = error;
-        log("Error: " + error);
+        log("Error: ", error);
+    }
+
+    static uint64_t elapsedUs(Clock::time_point since) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - since).count());
+    }
+
+    ClientStats snapshotStats() const {
+        ClientStats snapshot = stats;
+        snapshot.elapsed_seconds = std::chrono::duration<double>(Clock::now() - stats_start).count();
+        return snapshot;
+    }
+
+    void resetStats() {
+        stats = ClientStats();
+        stats_start = Clock::now();
+        last_dump = stats_start;
+        action_sent_at.reset();
+        polls_since_action = 0;
+    }
+
+    // Periodic report requested with config.stats_interval_ms
+    void maybeDumpStats() {
+        if (config.stats_interval_ms <= 0) {
+            return;
+        }
+        auto now = Clock::now();
+        if (now - last_dump < std::chrono::milliseconds(config.stats_interval_ms)) {
+            return;
+        }
+        last_dump = now;
+        std::cerr << "[CLIENT] " << snapshotStats().toString() << std::flush;
+    }
+
+    // Run one HTTP request, counting it against an endpoint
+    template <typename Request>
+    httplib::Result timed(EndpointStats& endpoint, size_t bytes_sent, Request&& request) {
+        auto start = Clock::now();
+        httplib::Result res = request();
+        endpoint.round_trip_us.record(elapsedUs(start));
+        ++endpoint.requests;
+        endpoint.bytes_sent += bytes_sent;
+        if (!res || res->status >= 400) {
+            ++endpoint.failures;
+        } else {
+            endpoint.bytes_received += res->body.size();
+            if (res->status == 304) {
+                ++endpoint.not_modified;
+            }
+        }
+        maybeDumpStats();
+        return res;
+    }
+
+    httplib::Result getStateResource(const std::string& path, const httplib::Headers& headers) {
+        ++polls_since_action;
+        return timed(stats.state, 0, [&] { return http_client->Get(path, headers); });
+    }
+
+    // Append a newly parsed state to the trace, as JSON
+    void recordState(uint64_t version, std::string_view body, WireFormat format = WireFormat::JSON) {
+        if (!recorder) {
+            return;
+        }
+        if (format == WireFormat::JSON) {
+            recorder->writeState(version, body);
+        } else {
+            recorder->writeState(version, decodeBody(body, format).dump());
+        }
+    }
+
+    // Account for a newly parsed state version
+    void stateParsed(Clock::time_point parse_start) {
+        state_arena.reset();
+        legal_actions_version.reset();
+        if (config.publish_snapshots) {
+            publishSnapshot();
+        }
+        stats.parse_us.record(elapsedUs(parse_start));
+        ++stats.states;
+        if (action_sent_at && game_state.ready_for_command) {
+            stats.action_to_ready_us.record(elapsedUs(*action_sent_at));
+            action_sent_at.reset();
+        }
+    }
+
+    // Swap a copy of game_state in for snapshot() readers
+    void publishSnapshot() {
+        std::unique_ptr<GameState> storage;
+        {
+            std::lock_guard<std::mutex> lock(snapshot_pool->mutex);
+            storage = std::move(snapshot_pool->spare);
+        }
+        if (storage) {
+            *storage = game_state;  // Keeps the retired snapshot's capacity
+        } else {
+            storage = std::make_unique<GameState>(game_state);
+        }
+        published.store(std::shared_ptr<const GameState>(storage.release(), SnapshotRecycler{snapshot_pool}));
+    }
+
+    // What the const helpers read: the published snapshot, or game_state itself (not owned)
+    std::shared_ptr<const GameState> currentState() const {
+        if (config.publish_snapshots) {
+            return published.load();
+        }
+        return std::shared_ptr<const GameState>(std::shared_ptr<const GameState>(), &game_state);
+    }
+
+    bool sendAction(const Action& action) {
+        return postAction(action.body());
+    }
+
+    // Splice pre-serialized action bodies into {"actions":[...],"abort_on_divergence":...}
+    static std::string batchBody(const std::vector<Action>& actions, bool abort_on_divergence) {
+        size_t size = 64;
+        for (const auto& action : actions) {
+            size += action.body().size() + 1;
+        }
+        std::string batch;
+        batch.reserve(size);
+        batch += "{\"actions\":[";
+        for (size_t i = 0; i < actions.size(); ++i) {
+            if (i != 0) {
+                batch += ',';
+            }
+            batch += actions[i].body();
+        }
+        batch += abort_on_divergence ? "],\"abort_on_divergence\":true}" : "],\"abort_on_divergence\":false}";
+        return batch;
+    }
+
+    // Read the id of the (last) queued action from an /action response
+    bool readActionId(const std::string& response, uint64_t& action_id) {
+        json body = json::parse(response, nullptr, false);
+        const json* id = nullptr;
+        if (body.is_object()) {
+            auto ids = body.find("action_ids");
+            auto single = body.find("action_id");
+            if (ids != body.end() && ids->is_array() && !ids->empty()) {
+                id = &ids->back();
+            } else if (single != body.end()) {
+                id = &*single;
+            }
+        }
+        if (id && id->is_number_unsigned()) {
+            action_id = id->get<uint64_t>();
+            return true;
+        }
+        setError("Server did not report an action id (server too old?)");
+        return false;
+    }
+
+    // action_id, if given, is set to the id the server assigned (the last one for a batch)
+    bool postAction(std::string_view body, uint64_t* action_id = nullptr) {
+        // Built once so each request does not construct them (the content type is past the SSO limit)
+        static const std::string kActionPath = "/action";
+        static const std::string kContentType = "application/json";
+
+        log("Sending action: ", body);
+
+        if (local) {
+            if (!pushLocalAction(body, action_id)) {
+                return false;
+            }
+        } else {
+            auto res = timed(stats.action, body.size(), [&] {
+                return http_client->Post(kActionPath, body.data(), body.size(), kContentType);
+            });
+
+            if (!res) {
+                setError("Failed to send action (no response)");
+                return false;
+            }
+
+            if (res->status != 200) {
+                setError("Send action failed (status " + std::to_string(res->status) + ")");
+                if (!res->body.empty()) {
+                    log("Response body: ", res->body);
+                }
+                return false;
+            }
+
+            if (action_id && !readActionId(res->body, *action_id)) {
+                return false;
+            }
+        }
+
+        if (recorder) {
+            recorder->writeAction(body);
+        }
+
+        ++stats.decisions;
+        stats.polls_per_decision.record(polls_since_action);
+        polls_since_action = 0;
+        action_sent_at = Clock::now();
+
+        log("Action sent successfully");
+        return true;
+    }
+
+    // Send an /action body through the local transport, optionally getting its id back
+    bool pushLocalAction(std::string_view body, uint64_t* action_id) {
+        std::string error;
+        auto start = Clock::now();
+        bool ok = local->pushAction(body, config.timeout_ms, error, action_id);
+        stats.action.round_trip_us.record(elapsedUs(start));
+        ++stats.action.requests;
+        stats.action.bytes_sent += body.size();
+        if (!ok) {
+            ++stats.action.failures;
+            setError(error);
+        }
+        maybeDumpStats();
+        return ok;
+    }
+
+    // Parse the newest local state if it is newer than known_version, in place
+    // from the mapping. The body is validated after parsing and re-read if the
+    // server overwrote it meanwhile. With dom, cached_state is rebuilt as well.
+    // Returns true if a new state was parsed.
+    bool readLocalState(uint64_t known_version, bool dom) {
+        ++stats.state.requests;
+        ++polls_since_action;
+        for (int attempt = 0; attempt < kLocalReadAttempts; ++attempt) {
+            LocalTransport::StateView view;
+            if (!local->latest(view) || view.version <= known_version) {
+                ++stats.state.not_modified;
+                return false;
+            }
+
+            auto parse_start = Clock::now();
+            bool valid = false;
+            if (dom) {
+                try {
+                    json body = json::parse(view.body.begin(), view.body.end());
+                    if (local->stillValid(view)) {
+                        cached_state = std::move(body);
+                        state_version = view.version;
+                        parseGameState(cached_state, game_state, config.state_sections);
+                        valid = true;
+                    }
+                } catch (const json::exception&) {
+                    valid = false;  // Torn by the writer, or really malformed (then every attempt fails)
+                }
+            } else if (parseGameStateBody(view.body, state_scratch, config.state_sections)) {
+                if (recorder) {
+                    record_scratch.assign(view.body);  // Copied before the check, so the copy is validated too
+                }
+                if (local->stillValid(view)) {
+                    std::swap(game_state, state_scratch);
+                    valid = true;
+                }
+            }
+
+            if (valid) {
+                stats.state.bytes_received += view.body.size();
+                stateParsed(parse_start);
+                // The mapping may be overwritten after stillValid(); record only validated copies
+                if (recorder) {
+                    recordState(view.version, dom ? cached_state.dump() : record_scratch);
+                }
+                log("Local state (version ", view.version, ")");
+                return true;
+            }
+            log("Local state ", view.version, " changed while parsing, retrying");
+        }
+        ++stats.state.failures;
+        setError("Failed to read a consistent state from " + address());
+        return false;
+    }
+
+    // Wait for and parse a local state newer than since_version
+    bool waitForLocalState(uint64_t since_version, int timeout_ms, bool dom) {
+        if (local->waitForVersion(since_version, timeout_ms) > since_version) {
+            return readLocalState(since_version, dom);
+        }
+        if (local->exhausted()) {
+            connected = false;
+            setError("Replay finished");
+        }
+        return false;
+    }
+
+    // Query string for /state requests: in delta mode ask for a patch against the cached version
+    std::string stateQuery() const {
+        if (config.delta_updates && state_version != 0) {
+            return "delta=1&since=" + std::to_string(state_version);
+        }
+        return "";
+    }
+
+    // Headers asking for /state responses in the configured wire format
+    httplib::Headers acceptHeaders() const {
+        httplib::Headers headers;
+        if (config.wire_format != WireFormat::JSON) {
+            headers.emplace("Accept", std::string(contentType(config.wire_format)));
+        }
+        return headers;
+    }
+
+    // Headers for /state requests: advertise the cached version so the server can
+    // answer 304 instead of resending a state we already have
+    httplib::Headers stateRequestHeaders(uint64_t cached_version) const {
+        httplib::Headers headers = acceptHeaders();
+        if (cached_version != 0) {
+            headers.emplace("If-None-Match", "\"" + std::to_string(cached_version) + "\"");
+        }
+        return headers;
     }
 
-    bool sendAction(const json& action_json) {
-        log("Sending action: " + action_json.dump());
+    // Encoding the server chose for a response
+    static WireFormat responseFormat(const httplib::Response& res) {
+        return wireFormatFromContentType(res.get_header_value("Content-Type"));
+    }
+
+    // Shared handling of /state responses for getState() and waitForState()
+    // On 304, getState() hands back the cached state while waitForState() reports a timeout.
+    std::optional<json> handleStateResponse(const httplib::Result& res, bool cached_on_not_modified) {
+        if (!res) {
+            connected = false;
+            setError("Failed to get state (no response)");
+            return std::nullopt;
+        }
+        connected = true;
+
+        if (res->status == 204) {
+            // No content - no state available yet
+            log("No state available yet (204)");
+            return std::nullopt;
+        }
+
+        if (res->status == 304) {
+            // Not modified - nothing to download or parse
+            log("State unchanged (304)");
+            if (cached_on_not_modified && state_version != 0) {
+                return cached_state;
+            }
+            return std::nullopt;
+        }
+
+        if (res->status != 200) {
+            setError("Get state failed (status " + std::to_string(res->status) + ")");
+            return std::nullopt;
+        }
+
+        try {
+            auto parse_start = Clock::now();
+            json body = decodeBody(res->body, responseFormat(*res));
+
+            if (body.contains("patch")) {
+                // Delta response - apply in place onto the cached state
+                if (!applyPatch(body)) {
+                    return std::nullopt;
+                }
+            } else {
+                // Full snapshot
+                cached_state = std::move(body);
+                state_version = cached_state.value("state_version", uint64_t{0});
+            }
+
+            parseGameState(cached_state, game_state, config.state_sections);
+            stateParsed(parse_start);
+            if (recorder) {
+                recorder->writeState(state_version, cached_state.dump());
+            }
+
+            log("State retrieved successfully (version ", state_version, ")");
+
+            return cached_state;
 
-        auto res = http_client->Post("/action", action_json.dump(), "application/json");
+        } catch (const json::exception& e) {
+            setError("Failed to parse state JSON: " + std::string(e.what()));
+            return std::nullopt;
+        }
+    }
 
+    // Shared handling of /state responses for fetchGameState() and waitForGameState()
+    // The body is streamed into game_state without going through the JSON cache;
+    // a body that fails to parse leaves game_state as it was.
+    bool handleGameStateResponse(const httplib::Result& res, bool accept_not_modified) {
         if (!res) {
-            setError("Failed to send action (no response)");
+            connected = false;
+            setError("Failed to get state (no response)");
+            return false;
+        }
+        connected = true;
+
+        if (res->status == 204) {
+            log("No state available yet (204)");
             return false;
         }
 
+        if (res->status == 304) {
+            log("State unchanged (304)");
+            return accept_not_modified && game_state.state_version != 0;
+        }
+
         if (res->status != 200) {
-            setError("Send action failed (status " + std::to_string(res->status) + ")");
-            if (!res->body.empty()) {
-                log("Response body: " + res->body);
-            }
+            setError("Get state failed (status " + std::to_string(res->status) + ")");
             return false;
         }
 
-        log("Action sent successfully");
+        auto parse_start = Clock::now();
+        if (!parseGameStateBody(res->body, state_scratch, config.state_sections, responseFormat(*res))) {
+            setError("Failed to parse state JSON");
+            return false;
+        }
+        std::swap(game_state, state_scratch);
+        stateParsed(parse_start);
+        recordState(game_state.state_version, res->body, responseFormat(*res));
+
+        log("State retrieved successfully (version ", game_state.state_version, ")");
+        return true;
+    }
+
+    // Handle one Server-Sent Event from /stream; returns false to end the subscription
+    bool handleStreamEvent(std::string_view event, const std::function<bool(const GameState&)>& callback) {
+        std::string_view type = "message";
+        std::string data;
+        while (!event.empty()) {
+            size_t end = event.find('\n');
+            std::string_view line = event.substr(0, end);
+            event = end == std::string_view::npos ? std::string_view() : event.substr(end + 1);
+
+            if (line.empty() || line.front() == ':') {
+                continue;  // Keep-alive comment
+            }
+            size_t colon = line.find(':');
+            std::string_view field = line.substr(0, colon);
+            std::string_view value = colon == std::string_view::npos ? std::string_view() : line.substr(colon + 1);
+            if (!value.empty() && value.front() == ' ') {
+                value.remove_prefix(1);
+            }
+
+            if (field == "event") {
+                type = value;
+            } else if (field == "data") {
+                if (!data.empty()) {
+                    data += '\n';
+                }
+                data.append(value);
+            }
+        }
+
+        if (type != "state" || data.empty()) {
+            return true;
+        }
+        auto parse_start = Clock::now();
+        if (!parseGameStateBody(data, state_scratch, config.state_sections)) {
+            setError("Failed to parse streamed state JSON");
+            return true;
+        }
+        std::swap(game_state, state_scratch);
+        stateParsed(parse_start);
+        recordState(game_state.state_version, data);
+        log("Streamed state (version ", game_state.state_version, ")");
+        return callback(game_state);
+    }
+
+    // GET a long-poll path, extending the read timeout by the time the server may hold it
+    httplib::Result longPoll(const std::string& path, const httplib::Headers& headers, int timeout_ms) {
+        int read_timeout_ms = timeout_ms + config.timeout_ms;
+        http_client->set_read_timeout(read_timeout_ms / 1000, (read_timeout_ms % 1000) * 1000);
+        auto res = getStateResource(path, headers);
+        http_client->set_read_timeout(config.timeout_ms / 1000, (config.timeout_ms % 1000) * 1000);
+        return res;
+    }
+
+    // Apply a {"base_version", "state_version", "patch"} delta onto cached_state.
+    // On a version gap or a patch that does not apply, the cache is dropped and a
+    // full snapshot is fetched instead.
+    bool applyPatch(const json& delta) {
+        uint64_t base_version = delta.value("base_version", uint64_t{0});
+
+        if (base_version == state_version) {
+            try {
+                cached_state.patch_inplace(delta["patch"]);
+                state_version = delta.value("state_version", uint64_t{0});
+                log("Applied delta ", base_version, " -> ", state_version, " (", delta["patch"].size(), " ops)");
+                return true;
+            } catch (const json::exception& e) {
+                log("Failed to apply delta: ", e.what());
+            }
+        } else {
+            log("Delta base ", base_version, " does not match cached version ", state_version);
+        }
+
+        // Resynchronize from a full snapshot
+        cached_state = json();
+        state_version = 0;
+
+        auto res = getStateResource("/state", acceptHeaders());
+        if (!res || res->status != 200) {
+            setError("Failed to resynchronize state after bad delta");
+            return false;
+        }
+        cached_state = decodeBody(res->body, responseFormat(*res));
+        state_version = cached_state.value("state_version", uint64_t{0});
         return true;
     }
 };
@@ -75,9 +663,31 @@ SpireCommClient& SpireCommClient::operator=(SpireCommClient&&) noexcept = defaul
 
 // Connect to server
 bool SpireCommClient::connect() {
-    pImpl->log("Connecting to server at " + pImpl->config.host + ":" + std::to_string(pImpl->config.port));
+    pImpl->log("Connecting to server at ", pImpl->address());
+
+    if (!pImpl->config.record_path.empty() && !pImpl->recorder) {
+        std::string error;
+        auto recorder = std::make_unique<TraceWriter>();
+        if (!recorder->open(pImpl->config.record_path, error)) {
+            pImpl->setError(error);
+            return false;
+        }
+        pImpl->recorder = std::move(recorder);
+    }
+
+    if (pImpl->local) {
+        std::string error;
+        const std::string& path = pImpl->config.replay_path.empty() ? pImpl->config.shm_path : pImpl->config.replay_path;
+        pImpl->connected = pImpl->local->open(path, error);
+        if (!pImpl->connected) {
+            pImpl->setError(error);
+            return false;
+        }
+        pImpl->log("Mapped ", pImpl->address());
+        return true;
+    }
 
-    auto res = pImpl->http_client->Get("/health");
+    auto res = pImpl->timed(pImpl->stats.health, 0, [&] { return pImpl->http_client->Get("/health"); });
 
     if (!res) {
         pImpl->setError("Failed to connect to server (no response)");
@@ -120,289 +730,374 @@ std::string SpireCommClient::getLastError() const {
     return pImpl->last_error;
 }
 
+ClientStats SpireCommClient::getStats() const {
+    return pImpl->snapshotStats();
+}
+
+void SpireCommClient::resetStats() {
+    pImpl->resetStats();
+}
+
 // Get state from server
 std::optional<json> SpireCommClient::getState() {
-    auto res = pImpl->http_client->Get("/state");
+    if (pImpl->local) {
+        pImpl->readLocalState(pImpl->state_version, true);
+        return pImpl->state_version != 0 ? std::optional<json>(pImpl->cached_state) : std::nullopt;
+    }
 
-    if (!res) {
-        pImpl->setError("Failed to get state (no response)");
+    std::string query = pImpl->stateQuery();
+    std::string path = query.empty() ? "/state" : "/state?" + query;
+    auto res = pImpl->getStateResource(path, pImpl->stateRequestHeaders(pImpl->state_version));
+    return pImpl->handleStateResponse(res, true);
+}
+
+// Long-poll for a state newer than since_version
+std::optional<json> SpireCommClient::waitForState(uint64_t since_version, int timeout_ms) {
+    if (pImpl->local) {
+        if (pImpl->waitForLocalState(since_version, timeout_ms, true)) {
+            return pImpl->cached_state;
+        }
         return std::nullopt;
     }
 
-    if (res->status == 204) {
-        // No content - no state available yet
-        pImpl->log("No state available yet (204)");
-        return std::nullopt;
+    std::string path = "/state?since=" + std::to_string(since_version) +
+                       "&wait=" + std::to_string(timeout_ms);
+    if (pImpl->config.delta_updates && since_version != 0 && since_version == pImpl->state_version) {
+        // Only ask for a delta when the server's base is the state we have cached
+        path += "&delta=1";
     }
 
-    if (res->status != 200) {
-        pImpl->setError("Get state failed (status " + std::to_string(res->status) + ")");
-        return std::nullopt;
+    auto res = pImpl->longPoll(path, pImpl->acceptHeaders(), timeout_ms);
+    return pImpl->handleStateResponse(res, false);
+}
+
+// Fetch state into the typed view without a JSON DOM
+bool SpireCommClient::fetchGameState() {
+    if (pImpl->local) {
+        pImpl->readLocalState(pImpl->game_state.state_version, false);
+        return pImpl->game_state.state_version != 0;
     }
 
-    try {
-        // Parse full state response
-        json state = json::parse(res->body);
+    auto res = pImpl->getStateResource("/state", pImpl->stateRequestHeaders(pImpl->game_state.state_version));
+    return pImpl->handleGameStateResponse(res, true);
+}
 
-        // Update cache
-        pImpl->cached_state = state;
+// Long-poll into the typed view without a JSON DOM
+bool SpireCommClient::waitForGameState(uint64_t since_version, int timeout_ms) {
+    if (pImpl->local) {
+        return pImpl->waitForLocalState(since_version, timeout_ms, false);
+    }
 
-        pImpl->log("State retrieved successfully");
+    std::string path = "/state?since=" + std::to_string(since_version) +
+                       "&wait=" + std::to_string(timeout_ms);
+    auto res = pImpl->longPoll(path, pImpl->acceptHeaders(), timeout_ms);
+    return pImpl->handleGameStateResponse(res, false);
+}
 
-        return state;
+// Push-based updates over a persistent Server-Sent Events connection
+bool SpireCommClient::subscribe(const std::function<bool(const GameState&)>& callback, uint64_t since_version) {
+    if (pImpl->local) {
+        // Same coalescing as /stream: each round delivers the newest state only
+        uint64_t version = since_version;
+        while (true) {
+            if (pImpl->waitForLocalState(version, kLocalSubscribeWaitMs, false)) {
+                version = pImpl->game_state.state_version;
+                if (!callback(pImpl->game_state)) {
+                    return true;
+                }
+            } else if (!pImpl->connected) {
+                return false;  // End of a replay
+            }
+        }
+    }
 
-    } catch (const json::exception& e) {
-        pImpl->setError("Failed to parse state JSON: " + std::string(e.what()));
-        return std::nullopt;
+    if (!pImpl->stream_client) {
+        // The server sends a keep-alive every few seconds; anything much longer means the stream is dead
+        pImpl->stream_client = pImpl->makeConnection(pImpl->config.timeout_ms + 10000);
+    }
+
+    std::string path = "/stream?since=" + std::to_string(since_version);
+    std::string buffer;
+    bool unsubscribed = false;
+
+    pImpl->log("Subscribing to ", path);
+    ++pImpl->stats.stream.requests;
+    auto res = pImpl->stream_client->Get(path, httplib::Headers(), [&](const char* data, size_t length) {
+        pImpl->connected = true;
+        pImpl->stats.stream.bytes_received += length;
+        buffer.append(data, length);
+
+        // Dispatch every complete event (terminated by a blank line)
+        size_t start = 0;
+        size_t end;
+        while ((end = buffer.find("\n\n", start)) != std::string::npos) {
+            if (!pImpl->handleStreamEvent(std::string_view(buffer).substr(start, end - start), callback)) {
+                unsubscribed = true;
+                return false;
+            }
+            start = end + 2;
+        }
+        buffer.erase(0, start);
+        return true;
+    });
+
+    if (unsubscribed) {
+        pImpl->log("Unsubscribed from stream");
+        return true;
+    }
+
+    ++pImpl->stats.stream.failures;
+    if (!res) {
+        pImpl->connected = false;
+        pImpl->setError("State stream failed (no response)");
+    } else if (res->status != 200) {
+        pImpl->setError("Subscribe failed (status " + std::to_string(res->status) + ")");
+    } else {
+        pImpl->setError("State stream closed by server");
     }
+    return false;
+}
+
+// Version of the latest state received (typed view is refreshed by every path)
+uint64_t SpireCommClient::stateVersion() const {
+    return pImpl->currentState()->state_version;
+}
+
+// Typed view of the cached state
+const GameState& SpireCommClient::getGameState() const {
+    return pImpl->game_state;
+}
+
+// Scratch for the current state
+Arena& SpireCommClient::stateArena() {
+    return pImpl->state_arena;
+}
+
+// Published snapshot, or a private copy when snapshots are not published
+std::shared_ptr<const GameState> SpireCommClient::snapshot() const {
+    if (pImpl->config.publish_snapshots) {
+        return pImpl->published.load();
+    }
+    return std::make_shared<const GameState>(pImpl->game_state);
 }
 
 // Helper: is in game
 bool SpireCommClient::isInGame() const {
-    if (pImpl->cached_state.empty()) {
-        return false;
-    }
-    try {
-        return pImpl->cached_state.value("in_game", false);
-    } catch (...) {
-        return false;
-    }
+    return pImpl->currentState()->in_game;
 }
 
 // Helper: is ready for command
 bool SpireCommClient::isReadyForCommand() const {
-    if (pImpl->cached_state.empty()) {
-        return false;
-    }
-    try {
-        return pImpl->cached_state.value("ready_for_command", false);
-    } catch (...) {
-        return false;
-    }
+    return pImpl->currentState()->ready_for_command;
 }
 
 // Helper: get available commands
 std::vector<std::string> SpireCommClient::getAvailableCommands() const {
+    auto state = pImpl->currentState();
+    const GameState& gs = *state;
     std::vector<std::string> commands;
-    if (pImpl->cached_state.empty()) {
-        return commands;
+    commands.reserve(gs.available_commands.size());
+    for (const auto& ref : gs.available_commands) {
+        commands.emplace_back(gs.str(ref));
     }
-    try {
-        if (pImpl->cached_state.contains("available_commands")) {
-            for (const auto& cmd : pImpl->cached_state["available_commands"]) {
-                commands.push_back(cmd.get<std::string>());
-            }
+    return commands;
+}
+
+// Enumerated lazily, once per parsed state
+const std::vector<LegalAction>& SpireCommClient::legalActions() {
+    const GameState& gs = pImpl->game_state;
+    if (pImpl->legal_actions_version != gs.state_version) {
+        enumerateLegalActions(gs, pImpl->legal_actions);
+        pImpl->legal_actions_version = gs.state_version;
+    }
+    return pImpl->legal_actions;
+}
+
+bool SpireCommClient::sendAction(const Action& action) {
+    return pImpl->sendAction(action);
+}
+
+bool SpireCommClient::sendActions(const std::vector<Action>& actions, bool abort_on_divergence) {
+    if (actions.empty()) {
+        pImpl->setError("No actions to send");
+        return false;
+    }
+
+    return pImpl->postAction(Impl::batchBody(actions, abort_on_divergence));
+}
+
+bool SpireCommClient::executeAndWait(const Action& action, int timeout_ms) {
+    uint64_t sent_at_version = pImpl->game_state.state_version;
+    uint64_t action_id = 0;
+    return pImpl->postAction(action.body(), &action_id) &&
+           waitForActionResult(action_id, sent_at_version, timeout_ms);
+}
+
+bool SpireCommClient::executeAllAndWait(const std::vector<Action>& actions, bool abort_on_divergence, int timeout_ms) {
+    if (actions.empty()) {
+        pImpl->setError("No actions to send");
+        return false;
+    }
+
+    uint64_t sent_at_version = pImpl->game_state.state_version;
+    uint64_t action_id = 0;
+    return pImpl->postAction(Impl::batchBody(actions, abort_on_divergence), &action_id) &&
+           waitForActionResult(action_id, sent_at_version, timeout_ms);
+}
+
+bool SpireCommClient::waitForActionResult(uint64_t action_id, uint64_t sent_at_version, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        const GameState& state = pImpl->game_state;
+        if (state.state_version > sent_at_version && state.last_action_id >= action_id && state.ready_for_command) {
+            pImpl->log("Action ", action_id, " answered (version ", state.state_version, ")");
+            return true;
+        }
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            pImpl->setError("Timed out waiting for the result of action " + std::to_string(action_id));
+            return false;
+        }
+
+        // A timed-out long poll leaves the error empty; anything else is a failure
+        pImpl->last_error.clear();
+        if (!waitForGameState(state.state_version, static_cast<int>(remaining)) && !pImpl->last_error.empty()) {
+            return false;
         }
-    } catch (...) {
     }
-    return commands;
 }
 
 // Action: Play card (no target)
 bool SpireCommClient::playCard(int card_index) {
-    json action = {
-        {"type", "play_card"},
-        {"card_index", card_index}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::playCard(card_index));
 }
 
 // Action: Play card (with target)
 bool SpireCommClient::playCard(int card_index, int target_index) {
-    json action = {
-        {"type", "play_card"},
-        {"card_index", card_index},
-        {"target_index", target_index}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::playCard(card_index, target_index));
 }
 
 // Action: End turn
 bool SpireCommClient::endTurn() {
-    json action = {
-        {"type", "end_turn"}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::endTurn());
 }
 
 // Action: Use potion (no target)
 bool SpireCommClient::usePotion(int potion_index) {
-    json action = {
-        {"type", "use_potion"},
-        {"potion_index", potion_index}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::usePotion(potion_index));
 }
 
 // Action: Use potion (with target)
 bool SpireCommClient::usePotion(int potion_index, int target_index) {
-    json action = {
-        {"type", "use_potion"},
-        {"potion_index", potion_index},
-        {"target_index", target_index}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::usePotion(potion_index, target_index));
 }
 
 // Action: Discard potion
 bool SpireCommClient::discardPotion(int potion_index) {
-    json action = {
-        {"type", "discard_potion"},
-        {"potion_index", potion_index}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::discardPotion(potion_index));
 }
 
 // Action: Proceed
 bool SpireCommClient::proceed() {
-    json action = {
-        {"type", "proceed"}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::proceed());
 }
 
 bool SpireCommClient::cancel() {
-    json action = {
-        {"type", "cancel"}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::cancel());
 }
 
 bool SpireCommClient::choose(int choice_index) {
-    json action = {
-        {"type", "choose"},
-        {"choice_index", choice_index}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::choose(choice_index));
 }
 
 bool SpireCommClient::chooseByName(const std::string& name) {
-    // Note: Generic choose with name is NOT supported by CommunicationMod.
-    // This method exists for compatibility but callers should use specific
-    // action methods (buyCard, rest, etc.) instead.
-    json action = {
-        {"type", "choose"},
-        {"name", name}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::chooseByName(name));
 }
 
 bool SpireCommClient::rest(const std::string& option) {
-    json action = {
-        {"type", "rest"},
-        {"option", option}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::rest(option));
 }
 
 bool SpireCommClient::cardReward(const std::string& card_name, bool bowl) {
-    json action = {
-        {"type", "card_reward"}
-    };
-    if (bowl) {
-        action["bowl"] = true;
-    } else if (!card_name.empty()) {
-        action["card_name"] = card_name;
-    }
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::cardReward(card_name, bowl));
 }
 
 bool SpireCommClient::combatReward(int reward_index) {
-    // Combat rewards use choose with index
-    return choose(reward_index);
+    return pImpl->sendAction(Action::combatReward(reward_index));
 }
 
 bool SpireCommClient::bossReward(const std::string& relic_name) {
-    json action = {
-        {"type", "boss_reward"},
-        {"relic_name", relic_name}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::bossReward(relic_name));
 }
 
 bool SpireCommClient::buyCard(const std::string& card_name) {
-    json action = {
-        {"type", "buy_card"},
-        {"card_name", card_name}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::buyCard(card_name));
 }
 
 bool SpireCommClient::buyRelic(const std::string& relic_name) {
-    json action = {
-        {"type", "buy_relic"},
-        {"relic_name", relic_name}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::buyRelic(relic_name));
 }
 
 bool SpireCommClient::buyPotion(const std::string& potion_name) {
-    json action = {
-        {"type", "buy_potion"},
-        {"potion_name", potion_name}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::buyPotion(potion_name));
 }
 
 bool SpireCommClient::buyPurge(const std::string& card_name) {
-    json action = {
-        {"type", "buy_purge"}
-    };
-    if (!card_name.empty()) {
-        action["card_name"] = card_name;
-    }
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::buyPurge(card_name));
 }
 
 bool SpireCommClient::cardSelect(const std::vector<std::string>& card_names) {
-    json action = {
-        {"type", "card_select"},
-        {"card_names", card_names}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::cardSelect(card_names));
+}
+
+bool SpireCommClient::cardReward(CardId card) {
+    return pImpl->sendAction(Action::cardReward(pImpl->game_state, card));
+}
+
+bool SpireCommClient::bossReward(RelicId relic) {
+    return pImpl->sendAction(Action::bossReward(pImpl->game_state, relic));
+}
+
+bool SpireCommClient::buyCard(CardId card) {
+    return pImpl->sendAction(Action::buyCard(pImpl->game_state, card));
+}
+
+bool SpireCommClient::buyRelic(RelicId relic) {
+    return pImpl->sendAction(Action::buyRelic(pImpl->game_state, relic));
+}
+
+bool SpireCommClient::buyPotion(PotionId potion) {
+    return pImpl->sendAction(Action::buyPotion(pImpl->game_state, potion));
+}
+
+bool SpireCommClient::buyPurge(CardId card) {
+    return pImpl->sendAction(Action::buyPurge(pImpl->game_state, card));
+}
+
+bool SpireCommClient::cardSelect(const std::vector<CardId>& cards) {
+    return pImpl->sendAction(Action::cardSelect(pImpl->game_state, cards));
 }
 
 bool SpireCommClient::chooseMapNode(int x, int y) {
-    json action = {
-        {"type", "choose_map_node"},
-        {"x", x},
-        {"y", y}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::chooseMapNode(x, y));
 }
 
 bool SpireCommClient::chooseMapBoss() {
-    json action = {
-        {"type", "choose_map_boss"}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::chooseMapBoss());
 }
 
 bool SpireCommClient::openChest() {
-    json action = {
-        {"type", "open_chest"}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::openChest());
 }
 
 bool SpireCommClient::eventOption(int choice_index) {
-    json action = {
-        {"type", "event_option"},
-        {"choice_index", choice_index}
-    };
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::eventOption(choice_index));
 }
 
 bool SpireCommClient::startGame(const std::string& character, int ascension, const std::string& seed) {
-    json action = {
-        {"type", "start_game"},
-        {"character", character},
-        {"ascension", ascension}
-    };
-    if (!seed.empty()) {
-        action["seed"] = seed;
-    }
-    return pImpl->sendAction(action);
+    return pImpl->sendAction(Action::startGame(character, ascension, seed));
 }
 
 } // namespace spirecomm
@@ -0,0 +1,804 @@
+#include "spirecomm/combat_sim.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace spirecomm {
+
+namespace {
+
+struct CardEntry {
+    std::string_view game_id;
+    SimCardId id;
+    uint8_t flags;
+};
+
+constexpr CardEntry kCards[] = {
+    {"Strike_R", SimCardId::STRIKE, 0},
+    {"Strike_G", SimCardId::STRIKE, 0},
+    {"Strike_B", SimCardId::STRIKE, 0},
+    {"Strike_P", SimCardId::STRIKE, 0},
+    {"Defend_R", SimCardId::DEFEND, 0},
+    {"Defend_G", SimCardId::DEFEND, 0},
+    {"Defend_B", SimCardId::DEFEND, 0},
+    {"Defend_P", SimCardId::DEFEND, 0},
+    {"Bash", SimCardId::BASH, 0},
+    {"Neutralize", SimCardId::NEUTRALIZE, 0},
+    {"Anger", SimCardId::ANGER, 0},
+    {"Body Slam", SimCardId::BODY_SLAM, 0},
+    {"Clash", SimCardId::CLASH, 0},
+    {"Cleave", SimCardId::CLEAVE, 0},
+    {"Clothesline", SimCardId::CLOTHESLINE, 0},
+    {"Flex", SimCardId::FLEX, 0},
+    {"Heavy Blade", SimCardId::HEAVY_BLADE, 0},
+    {"Iron Wave", SimCardId::IRON_WAVE, 0},
+    {"Perfected Strike", SimCardId::PERFECTED_STRIKE, 0},
+    {"Pommel Strike", SimCardId::POMMEL_STRIKE, 0},
+    {"Shrug It Off", SimCardId::SHRUG_IT_OFF, 0},
+    {"Sword Boomerang", SimCardId::SWORD_BOOMERANG, 0},
+    {"Thunderclap", SimCardId::THUNDERCLAP, 0},
+    {"Twin Strike", SimCardId::TWIN_STRIKE, 0},
+    {"Wild Strike", SimCardId::WILD_STRIKE, 0},
+    {"Battle Trance", SimCardId::BATTLE_TRANCE, 0},
+    {"Bloodletting", SimCardId::BLOODLETTING, 0},
+    {"Carnage", SimCardId::CARNAGE, SimCard::ETHEREAL},
+    {"Ghostly Armor", SimCardId::GHOSTLY_ARMOR, SimCard::ETHEREAL},
+    {"Hemokinesis", SimCardId::HEMOKINESIS, 0},
+    {"Inflame", SimCardId::INFLAME, 0},
+    {"Metallicize", SimCardId::METALLICIZE, 0},
+    {"Power Through", SimCardId::POWER_THROUGH, 0},
+    {"Seeing Red", SimCardId::SEEING_RED, SimCard::EXHAUSTS},
+    {"Shockwave", SimCardId::SHOCKWAVE, SimCard::EXHAUSTS},
+    {"Uppercut", SimCardId::UPPERCUT, 0},
+    {"Whirlwind", SimCardId::WHIRLWIND, 0},
+    {"Bludgeon", SimCardId::BLUDGEON, 0},
+    {"Demon Form", SimCardId::DEMON_FORM, 0},
+    {"Impervious", SimCardId::IMPERVIOUS, SimCard::EXHAUSTS},
+    {"Offering", SimCardId::OFFERING, SimCard::EXHAUSTS},
+    {"Backflip", SimCardId::BACKFLIP, 0},
+    {"Dagger Spray", SimCardId::DAGGER_SPRAY, 0},
+    {"Deadly Poison", SimCardId::DEADLY_POISON, 0},
+    {"Deflect", SimCardId::DEFLECT, 0},
+    {"Poisoned Stab", SimCardId::POISONED_STAB, 0},
+    {"Quick Slash", SimCardId::QUICK_SLASH, 0},
+    {"Slice", SimCardId::SLICE, 0},
+    {"Bandage Up", SimCardId::BANDAGE_UP, SimCard::EXHAUSTS},
+    {"Dramatic Entrance", SimCardId::DRAMATIC_ENTRANCE, SimCard::EXHAUSTS},
+    {"Finesse", SimCardId::FINESSE, 0},
+    {"Flash of Steel", SimCardId::FLASH_OF_STEEL, 0},
+    {"Good Instincts", SimCardId::GOOD_INSTINCTS, 0},
+    {"Swift Strike", SimCardId::SWIFT_STRIKE, 0},
+    {"Wound", SimCardId::WOUND, SimCard::UNPLAYABLE},
+    {"Dazed", SimCardId::DAZED, SimCard::UNPLAYABLE | SimCard::ETHEREAL},
+    {"Slimed", SimCardId::SLIMED, SimCard::EXHAUSTS},
+    {"Burn", SimCardId::BURN, SimCard::UNPLAYABLE},
+    {"Decay", SimCardId::DECAY, SimCard::UNPLAYABLE},
+    {"Doubt", SimCardId::DOUBT, SimCard::UNPLAYABLE},
+    {"Regret", SimCardId::REGRET, SimCard::UNPLAYABLE},
+    {"Shame", SimCardId::SHAME, SimCard::UNPLAYABLE},
+    {"Clumsy", SimCardId::INERT, SimCard::UNPLAYABLE | SimCard::ETHEREAL},
+    {"AscendersBane", SimCardId::INERT, SimCard::UNPLAYABLE | SimCard::ETHEREAL},
+};
+
+// Statuses and curses that change how other cards play; a combat holding one is not modelled
+constexpr std::string_view kDisruptiveCards[] = {
+    "Pain", "Normality", "Void", "Pride", "Necronomicurse",
+};
+
+constexpr const CardEntry* findCard(std::string_view game_id) {
+    for (const CardEntry& entry : kCards) {
+        if (entry.game_id == game_id) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+// Maps a power id to the SimPlayer / SimMonster field holding its amount (nullptr for inert powers)
+template <typename T>
+struct PowerEntry {
+    std::string_view id;
+    int16_t T::*field;
+    uint8_t fresh;
+};
+
+constexpr PowerEntry<SimPlayer> kPlayerPowers[] = {
+    {"Strength", &SimPlayer::strength, 0},
+    {"Dexterity", &SimPlayer::dexterity, 0},
+    {"Vulnerable", &SimPlayer::vulnerable, SimFresh::VULNERABLE},
+    {"Weakened", &SimPlayer::weak, SimFresh::WEAK},
+    {"Frail", &SimPlayer::frail, SimFresh::FRAIL},
+    {"Metallicize", &SimPlayer::metallicize, 0},
+    {"Plated Armor", &SimPlayer::plated_armor, 0},
+    {"Flex", &SimPlayer::flex, 0},
+    {"Demon Form", &SimPlayer::demon_form, 0},
+    {"No Draw", nullptr, 0},
+};
+
+constexpr PowerEntry<SimMonster> kMonsterPowers[] = {
+    {"Strength", &SimMonster::strength, 0},
+    {"Vulnerable", &SimMonster::vulnerable, SimFresh::VULNERABLE},
+    {"Weakened", &SimMonster::weak, SimFresh::WEAK},
+    {"Poison", &SimMonster::poison, 0},
+    {"Artifact", &SimMonster::artifact, 0},
+    {"Ritual", &SimMonster::ritual, SimFresh::RITUAL},
+    {"Metallicize", &SimMonster::metallicize, 0},
+    {"Plated Armor", &SimMonster::plated_armor, 0},
+    {"Thorns", &SimMonster::thorns, 0},
+    {"Angry", &SimMonster::angry, 0},
+    {"Curl Up", &SimMonster::curl_up, 0},
+    {"Minion", nullptr, 0},
+    {"Thievery", nullptr, 0},
+};
+
+template <typename T, size_t N>
+bool loadPowers(const CombatState& combat, PowerRange range,
+                const PowerEntry<T> (&table)[N], T& owner, std::string* reason) {
+    for (const Power* power = combat.powersBegin(range); power != combat.powersEnd(range); ++power) {
+        std::string_view id = toString(power->id);
+        const PowerEntry<T>* entry = nullptr;
+        for (const PowerEntry<T>& candidate : table) {
+            if (candidate.id == id) {
+                entry = &candidate;
+                break;
+            }
+        }
+        if (!entry) {
+            if (reason) {
+                *reason = "power not modelled: " + std::string(id);
+            }
+            return false;
+        }
+        if (entry->field) {
+            owner.*(entry->field) = static_cast<int16_t>(power->amount);
+            if (power->just_applied) {
+                owner.fresh |= entry->fresh;
+            }
+        }
+    }
+    return true;
+}
+
+bool isAttackIntent(Intent intent) {
+    return intent == Intent::ATTACK || intent == Intent::ATTACK_BUFF
+        || intent == Intent::ATTACK_DEBUFF || intent == Intent::ATTACK_DEFEND;
+}
+
+void tickDebuff(int16_t& amount, uint8_t& fresh, uint8_t bit) {
+    if (fresh & bit) {
+        fresh &= static_cast<uint8_t>(~bit);
+    } else if (amount > 0) {
+        --amount;
+    }
+}
+
+// Dead monsters keep only max_hp, so stale powers cannot act
+void killMonster(SimMonster& monster) {
+    int32_t max_hp = monster.max_hp;
+    monster = SimMonster();
+    monster.max_hp = max_hp;
+    monster.is_gone = true;
+}
+
+SimCard woundCard() {
+    SimCard card;
+    card.id = SimCardId::WOUND;
+    card.cost = -2;
+    card.type = CardType::STATUS;
+    card.flags = SimCard::UNPLAYABLE;
+    return card;
+}
+
+} // anonymous namespace
+
+SimCardId CombatSim::cardId(std::string_view game_id) {
+    const CardEntry* entry = findCard(game_id);
+    return entry ? entry->id : SimCardId::UNKNOWN;
+}
+
+SimStatus CombatSim::load(const GameState& state, uint64_t seed, std::string* reason) {
+    auto unsupported = [&](const char* why) {
+        if (reason) {
+            *reason = why;
+        }
+        return SimStatus::UNSUPPORTED;
+    };
+
+    if (!state.in_combat) {
+        if (reason) {
+            *reason = "not in combat";
+        }
+        return SimStatus::ILLEGAL;
+    }
+    const CombatState& combat = state.combat;
+    if (state.character == PlayerClass::WATCHER) {
+        return unsupported("stances are not modelled");
+    }
+    for (const Orb& orb : combat.orbs) {
+        if (state.str(orb.id) != "Empty") {
+            return unsupported("orbs are not modelled");
+        }
+    }
+    if (combat.has_card_in_play || !combat.limbo.empty()) {
+        return unsupported("a card is mid-play");
+    }
+    if (combat.monsters.size() > kMaxMonsters || combat.hand.size() > kMaxHand
+        || combat.draw_pile.size() + combat.discard_pile.size() + combat.hand.size() > kMaxPile) {
+        return unsupported("too many monsters or cards");
+    }
+
+    player = SimPlayer();
+    player.hp = combat.player.current_hp;
+    player.max_hp = combat.player.max_hp;
+    player.block = combat.player.block;
+    player.energy = combat.player.energy;
+    if (!loadPowers(combat, combat.player.powers, kPlayerPowers, player, reason)) {
+        return SimStatus::UNSUPPORTED;
+    }
+    for (const Power* power = combat.powersBegin(combat.player.powers);
+         power != combat.powersEnd(combat.player.powers); ++power) {
+        if (power->id == knownPowerId("No Draw")) {
+            player.no_draw = true;
+        }
+    }
+
+    num_monsters = static_cast<uint8_t>(combat.monsters.size());
+    for (size_t i = 0; i < kMaxMonsters; ++i) {
+        monsters[i] = SimMonster();
+        monsters[i].is_gone = true;
+    }
+    for (size_t i = 0; i < combat.monsters.size(); ++i) {
+        const Monster& source = combat.monsters[i];
+        SimMonster& monster = monsters[i];
+        monster.hp = source.current_hp;
+        monster.max_hp = source.max_hp;
+        monster.block = source.block;
+        monster.intent = source.intent;
+        monster.half_dead = source.half_dead;
+        monster.is_gone = source.is_gone || source.current_hp <= 0;
+        if (isAttackIntent(source.intent) && source.move_base_damage >= 0) {
+            monster.move_damage = source.move_base_damage;
+            monster.move_hits = std::max(source.move_hits, 1);
+        }
+        if (!monster.is_gone && !loadPowers(combat, source.powers, kMonsterPowers, monster, reason)) {
+            return SimStatus::UNSUPPORTED;
+        }
+    }
+
+    auto loadPile = [&](const std::vector<Card>& cards, auto& pile) {
+        pile.count = 0;
+        for (const Card& source : cards) {
+            std::string_view game_id = toString(source.id);
+            for (std::string_view disruptive : kDisruptiveCards) {
+                if (game_id == disruptive) {
+                    if (reason) {
+                        *reason = "card not modelled: " + std::string(game_id);
+                    }
+                    return false;
+                }
+            }
+            SimCard card;
+            const CardEntry* entry = findCard(game_id);
+            if (entry) {
+                card.id = entry->id;
+                card.flags = entry->flags;
+            } else if (source.type == CardType::STATUS || source.type == CardType::CURSE) {
+                card.id = SimCardId::INERT;
+                card.flags = SimCard::UNPLAYABLE;
+            }
+            card.cost = static_cast<int8_t>(std::clamp(source.cost, -2, 99));
+            card.type = source.type;
+            if (source.upgrades > 0) {
+                card.flags |= SimCard::UPGRADED;
+            }
+            if (source.has_target) {
+                card.flags |= SimCard::TARGETED;
+            }
+            if (source.exhausts) {
+                card.flags |= SimCard::EXHAUSTS;
+            }
+            if (source.cost == -2) {
+                card.flags |= SimCard::UNPLAYABLE;
+            }
+            if (game_id.find("Strike") != std::string_view::npos) {
+                card.flags |= SimCard::STRIKE;
+            }
+            pile.push(card);
+        }
+        return true;
+    };
+    if (!loadPile(combat.hand, hand) || !loadPile(combat.draw_pile, draw_pile)
+        || !loadPile(combat.discard_pile, discard_pile)) {
+        return SimStatus::UNSUPPORTED;
+    }
+
+    exhausted = 0;
+    turn = combat.turn;
+    // splitmix64 step so that nearby seeds give unrelated streams and the state is never 0
+    rng = seed + 0x9E3779B97F4A7C15ull;
+    rng = (rng ^ (rng >> 30)) * 0xBF58476D1CE4E5B9ull;
+    rng = (rng ^ (rng >> 27)) * 0x94D049BB133111EBull;
+    rng = (rng ^ (rng >> 31)) | 1;
+    return SimStatus::OK;
+}
+
+bool CombatSim::won() const {
+    for (size_t i = 0; i < num_monsters; ++i) {
+        if (!monsters[i].is_gone) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CombatSim::payable(const SimCard& card) const {
+    if (card.is(SimCard::UNPLAYABLE)) {
+        return false;
+    }
+    return card.cost < 0 || card.cost <= player.energy;
+}
+
+bool CombatSim::canPlay(int hand_index, int target_index) const {
+    if (isOver() || hand_index < 0 || static_cast<size_t>(hand_index) >= hand.size()) {
+        return false;
+    }
+    const SimCard& card = hand[static_cast<size_t>(hand_index)];
+    if (!payable(card)) {
+        return false;
+    }
+    if (card.is(SimCard::TARGETED)) {
+        if (target_index < 0 || target_index >= num_monsters
+            || !monsters[static_cast<size_t>(target_index)].isTargetable()) {
+            return false;
+        }
+    }
+    if (card.id == SimCardId::CLASH) {
+        for (size_t i = 0; i < hand.size(); ++i) {
+            if (hand[i].type != CardType::ATTACK) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+uint32_t CombatSim::random(uint32_t bound) {
+    // xorshift64*
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    uint64_t value = (rng * 0x2545F4914F6CDD1Dull) >> 32;
+    return static_cast<uint32_t>((value * bound) >> 32);
+}
+
+void CombatSim::drawCards(int n) {
+    for (int i = 0; i < n && !player.no_draw && !hand.full(); ++i) {
+        if (draw_pile.empty()) {
+            if (discard_pile.empty()) {
+                return;
+            }
+            draw_pile = discard_pile;
+            discard_pile.count = 0;
+        }
+        size_t index = random(draw_pile.count);
+        hand.push(draw_pile[index]);
+        draw_pile[index] = draw_pile[draw_pile.count - 1u];
+        --draw_pile.count;
+    }
+}
+
+int32_t CombatSim::attackDamage(int32_t base, const SimMonster& target, int strength_multiplier) const {
+    // The game applies the multipliers in floating point and floors once
+    float damage = static_cast<float>(base + player.strength * strength_multiplier);
+    if (player.weak > 0) {
+        damage *= 0.75f;
+    }
+    if (target.vulnerable > 0) {
+        damage *= 1.5f;
+    }
+    return std::max(0, static_cast<int32_t>(std::floor(damage)));
+}
+
+int32_t CombatSim::cardBlock(int32_t base) const {
+    float block = static_cast<float>(base + player.dexterity);
+    if (player.frail > 0) {
+        block *= 0.75f;
+    }
+    return std::max(0, static_cast<int32_t>(std::floor(block)));
+}
+
+void CombatSim::hitMonster(size_t index, int32_t damage) {
+    SimMonster& monster = monsters[index];
+    if (!monster.isTargetable()) {
+        return;
+    }
+    int32_t blocked = std::min(monster.block, damage);
+    monster.block -= blocked;
+    int32_t unblocked = damage - blocked;
+    if (unblocked > 0) {
+        if (monster.curl_up > 0 && unblocked < monster.hp) {
+            monster.block += monster.curl_up;
+            monster.curl_up = 0;
+        }
+        if (monster.plated_armor > 0) {
+            --monster.plated_armor;
+        }
+        monster.strength = static_cast<int16_t>(monster.strength + monster.angry);
+        monster.hp -= unblocked;
+    }
+    if (monster.thorns > 0) {
+        hitPlayer(monster.thorns);
+    }
+    if (monster.hp <= 0) {
+        killMonster(monster);
+    }
+}
+
+void CombatSim::hitAll(int32_t base) {
+    for (size_t i = 0; i < num_monsters; ++i) {
+        if (monsters[i].isTargetable()) {
+            hitMonster(i, attackDamage(base, monsters[i]));
+        }
+    }
+}
+
+void CombatSim::hitPlayer(int32_t damage) {
+    int32_t blocked = std::min(player.block, damage);
+    player.block -= blocked;
+    if (damage > blocked) {
+        player.hp -= damage - blocked;
+        if (player.plated_armor > 0) {
+            --player.plated_armor;
+        }
+    }
+}
+
+void CombatSim::loseHp(int32_t amount) {
+    player.hp -= amount;
+}
+
+void CombatSim::debuffMonster(SimMonster& monster, int16_t SimMonster::*debuff, int16_t amount) {
+    if (!monster.isTargetable()) {
+        return;
+    }
+    if (monster.artifact > 0) {
+        --monster.artifact;
+        return;
+    }
+    monster.*debuff = static_cast<int16_t>(monster.*debuff + amount);
+}
+
+SimStatus CombatSim::playCard(int hand_index, int target_index) {
+    if (!canPlay(hand_index, target_index)) {
+        return SimStatus::ILLEGAL;
+    }
+    const SimCard card = hand[static_cast<size_t>(hand_index)];
+    if (card.id == SimCardId::UNKNOWN) {
+        return SimStatus::UNSUPPORTED;
+    }
+    int generated = card.id == SimCardId::ANGER || card.id == SimCardId::WILD_STRIKE ? 1
+                  : card.id == SimCardId::POWER_THROUGH ? 2 : 0;
+    if (hand.size() + draw_pile.size() + discard_pile.size() + static_cast<size_t>(generated) > kMaxPile) {
+        return SimStatus::UNSUPPORTED;
+    }
+
+    const bool up = card.is(SimCard::UPGRADED);
+    int32_t x = 0;
+    if (card.cost < 0) {
+        x = player.energy;
+        player.energy = 0;
+    } else {
+        player.energy -= card.cost;
+    }
+    hand.erase(static_cast<size_t>(hand_index));
+
+    size_t t = card.is(SimCard::TARGETED) ? static_cast<size_t>(target_index) : 0;
+    auto hit = [&](int32_t base) { hitMonster(t, attackDamage(base, monsters[t])); };
+    auto block = [&](int32_t base) { player.block += cardBlock(base); };
+
+    switch (card.id) {
+    case SimCardId::STRIKE:            hit(up ? 9 : 6); break;
+    case SimCardId::DEFEND:            block(up ? 8 : 5); break;
+    case SimCardId::BASH:
+        hit(up ? 10 : 8);
+        debuffMonster(monsters[t], &SimMonster::vulnerable, up ? 3 : 2);
+        break;
+    case SimCardId::NEUTRALIZE:
+        hit(up ? 4 : 3);
+        debuffMonster(monsters[t], &SimMonster::weak, up ? 2 : 1);
+        break;
+    case SimCardId::ANGER:
+        hit(up ? 8 : 6);
+        discard_pile.push(card);
+        break;
+    case SimCardId::BODY_SLAM:         hit(player.block); break;
+    case SimCardId::CLASH:             hit(up ? 18 : 14); break;
+    case SimCardId::CLEAVE:            hitAll(up ? 11 : 8); break;
+    case SimCardId::CLOTHESLINE:
+        hit(up ? 14 : 12);
+        debuffMonster(monsters[t], &SimMonster::weak, up ? 3 : 2);
+        break;
+    case SimCardId::FLEX:
+        player.strength = static_cast<int16_t>(player.strength + (up ? 4 : 2));
+        player.flex = static_cast<int16_t>(player.flex + (up ? 4 : 2));
+        break;
+    case SimCardId::HEAVY_BLADE:
+        hitMonster(t, attackDamage(14, monsters[t], up ? 5 : 3));
+        break;
+    case SimCardId::IRON_WAVE:
+        block(up ? 7 : 5);
+        hit(up ? 7 : 5);
+        break;
+    case SimCardId::PERFECTED_STRIKE: {
+        int32_t strikes = 1;  // Counts itself
+        for (const auto* pile : {&draw_pile, &discard_pile}) {
+            strikes += static_cast<int32_t>(std::count_if(pile->begin(), pile->end(),
+                [](const SimCard& c) { return c.is(SimCard::STRIKE); }));
+        }
+        strikes += static_cast<int32_t>(std::count_if(hand.begin(), hand.end(),
+            [](const SimCard& c) { return c.is(SimCard::STRIKE); }));
+        hit(6 + (up ? 3 : 2) * strikes);
+        break;
+    }
+    case SimCardId::POMMEL_STRIKE:
+        hit(up ? 10 : 9);
+        drawCards(up ? 2 : 1);
+        break;
+    case SimCardId::SHRUG_IT_OFF:
+        block(up ? 11 : 8);
+        drawCards(1);
+        break;
+    case SimCardId::SWORD_BOOMERANG:
+        for (int i = 0; i < (up ? 4 : 3) && !won(); ++i) {
+            size_t alive[kMaxMonsters];
+            size_t count = 0;
+            for (size_t m = 0; m < num_monsters; ++m) {
+                if (monsters[m].isTargetable()) {
+                    alive[count++] = m;
+                }
+            }
+            if (count == 0) {
+                break;
+            }
+            size_t target = alive[random(static_cast<uint32_t>(count))];
+            hitMonster(target, attackDamage(3, monsters[target]));
+        }
+        break;
+    case SimCardId::THUNDERCLAP:
+        hitAll(up ? 7 : 4);
+        for (size_t m = 0; m < num_monsters; ++m) {
+            debuffMonster(monsters[m], &SimMonster::vulnerable, 1);
+        }
+        break;
+    case SimCardId::TWIN_STRIKE:
+        hit(up ? 7 : 5);
+        hit(up ? 7 : 5);
+        break;
+    case SimCardId::WILD_STRIKE:
+        hit(up ? 17 : 12);
+        draw_pile.push(woundCard());
+        break;
+    case SimCardId::BATTLE_TRANCE:
+        drawCards(up ? 4 : 3);
+        player.no_draw = true;
+        break;
+    case SimCardId::BLOODLETTING:
+        loseHp(3);
+        player.energy += up ? 3 : 2;
+        break;
+    case SimCardId::CARNAGE:           hit(up ? 28 : 20); break;
+    case SimCardId::GHOSTLY_ARMOR:     block(up ? 13 : 10); break;
+    case SimCardId::HEMOKINESIS:
+        loseHp(2);
+        hit(up ? 20 : 15);
+        break;
+    case SimCardId::INFLAME:
+        player.strength = static_cast<int16_t>(player.strength + (up ? 3 : 2));
+        break;
+    case SimCardId::METALLICIZE:
+        player.metallicize = static_cast<int16_t>(player.metallicize + (up ? 4 : 3));
+        break;
+    case SimCardId::POWER_THROUGH:
+        for (int i = 0; i < 2; ++i) {
+            if (!hand.push(woundCard())) {
+                discard_pile.push(woundCard());
+            }
+        }
+        block(up ? 20 : 15);
+        break;
+    case SimCardId::SEEING_RED:        player.energy += 2; break;
+    case SimCardId::SHOCKWAVE:
+        for (size_t m = 0; m < num_monsters; ++m) {
+            debuffMonster(monsters[m], &SimMonster::weak, up ? 5 : 3);
+            debuffMonster(monsters[m], &SimMonster::vulnerable, up ? 5 : 3);
+        }
+        break;
+    case SimCardId::UPPERCUT:
+        hit(13);
+        debuffMonster(monsters[t], &SimMonster::weak, up ? 2 : 1);
+        debuffMonster(monsters[t], &SimMonster::vulnerable, up ? 2 : 1);
+        break;
+    case SimCardId::WHIRLWIND:
+        for (int32_t i = 0; i < x; ++i) {
+            hitAll(up ? 8 : 5);
+        }
+        break;
+    case SimCardId::BLUDGEON:          hit(up ? 42 : 32); break;
+    case SimCardId::DEMON_FORM:
+        player.demon_form = static_cast<int16_t>(player.demon_form + (up ? 3 : 2));
+        break;
+    case SimCardId::IMPERVIOUS:        block(up ? 40 : 30); break;
+    case SimCardId::OFFERING:
+        loseHp(6);
+        player.energy += 2;
+        drawCards(up ? 5 : 3);
+        break;
+    case SimCardId::BACKFLIP:
+        block(up ? 8 : 5);
+        drawCards(2);
+        break;
+    case SimCardId::DAGGER_SPRAY:
+        hitAll(up ? 6 : 4);
+        hitAll(up ? 6 : 4);
+        break;
+    case SimCardId::DEADLY_POISON:
+        debuffMonster(monsters[t], &SimMonster::poison, up ? 7 : 5);
+        break;
+    case SimCardId::DEFLECT:           block(up ? 7 : 4); break;
+    case SimCardId::POISONED_STAB:
+        hit(up ? 8 : 6);
+        debuffMonster(monsters[t], &SimMonster::poison, up ? 4 : 3);
+        break;
+    case SimCardId::QUICK_SLASH:
+        hit(up ? 12 : 8);
+        drawCards(1);
+        break;
+    case SimCardId::SLICE:             hit(up ? 9 : 6); break;
+    case SimCardId::BANDAGE_UP:
+        player.hp = std::min(player.max_hp, player.hp + (up ? 6 : 4));
+        break;
+    case SimCardId::DRAMATIC_ENTRANCE: hitAll(up ? 12 : 8); break;
+    case SimCardId::FINESSE:
+        block(up ? 4 : 2);
+        drawCards(1);
+        break;
+    case SimCardId::FLASH_OF_STEEL:
+        hit(up ? 6 : 3);
+        drawCards(1);
+        break;
+    case SimCardId::GOOD_INSTINCTS:    block(up ? 9 : 6); break;
+    case SimCardId::SWIFT_STRIKE:      hit(up ? 10 : 7); break;
+    default:
+        // Slimed (no effect); the rest are unplayable and never get here
+        break;
+    }
+
+    if (card.type == CardType::POWER) {
+        // Powers leave play
+    } else if (card.is(SimCard::EXHAUSTS)) {
+        ++exhausted;
+    } else {
+        discard_pile.push(card);
+    }
+    return SimStatus::OK;
+}
+
+void CombatSim::endPlayerTurn() {
+    for (const SimCard& card : hand) {
+        switch (card.id) {
+        case SimCardId::BURN:   hitPlayer(card.is(SimCard::UPGRADED) ? 4 : 2); break;
+        case SimCardId::DECAY:  hitPlayer(2); break;
+        case SimCardId::REGRET: loseHp(static_cast<int32_t>(hand.size())); break;
+        case SimCardId::DOUBT:
+            player.weak = static_cast<int16_t>(player.weak + 1);
+            player.fresh |= SimFresh::WEAK;
+            break;
+        case SimCardId::SHAME:
+            player.frail = static_cast<int16_t>(player.frail + 1);
+            player.fresh |= SimFresh::FRAIL;
+            break;
+        default:
+            break;
+        }
+    }
+    player.block += player.metallicize + player.plated_armor;
+    player.strength = static_cast<int16_t>(player.strength - player.flex);
+    player.flex = 0;
+    player.no_draw = false;
+
+    for (const SimCard& card : hand) {
+        if (card.is(SimCard::ETHEREAL)) {
+            ++exhausted;
+        } else {
+            discard_pile.push(card);
+        }
+    }
+    hand.count = 0;
+}
+
+void CombatSim::monsterTurn() {
+    // Every monster loses block and takes poison before any of them acts
+    for (size_t i = 0; i < num_monsters; ++i) {
+        SimMonster& monster = monsters[i];
+        if (!monster.isTargetable()) {
+            continue;
+        }
+        monster.block = 0;
+        if (monster.poison > 0) {
+            monster.hp -= monster.poison;
+            --monster.poison;
+            if (monster.hp <= 0) {
+                killMonster(monster);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < num_monsters && !lost(); ++i) {
+        SimMonster& monster = monsters[i];
+        if (!monster.isTargetable()) {
+            continue;
+        }
+        if (monster.intent == Intent::ESCAPE) {
+            monster.is_gone = true;
+            continue;
+        }
+        if (monster.move_damage >= 0) {
+            float damage = static_cast<float>(monster.move_damage + monster.strength);
+            if (monster.weak > 0) {
+                damage *= 0.75f;
+            }
+            if (player.vulnerable > 0) {
+                damage *= 1.5f;
+            }
+            int32_t per_hit = std::max(0, static_cast<int32_t>(std::floor(damage)));
+            for (int32_t hit = 0; hit < monster.move_hits && !lost(); ++hit) {
+                hitPlayer(per_hit);
+            }
+        }
+        monster.block += monster.metallicize + monster.plated_armor;
+    }
+}
+
+void CombatSim::endRound() {
+    tickDebuff(player.vulnerable, player.fresh, SimFresh::VULNERABLE);
+    tickDebuff(player.weak, player.fresh, SimFresh::WEAK);
+    tickDebuff(player.frail, player.fresh, SimFresh::FRAIL);
+    for (size_t i = 0; i < num_monsters; ++i) {
+        SimMonster& monster = monsters[i];
+        if (monster.is_gone) {
+            continue;
+        }
+        tickDebuff(monster.vulnerable, monster.fresh, SimFresh::VULNERABLE);
+        tickDebuff(monster.weak, monster.fresh, SimFresh::WEAK);
+        if (monster.fresh & SimFresh::RITUAL) {
+            monster.fresh &= static_cast<uint8_t>(~SimFresh::RITUAL);
+        } else {
+            monster.strength = static_cast<int16_t>(monster.strength + monster.ritual);
+        }
+    }
+}
+
+void CombatSim::startPlayerTurn() {
+    ++turn;
+    player.block = 0;
+    player.energy = energy_per_turn;
+    player.strength = static_cast<int16_t>(player.strength + player.demon_form);
+    drawCards(cards_per_turn);
+}
+
+SimStatus CombatSim::endTurn() {
+    if (isOver()) {
+        return SimStatus::ILLEGAL;
+    }
+    endPlayerTurn();
+    if (!lost()) {
+        monsterTurn();
+    }
+    if (isOver()) {
+        return SimStatus::OK;
+    }
+    endRound();
+    startPlayerTurn();
+    return SimStatus::OK;
+}
+
+} // namespace spirecomm
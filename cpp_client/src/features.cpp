@@ -0,0 +1,152 @@
+#include "spirecomm/features.hpp"
+#include <algorithm>
+
+namespace spirecomm {
+
+namespace {
+
+uint32_t mapSymbol(char symbol) {
+    switch (symbol) {
+        case 'M': return 0;
+        case '?': return 1;
+        case '$': return 2;
+        case 'R': return 3;
+        case 'E': return 4;
+        case 'T': return 5;
+        default: return Feature::kMapSymbols - 1;
+    }
+}
+
+float flag(bool value) { return value ? 1.0f : 0.0f; }
+
+bool isAttack(Intent intent) {
+    return intent == Intent::ATTACK || intent == Intent::ATTACK_BUFF ||
+           intent == Intent::ATTACK_DEBUFF || intent == Intent::ATTACK_DEFEND;
+}
+
+// encodeFeatures() into features that are already zero
+void encodeNonZero(const GameState& state, float* out, size_t stride) {
+    auto set = [out, stride](uint32_t feature, float value) { out[feature * stride] = value; };
+    auto add = [out, stride](uint32_t feature, float value) { out[feature * stride] += value; };
+    auto countCards = [&](uint32_t base, const std::vector<Card>& cards) {
+        for (const Card& card : cards) {
+            add(base + Feature::cardIndex(card.id), 1.0f);
+        }
+    };
+
+    set(Feature::IN_GAME, flag(state.in_game));
+    set(Feature::IN_COMBAT, flag(state.in_combat));
+    set(Feature::FLOOR, static_cast<float>(state.floor));
+    set(Feature::ACT, static_cast<float>(state.act));
+    set(Feature::ASCENSION, static_cast<float>(state.ascension_level));
+    set(Feature::GOLD, static_cast<float>(state.gold));
+    set(Feature::CURRENT_HP, static_cast<float>(state.current_hp));
+    set(Feature::MAX_HP, static_cast<float>(state.max_hp));
+    set(Feature::SCREEN + static_cast<uint32_t>(state.screen_type), 1.0f);
+    set(Feature::CHARACTER + static_cast<uint32_t>(state.character), 1.0f);
+
+    for (const Relic& relic : state.relics) {
+        add(Feature::RELICS + Feature::relicIndex(relic.id), 1.0f);
+    }
+    countCards(Feature::DECK, state.deck);
+    for (const MapNode& node : state.map) {
+        add(Feature::MAP_NODES + mapSymbol(node.symbol), 1.0f);
+    }
+    if (state.screen_type == ScreenType::MAP) {
+        for (const MapNode& node : state.screen.next_nodes) {
+            add(Feature::MAP_NEXT + mapSymbol(node.symbol), 1.0f);
+        }
+    }
+
+    if (!state.in_combat) {
+        return;
+    }
+    const CombatState& combat = state.combat;
+    set(Feature::BLOCK, static_cast<float>(combat.player.block));
+    set(Feature::ENERGY, static_cast<float>(combat.player.energy));
+    set(Feature::TURN, static_cast<float>(combat.turn));
+    set(Feature::PLAYER_POWERS, static_cast<float>(combat.player.powers.count));
+    set(Feature::HAND_SIZE, static_cast<float>(combat.hand.size()));
+    set(Feature::DRAW_PILE_SIZE, static_cast<float>(combat.draw_pile.size()));
+    set(Feature::DISCARD_PILE_SIZE, static_cast<float>(combat.discard_pile.size()));
+    set(Feature::EXHAUST_PILE_SIZE, static_cast<float>(combat.exhaust_pile.size()));
+    auto addPowers = [&](uint32_t base, PowerRange range) {
+        for (const Power* power = combat.powersBegin(range); power != combat.powersEnd(range); ++power) {
+            add(base + Feature::powerIndex(power->id), static_cast<float>(power->amount));
+        }
+    };
+    addPowers(Feature::PLAYER_POWER_AMOUNTS, combat.player.powers);
+    countCards(Feature::DRAW_PILE, combat.draw_pile);
+    countCards(Feature::DISCARD_PILE, combat.discard_pile);
+    countCards(Feature::EXHAUST_PILE, combat.exhaust_pile);
+
+    size_t cards = std::min<size_t>(combat.hand.size(), Feature::kHandSlots);
+    for (uint32_t slot = 0; slot < cards; ++slot) {
+        const Card& card = combat.hand[slot];
+        set(Feature::hand(slot, Feature::CARD_PRESENT), 1.0f);
+        set(Feature::hand(slot, Feature::CARD_ID), static_cast<float>(Feature::cardIndex(card.id)));
+        set(Feature::hand(slot, Feature::CARD_COST), static_cast<float>(card.cost));
+        set(Feature::hand(slot, Feature::CARD_PLAYABLE), flag(card.is_playable));
+        set(Feature::hand(slot, Feature::CARD_HAS_TARGET), flag(card.has_target));
+        set(Feature::hand(slot, Feature::CARD_ATTACK), flag(card.type == CardType::ATTACK));
+        set(Feature::hand(slot, Feature::CARD_SKILL), flag(card.type == CardType::SKILL));
+        set(Feature::hand(slot, Feature::CARD_POWER), flag(card.type == CardType::POWER));
+        set(Feature::hand(slot, Feature::CARD_UPGRADED), flag(card.upgrades > 0));
+    }
+
+    size_t monsters = std::min<size_t>(combat.monsters.size(), Feature::kMonsterSlots);
+    for (uint32_t slot = 0; slot < monsters; ++slot) {
+        const Monster& monster = combat.monsters[slot];
+        if (monster.is_gone) {
+            continue;  // Dead or escaped monsters read as empty slots
+        }
+        bool attacking = isAttack(monster.intent);
+        set(Feature::monster(slot, Feature::MONSTER_TARGETABLE), flag(monster.isTargetable()));
+        set(Feature::monster(slot, Feature::MONSTER_HP), static_cast<float>(monster.current_hp));
+        set(Feature::monster(slot, Feature::MONSTER_MAX_HP), static_cast<float>(monster.max_hp));
+        set(Feature::monster(slot, Feature::MONSTER_BLOCK), static_cast<float>(monster.block));
+        set(Feature::monster(slot, Feature::MONSTER_ATTACKING), flag(attacking));
+        if (attacking) {
+            set(Feature::monster(slot, Feature::MONSTER_DAMAGE), static_cast<float>(std::max(monster.move_adjusted_damage, 0)));
+            set(Feature::monster(slot, Feature::MONSTER_HITS), static_cast<float>(std::max(monster.move_hits, 1)));
+        }
+        set(Feature::monster(slot, Feature::MONSTER_POWERS), static_cast<float>(monster.powers.count));
+        addPowers(Feature::monsterPower(slot, 0), monster.powers);
+    }
+}
+
+} // anonymous namespace
+
+void FeatureBatch::reset(size_t num_rows) {
+    rows = num_rows;
+    column_stride = (num_rows + kRowAlignment - 1) / kRowAlignment * kRowAlignment;
+    if (column_stride >= kColumnSkew && column_stride % kColumnSkew == 0) {
+        // A power-of-two-like stride maps every column of a row to the same cache sets
+        column_stride += kRowAlignment;
+    }
+    values.assign(column_stride * Feature::COUNT, 0.0f);
+    encoded.assign(num_rows, 0);
+}
+
+void FeatureBatch::encode(size_t row, const GameState& state) {
+    if (encoded[row]) {
+        encodeFeatures(state, values.data() + row, column_stride);
+        return;
+    }
+    // Still zero from reset(), which saves one strided pass over every column
+    encoded[row] = 1;
+    encodeNonZero(state, values.data() + row, column_stride);
+}
+
+void encodeFeatures(const GameState& state, float* out, size_t stride) {
+    if (stride == 1) {
+        std::fill_n(out, Feature::COUNT, 0.0f);
+    } else {
+        for (uint32_t f = 0; f < Feature::COUNT; ++f) {
+            out[f * stride] = 0.0f;
+        }
+    }
+    encodeNonZero(state, out, stride);
+}
+
+} // namespace spirecomm
@@ -0,0 +1,558 @@
+#include "spirecomm/fleet.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace spirecomm {
+
+namespace {
+
+// Back-off before reconnecting to an unreachable server, doubled per failure up to the maximum
+constexpr int64_t kReconnectDelayNs = 100'000'000;
+constexpr int64_t kMaxReconnectDelayNs = 2'000'000'000;
+
+// Upper bound on how long an idle worker sleeps before looking for work again
+constexpr auto kIdleWait = std::chrono::milliseconds(10);
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // anonymous namespace
+
+// PIMPL implementation
+struct SpireCommFleet::Impl {
+    // One game server and the agent playing it
+    struct Instance {
+        int port;
+        std::string address;
+        SpireCommClient client;
+        std::unique_ptr<FleetAgent> agent;
+        uint64_t version = 0;  // Last state version seen, only touched by the worker running the task
+        std::vector<Action> decided;  // Batch decision to send before the next poll
+        int64_t backoff_ns = 0;   // Reconnect back-off, 0 while the server answers
+        int64_t retry_ns = 0;     // Earliest time of the next attempt while backing off
+        std::atomic<uint64_t> steps{0};
+
+        Instance(const ClientConfig& cfg)
+            : port(cfg.unix_socket.empty() ? cfg.port : 0),
+              address(cfg.unix_socket.empty() ? cfg.host + ":" + std::to_string(cfg.port) : "unix:" + cfg.unix_socket),
+              client(cfg) {}
+    };
+
+    // What became of a game after one step
+    enum class StepResult {
+        REQUEUE,  // Run it again
+        PARK,     // Waiting in the pending batch
+        RETIRE    // Its agent is done
+    };
+
+    // Worker thread with its own queue of games (indices into instances)
+    struct Worker {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+        std::thread thread;
+    };
+
+    FleetConfig config;
+    std::vector<std::unique_ptr<Instance>> instances;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopping{false};
+    std::atomic<size_t> active{0};   // Instances whose agent has not retired
+    std::atomic<size_t> queued{0};   // Tasks waiting in any worker queue
+    std::atomic<uint64_t> states{0};
+    std::atomic<uint64_t> steps{0};
+    std::atomic<uint64_t> steals{0};
+    std::atomic<uint64_t> batches{0};
+    std::atomic<int64_t> start_ns{0};
+    std::atomic<int64_t> stop_ns{0};
+
+    // Idle workers and wait() sleep here
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+
+    // Games with a ready state waiting for the batch policy (startBatched() only)
+    BatchPolicy policy;
+    std::mutex pending_mutex;
+    std::vector<size_t> pending;
+    std::atomic<size_t> pending_count{0};
+    std::atomic<int64_t> pending_since_ns{0};  // When the oldest pending game was parked
+
+    // Held while one worker encodes and runs a batch; guards the buffers below
+    std::mutex batch_mutex;
+    FeatureBatch features;
+    std::vector<BatchEntry> entries;
+    std::vector<BatchDecision> decisions;
+
+    // wait() and stop() may race to join the workers
+    std::mutex join_mutex;
+
+    mutable std::mutex error_mutex;
+    std::string last_error;
+
+    Impl(const FleetConfig& cfg) : config(cfg) {}
+
+    // Parts are streamed only when debug is enabled
+    template <typename... Parts>
+    void log(const Parts&... parts) {
+        if (config.client.debug) {
+            std::cerr << "[FLEET] ";
+            (std::cerr << ... << parts);
+            std::cerr << std::endl;
+        }
+    }
+
+    void setError(const std::string& error) {
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            last_error = error;
+        }
+        log("Error: ", error);
+    }
+
+    void push(size_t worker, size_t task) {
+        {
+            std::lock_guard<std::mutex> lock(workers[worker]->mutex);
+            workers[worker]->tasks.push_back(task);
+        }
+        queued.fetch_add(1);
+        idle_cv.notify_one();
+    }
+
+    // Own queue is served oldest first, so every game gets its turn
+    bool popLocal(size_t worker, size_t& task) {
+        std::lock_guard<std::mutex> lock(workers[worker]->mutex);
+        auto& tasks = workers[worker]->tasks;
+        if (tasks.empty()) {
+            return false;
+        }
+        task = tasks.front();
+        tasks.pop_front();
+        queued.fetch_sub(1);
+        return true;
+    }
+
+    // Thieves take from the back, away from the owner
+    bool steal(size_t thief, size_t& task) {
+        for (size_t offset = 1; offset < workers.size(); ++offset) {
+            Worker& victim = *workers[(thief + offset) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.back();
+                victim.tasks.pop_back();
+                queued.fetch_sub(1);
+                steals.fetch_add(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Advance one game
+    StepResult runStep(size_t index) {
+        Instance& instance = *instances[index];
+
+        // A batch decision is sent on the game's next turn, by whichever worker has it
+        if (!instance.decided.empty()) {
+            bool sent = instance.decided.size() == 1 ? instance.client.sendAction(instance.decided.front())
+                                                     : instance.client.sendActions(instance.decided);
+            if (!sent) {
+                setError("Instance " + instance.address + ": " + instance.client.getLastError());
+            }
+            instance.decided.clear();
+        }
+
+        // An unreachable server is retried once its back-off expires; until then the
+        // worker waits on it no longer than a poll would take, so other games keep turning
+        int wait_ms = pollBudgetMs();
+        if (instance.backoff_ns > 0) {
+            int64_t left_ns = instance.retry_ns - nowNs();
+            if (left_ns > 0) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(std::min<int64_t>(left_ns, int64_t{wait_ms} * 1000000)));
+                if (nowNs() < instance.retry_ns) {
+                    return StepResult::REQUEUE;
+                }
+            }
+        }
+
+        if (!instance.client.waitForGameState(instance.version, wait_ms)) {
+            if (!instance.client.isConnected()) {
+                setError("Instance " + instance.address + ": " + instance.client.getLastError());
+                instance.backoff_ns = std::min(instance.backoff_ns > 0 ? instance.backoff_ns * 2 : kReconnectDelayNs,
+                                               kMaxReconnectDelayNs);
+                instance.retry_ns = nowNs() + instance.backoff_ns;
+            } else {
+                instance.backoff_ns = 0;
+            }
+            return StepResult::REQUEUE;
+        }
+        instance.backoff_ns = 0;
+
+        const GameState& state = instance.client.getGameState();
+        instance.version = state.state_version;
+        states.fetch_add(1);
+        if (!state.ready_for_command) {
+            return StepResult::REQUEUE;
+        }
+
+        steps.fetch_add(1);
+        instance.steps.fetch_add(1);
+        if (policy) {
+            return StepResult::PARK;
+        }
+        try {
+            return instance.agent->step(index, instance.client, state) ? StepResult::REQUEUE : StepResult::RETIRE;
+        } catch (const std::exception& e) {
+            setError("Agent for " + instance.address + " failed: " + e.what());
+            return StepResult::RETIRE;
+        }
+    }
+
+    // Long-poll budget: a short slice while other games wait for a worker, cut short so a
+    // pending batch is not held past its deadline. Never 0, which the server treats as a
+    // non-blocking poll, so a worker cannot spin on servers that have nothing new.
+    int pollBudgetMs() const {
+        int budget = config.poll_timeout_ms;
+        if (queued.load() > 0) {
+            budget = std::min(budget, config.poll_slice_ms);
+        }
+        if (pending_count.load() > 0) {
+            int64_t left_ns = pending_since_ns.load() + int64_t{config.max_batch_wait_us} * 1000 - nowNs();
+            budget = std::min(budget, static_cast<int>(std::max<int64_t>((left_ns + 999999) / 1000000, 0)));
+        }
+        return std::max(budget, 1);
+    }
+
+    size_t batchLimit() const {
+        return config.max_batch > 0 ? static_cast<size_t>(config.max_batch) : instances.size();
+    }
+
+    // Take the pending batch if it is full, every active game is in it, or it is overdue
+    bool takeBatch(std::vector<size_t>& batch, bool check_deadline) {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        bool full = !pending.empty() && (pending.size() >= batchLimit() || pending.size() >= active.load());
+        bool overdue = check_deadline && !pending.empty() &&
+                       nowNs() - pending_since_ns.load() >= int64_t{config.max_batch_wait_us} * 1000;
+        if (!full && !overdue) {
+            return false;
+        }
+        size_t count = std::min(pending.size(), batchLimit());
+        batch.assign(pending.begin(), pending.begin() + count);
+        pending.erase(pending.begin(), pending.begin() + count);
+        pending_count.store(pending.size());
+        pending_since_ns.store(nowNs());  // The rest restart their wait
+        return true;
+    }
+
+    void park(size_t worker, size_t task) {
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex);
+            if (pending.empty()) {
+                pending_since_ns.store(nowNs());
+            }
+            pending.push_back(task);
+            pending_count.store(pending.size());
+        }
+        flushBatch(worker, false);
+    }
+
+    // Run the policy on the pending batch if it is ready
+    void flushBatch(size_t worker, bool check_deadline) {
+        if (pending_count.load() == 0) {
+            return;
+        }
+        std::vector<size_t> batch;
+        if (!takeBatch(batch, check_deadline)) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(batch_mutex);
+        features.reset(batch.size());
+        entries.clear();
+        decisions.resize(batch.size());
+        for (size_t row = 0; row < batch.size(); ++row) {
+            SpireCommClient& client = instances[batch[row]]->client;
+            const GameState& state = client.getGameState();
+            features.encode(row, state);
+            entries.push_back({batch[row], &state, &client.legalActions()});
+            decisions[row].actions.clear();
+            decisions[row].keep_playing = true;
+        }
+
+        batches.fetch_add(1);
+        bool failed = false;
+        try {
+            policy(features, entries, decisions);
+        } catch (const std::exception& e) {
+            setError(std::string("Batch policy failed: ") + e.what());
+            failed = true;
+        }
+
+        for (size_t row = 0; row < batch.size(); ++row) {
+            if (failed || !decisions[row].keep_playing) {
+                retire(batch[row]);
+                continue;
+            }
+            instances[batch[row]]->decided.swap(decisions[row].actions);  // Keeps both capacities in use
+            push((worker + row) % workers.size(), batch[row]);
+        }
+    }
+
+    void retire(size_t task) {
+        log("Instance ", instances[task]->address, " retired");
+        if (active.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            idle_cv.notify_all();
+        }
+    }
+
+    void workerLoop(size_t worker) {
+        while (!stopping.load()) {
+            flushBatch(worker, true);
+
+            size_t task;
+            if (!popLocal(worker, task) && !steal(worker, task)) {
+                if (active.load() == 0) {
+                    break;
+                }
+                auto idle_wait = kIdleWait;
+                if (pending_count.load() > 0) {
+                    idle_wait = std::min<std::chrono::milliseconds>(idle_wait, std::chrono::milliseconds(pollBudgetMs()));
+                }
+                std::unique_lock<std::mutex> lock(idle_mutex);
+                idle_cv.wait_for(lock, idle_wait, [this] {
+                    return stopping.load() || queued.load() > 0 || active.load() == 0;
+                });
+                continue;
+            }
+
+            switch (runStep(task)) {
+                case StepResult::REQUEUE:
+                    push(worker, task);
+                    break;
+                case StepResult::PARK:
+                    park(worker, task);
+                    break;
+                case StepResult::RETIRE:
+                    retire(task);
+                    break;
+            }
+        }
+    }
+
+    bool canStart() {
+        if (running.load()) {
+            setError("Fleet already running");
+            return false;
+        }
+        if (instances.empty()) {
+            setError("No connected instances");
+            return false;
+        }
+        return true;
+    }
+
+    // Reset the counters and start the workers
+    void launch() {
+        for (auto& instance : instances) {
+            instance->steps.store(0);
+            instance->decided.clear();
+        }
+
+        size_t num_threads = config.num_threads > 0
+            ? static_cast<size_t>(config.num_threads)
+            : std::max(1u, std::thread::hardware_concurrency());
+        num_threads = std::min(num_threads, instances.size());
+
+        stopping.store(false);
+        active.store(instances.size());
+        queued.store(0);
+        states.store(0);
+        steps.store(0);
+        steals.store(0);
+        batches.store(0);
+        pending.clear();
+        pending_count.store(0);
+        start_ns.store(nowNs());
+        stop_ns.store(0);
+
+        // Deal the games out round-robin before any worker runs
+        for (size_t w = 0; w < num_threads; ++w) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < instances.size(); ++i) {
+            workers[i % num_threads]->tasks.push_back(i);
+        }
+        queued.store(instances.size());
+
+        running.store(true);
+        for (size_t w = 0; w < num_threads; ++w) {
+            workers[w]->thread = std::thread([this, w] { workerLoop(w); });
+        }
+        log("Started ", num_threads, " workers for ", instances.size(), " instances", policy ? " (batched)" : "");
+    }
+
+    void joinWorkers() {
+        std::lock_guard<std::mutex> lock(join_mutex);
+        for (auto& worker : workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+        workers.clear();
+        if (running.exchange(false)) {
+            stop_ns.store(nowNs());
+        }
+    }
+};
+
+// Constructor
+SpireCommFleet::SpireCommFleet(const FleetConfig& config)
+    : pImpl(std::make_unique<Impl>(config)) {}
+
+// Destructor
+SpireCommFleet::~SpireCommFleet() {
+    stop();
+}
+
+// Connect to every instance in the port range
+size_t SpireCommFleet::connect() {
+    if (pImpl->running.load()) {
+        return pImpl->instances.size();
+    }
+
+    const FleetConfig& config = pImpl->config;
+    // These name one file each; shared across instances they would collide
+    if (!config.client.shm_path.empty() || !config.client.record_path.empty() || !config.client.replay_path.empty()) {
+        pImpl->setError("FleetConfig::client must not set shm_path, record_path or replay_path");
+        pImpl->instances.clear();
+        return 0;
+    }
+    size_t total = config.unix_sockets.empty() ? static_cast<size_t>(std::max(config.num_instances, 0)) : config.unix_sockets.size();
+
+    pImpl->instances.clear();
+    for (size_t i = 0; i < total; ++i) {
+        ClientConfig cfg = config.client;
+        if (config.unix_sockets.empty()) {
+            cfg.port = config.first_port + static_cast<int>(i);
+            cfg.unix_socket.clear();
+        } else {
+            cfg.unix_socket = config.unix_sockets[i];
+        }
+
+        auto instance = std::make_unique<Impl::Instance>(cfg);
+        if (!instance->client.connect()) {
+            pImpl->setError("Instance " + instance->address + ": " + instance->client.getLastError());
+            continue;
+        }
+        pImpl->instances.push_back(std::move(instance));
+    }
+
+    pImpl->log("Connected to ", pImpl->instances.size(), " of ", total, " instances");
+    return pImpl->instances.size();
+}
+
+// Create agents and launch the workers
+bool SpireCommFleet::start(const FleetAgentFactory& factory) {
+    if (!pImpl->canStart()) {
+        return false;
+    }
+    pImpl->policy = nullptr;
+    for (size_t i = 0; i < pImpl->instances.size(); ++i) {
+        pImpl->instances[i]->agent = factory(i);
+    }
+    pImpl->launch();
+    return true;
+}
+
+// Launch the workers with one policy for every game
+bool SpireCommFleet::startBatched(const BatchPolicy& policy) {
+    if (!pImpl->canStart()) {
+        return false;
+    }
+    pImpl->policy = policy;
+    for (auto& instance : pImpl->instances) {
+        instance->agent.reset();
+    }
+    pImpl->launch();
+    return true;
+}
+
+// Block until every agent has retired or stop() is called
+void SpireCommFleet::wait() {
+    if (!pImpl->running.load()) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(pImpl->idle_mutex);
+        pImpl->idle_cv.wait(lock, [this] { return pImpl->active.load() == 0 || pImpl->stopping.load(); });
+    }
+    pImpl->joinWorkers();
+}
+
+// Stop the workers after their current step
+void SpireCommFleet::stop() {
+    {
+        std::lock_guard<std::mutex> lock(pImpl->idle_mutex);
+        pImpl->stopping.store(true);
+    }
+    pImpl->idle_cv.notify_all();
+    pImpl->joinWorkers();
+}
+
+bool SpireCommFleet::isRunning() const {
+    return pImpl->running.load();
+}
+
+size_t SpireCommFleet::size() const {
+    return pImpl->instances.size();
+}
+
+int SpireCommFleet::port(size_t instance) const {
+    return pImpl->instances.at(instance)->port;
+}
+
+std::string SpireCommFleet::address(size_t instance) const {
+    return pImpl->instances.at(instance)->address;
+}
+
+FleetStats SpireCommFleet::getStats() const {
+    FleetStats stats;
+    stats.instances = pImpl->instances.size();
+    stats.active = pImpl->running.load() ? pImpl->active.load() : 0;
+    stats.states = pImpl->states.load();
+    stats.steps = pImpl->steps.load();
+    stats.steals = pImpl->steals.load();
+    stats.batches = pImpl->batches.load();
+
+    int64_t start = pImpl->start_ns.load();
+    if (start != 0) {
+        int64_t stop = pImpl->stop_ns.load();
+        stats.elapsed_seconds = static_cast<double>((stop != 0 ? stop : nowNs()) - start) / 1e9;
+    }
+    if (stats.elapsed_seconds > 0) {
+        stats.steps_per_second = static_cast<double>(stats.steps) / stats.elapsed_seconds;
+    }
+
+    stats.steps_per_instance.reserve(pImpl->instances.size());
+    for (const auto& instance : pImpl->instances) {
+        stats.steps_per_instance.push_back(instance->steps.load());
+    }
+    return stats;
+}
+
+std::string SpireCommFleet::getLastError() const {
+    std::lock_guard<std::mutex> lock(pImpl->error_mutex);
+    return pImpl->last_error;
+}
+
+} // namespace spirecomm
@@ -0,0 +1,1087 @@
+#include "spirecomm/game_state.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+namespace spirecomm {
+
+using json = nlohmann::json;
+
+namespace {
+
+// Enum names in declaration order, matching the Python enum .name values
+
+constexpr std::string_view kScreenTypeNames[] = {
+    "NONE", "EVENT", "CHEST", "SHOP_ROOM", "REST", "CARD_REWARD", "COMBAT_REWARD", "MAP",
+    "BOSS_REWARD", "SHOP_SCREEN", "GRID", "HAND_SELECT", "GAME_OVER", "COMPLETE"
+};
+constexpr std::string_view kRoomPhaseNames[] = {"COMBAT", "EVENT", "COMPLETE", "INCOMPLETE"};
+constexpr std::string_view kRoomTypeNames[] = {
+    // Java class names as sent by Communication Mod
+    "MonsterRoom", "MonsterRoomElite", "MonsterRoomBoss", "ShopRoom", "RestRoom",
+    "EventRoom", "TreasureRoom", "NeowRoom"
+};
+constexpr std::string_view kPlayerClassNames[] = {"IRONCLAD", "THE_SILENT", "DEFECT", "WATCHER"};
+constexpr std::string_view kCardTypeNames[] = {"ATTACK", "SKILL", "POWER", "STATUS", "CURSE"};
+constexpr std::string_view kCardRarityNames[] = {"BASIC", "COMMON", "UNCOMMON", "RARE", "SPECIAL", "CURSE"};
+constexpr std::string_view kIntentNames[] = {
+    "ATTACK", "ATTACK_BUFF", "ATTACK_DEBUFF", "ATTACK_DEFEND", "BUFF", "DEBUFF", "STRONG_DEBUFF",
+    "DEBUG", "DEFEND", "DEFEND_DEBUFF", "DEFEND_BUFF", "ESCAPE", "MAGIC", "NONE", "SLEEP", "STUN"
+};
+constexpr std::string_view kChestTypeNames[] = {"SMALL", "MEDIUM", "LARGE", "BOSS"};
+constexpr std::string_view kRewardTypeNames[] = {
+    "CARD", "GOLD", "RELIC", "POTION", "STOLEN_GOLD", "EMERALD_KEY", "SAPPHIRE_KEY"
+};
+constexpr std::string_view kRestOptionNames[] = {"DIG", "LIFT", "RECALL", "REST", "SMITH", "TOKE"};
+
+// Indexed by bit position in Command
+constexpr std::string_view kCommandNames[] = {
+    "play", "end", "potion", "choose", "proceed", "confirm", "cancel", "return",
+    "skip", "leave", "start", "state", "key", "click", "wait"
+};
+
+// Field accessors: a missing key, null or mismatched type yields the default
+
+const json* field(const json& obj, const char* key) {
+    if (!obj.is_object()) {
+        return nullptr;
+    }
+    auto it = obj.find(key);
+    if (it == obj.end() || it->is_null()) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+// Truncate a float field to int64; NaN becomes 0 and out-of-range values
+// saturate, where a plain cast would be undefined (1e300 in JSON, or NaN and
+// Inf from MessagePack/CBOR)
+int64_t toInt64(double value) {
+    constexpr double kLimit = 9223372036854775808.0;  // 2^63
+    if (std::isnan(value)) {
+        return 0;
+    }
+    if (value >= kLimit) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    if (value < -kLimit) {
+        return std::numeric_limits<int64_t>::min();
+    }
+    return static_cast<int64_t>(value);
+}
+
+int64_t getInt64(const json& obj, const char* key, int64_t def = 0) {
+    const json* v = field(obj, key);
+    if (!v || !v->is_number()) {
+        return def;
+    }
+    return v->is_number_float() ? toInt64(v->get<double>()) : v->get<int64_t>();
+}
+
+// Narrow to an int32 field, saturating like toInt64()
+int32_t toInt32(int64_t value) {
+    return static_cast<int32_t>(std::clamp<int64_t>(value, std::numeric_limits<int32_t>::min(),
+                                                    std::numeric_limits<int32_t>::max()));
+}
+
+int32_t getInt(const json& obj, const char* key, int32_t def = 0) {
+    return toInt32(getInt64(obj, key, def));
+}
+
+bool getBool(const json& obj, const char* key) {
+    const json* v = field(obj, key);
+    return v && v->is_boolean() && v->get<bool>();
+}
+
+const json& getArray(const json& obj, const char* key) {
+    static const json empty = json::array();
+    const json* v = field(obj, key);
+    return v && v->is_array() ? *v : empty;
+}
+
+const json& getObject(const json& obj, const char* key) {
+    static const json empty = json::object();
+    const json* v = field(obj, key);
+    return v && v->is_object() ? *v : empty;
+}
+
+// Copy a string value into the state's pool
+StrRef intern(GameState& gs, const json& value) {
+    if (!value.is_string()) {
+        return {};
+    }
+    const auto& s = value.get_ref<const std::string&>();
+    StrRef ref{static_cast<uint32_t>(gs.strings.size()), static_cast<uint32_t>(s.size())};
+    gs.strings.append(s);
+    return ref;
+}
+
+StrRef getStr(GameState& gs, const json& obj, const char* key) {
+    const json* v = field(obj, key);
+    return v ? intern(gs, *v) : StrRef{};
+}
+
+// View of a string value, empty if missing or not a string
+std::string_view getView(const json& obj, const char* key) {
+    const json* v = field(obj, key);
+    return v && v->is_string() ? std::string_view(v->get_ref<const std::string&>()) : std::string_view();
+}
+
+template <typename E, size_t N>
+E toEnum(const json& value, const std::string_view (&names)[N]) {
+    if (value.is_string()) {
+        const auto& s = value.get_ref<const std::string&>();
+        for (size_t i = 0; i < N; ++i) {
+            if (names[i] == s) {
+                return static_cast<E>(i);
+            }
+        }
+    }
+    return E::UNKNOWN;
+}
+
+template <typename E, size_t N>
+E getEnum(const json& obj, const char* key, const std::string_view (&names)[N]) {
+    const json* v = field(obj, key);
+    return v ? toEnum<E>(*v, names) : E::UNKNOWN;
+}
+
+void parseCard(const json& j, GameState& gs, Card& card) {
+    card.id = cardId(getView(j, "id"));
+    card.name = getStr(gs, j, "name");
+    card.uuid = getStr(gs, j, "uuid");
+    card.cost = getInt(j, "cost");
+    card.upgrades = getInt(j, "upgrades");
+    card.misc = getInt(j, "misc");
+    card.price = getInt(j, "price");
+    card.type = getEnum<CardType>(j, "type", kCardTypeNames);
+    card.rarity = getEnum<CardRarity>(j, "rarity", kCardRarityNames);
+    card.has_target = getBool(j, "has_target");
+    card.is_playable = getBool(j, "is_playable");
+    card.exhausts = getBool(j, "exhausts");
+}
+
+void parseCards(const json& array, GameState& gs, std::vector<Card>& cards) {
+    cards.resize(array.size());
+    for (size_t i = 0; i < array.size(); ++i) {
+        parseCard(array[i], gs, cards[i]);
+    }
+}
+
+PowerRange parsePowers(const json& array, GameState& gs) {
+    auto& powers = gs.combat.powers;
+    PowerRange range{static_cast<uint32_t>(powers.size()), static_cast<uint32_t>(array.size())};
+    for (const auto& j : array) {
+        Power& power = powers.emplace_back();
+        power.id = powerId(getView(j, "id"));
+        power.name = getStr(gs, j, "name");
+        power.amount = getInt(j, "amount");
+        power.damage = getInt(j, "damage");
+        power.misc = getInt(j, "misc");
+        power.just_applied = getBool(j, "just_applied");
+    }
+    return range;
+}
+
+void parseRelic(const json& j, GameState& gs, Relic& relic) {
+    relic.id = relicId(getView(j, "id"));
+    relic.name = getStr(gs, j, "name");
+    relic.counter = getInt(j, "counter");
+    relic.price = getInt(j, "price");
+}
+
+void parsePotion(const json& j, GameState& gs, Potion& potion) {
+    potion.id = potionId(getView(j, "id"));
+    potion.name = getStr(gs, j, "name");
+    potion.price = getInt(j, "price");
+    potion.can_use = getBool(j, "can_use");
+    potion.can_discard = getBool(j, "can_discard");
+    potion.requires_target = getBool(j, "requires_target");
+}
+
+void parseRelics(const json& array, GameState& gs, std::vector<Relic>& relics) {
+    relics.resize(array.size());
+    for (size_t i = 0; i < array.size(); ++i) {
+        parseRelic(array[i], gs, relics[i]);
+    }
+}
+
+void parsePotions(const json& array, GameState& gs, std::vector<Potion>& potions) {
+    potions.resize(array.size());
+    for (size_t i = 0; i < array.size(); ++i) {
+        parsePotion(array[i], gs, potions[i]);
+    }
+}
+
+void parseMapNode(const json& j, GameState& gs, MapNode& node) {
+    node.x = getInt(j, "x");
+    node.y = getInt(j, "y");
+    const json* symbol = field(j, "symbol");
+    node.symbol = symbol && symbol->is_string() && !symbol->get_ref<const std::string&>().empty()
+                      ? symbol->get_ref<const std::string&>()[0]
+                      : '?';
+
+    const json& children = getArray(j, "children");
+    node.first_child = static_cast<uint32_t>(gs.map_children.size());
+    node.num_children = static_cast<uint32_t>(children.size());
+    for (const auto& child : children) {
+        gs.map_children.push_back({getInt(child, "x"), getInt(child, "y")});
+    }
+}
+
+void parseMapNodes(const json& array, GameState& gs, std::vector<MapNode>& nodes) {
+    nodes.resize(array.size());
+    for (size_t i = 0; i < array.size(); ++i) {
+        parseMapNode(array[i], gs, nodes[i]);
+    }
+}
+
+void parseCombat(const json& j, GameState& gs) {
+    CombatState& combat = gs.combat;
+
+    const json& player = getObject(j, "player");
+    combat.player.current_hp = getInt(player, "current_hp");
+    combat.player.max_hp = getInt(player, "max_hp");
+    combat.player.block = getInt(player, "block");
+    combat.player.energy = getInt(player, "energy");
+    combat.player.powers = parsePowers(getArray(player, "powers"), gs);
+
+    for (const auto& o : getArray(player, "orbs")) {
+        Orb& orb = combat.orbs.emplace_back();
+        orb.id = getStr(gs, o, "id");
+        orb.name = getStr(gs, o, "name");
+        orb.evoke_amount = getInt(o, "evoke_amount");
+        orb.passive_amount = getInt(o, "passive_amount");
+    }
+
+    const json& monsters = getArray(j, "monsters");
+    combat.monsters.resize(monsters.size());
+    for (size_t i = 0; i < monsters.size(); ++i) {
+        const json& m = monsters[i];
+        Monster& monster = combat.monsters[i];
+        monster.id = getStr(gs, m, "id");
+        monster.name = getStr(gs, m, "name");
+        monster.current_hp = getInt(m, "current_hp");
+        monster.max_hp = getInt(m, "max_hp");
+        monster.block = getInt(m, "block");
+        monster.move_id = getInt(m, "move_id", -1);
+        monster.last_move_id = getInt(m, "last_move_id", -1);
+        monster.second_last_move_id = getInt(m, "second_last_move_id", -1);
+        monster.move_base_damage = getInt(m, "move_base_damage");
+        monster.move_adjusted_damage = getInt(m, "move_adjusted_damage");
+        monster.move_hits = getInt(m, "move_hits");
+        monster.intent = getEnum<Intent>(m, "intent", kIntentNames);
+        monster.half_dead = getBool(m, "half_dead");
+        monster.is_gone = getBool(m, "is_gone");
+        monster.powers = parsePowers(getArray(m, "powers"), gs);
+    }
+
+    parseCards(getArray(j, "hand"), gs, combat.hand);
+    parseCards(getArray(j, "draw_pile"), gs, combat.draw_pile);
+    parseCards(getArray(j, "discard_pile"), gs, combat.discard_pile);
+    parseCards(getArray(j, "exhaust_pile"), gs, combat.exhaust_pile);
+    parseCards(getArray(j, "limbo"), gs, combat.limbo);
+
+    const json* card_in_play = field(j, "card_in_play");
+    combat.has_card_in_play = card_in_play && card_in_play->is_object();
+    if (combat.has_card_in_play) {
+        parseCard(*card_in_play, gs, combat.card_in_play);
+    }
+
+    combat.turn = getInt(j, "turn");
+    combat.cards_discarded_this_turn = getInt(j, "cards_discarded_this_turn");
+}
+
+void parseScreen(const json& j, GameState& gs) {
+    ScreenState& screen = gs.screen;
+    screen.screen_type = field(j, "screen_type") ? getEnum<ScreenType>(j, "screen_type", kScreenTypeNames)
+                                                  : ScreenType::NONE;
+
+    // Event
+    screen.event_name = getStr(gs, j, "event_name");
+    screen.event_id = getStr(gs, j, "event_id");
+    screen.body_text = getStr(gs, j, "body_text");
+    const json& options = getArray(j, "options");
+    screen.options.resize(options.size());
+    for (size_t i = 0; i < options.size(); ++i) {
+        EventOption& option = screen.options[i];
+        option.label = getStr(gs, options[i], "label");
+        option.text = getStr(gs, options[i], "text");
+        option.choice_index = getInt(options[i], "choice_index", -1);
+        option.disabled = getBool(options[i], "disabled");
+    }
+
+    // Chest
+    screen.chest_type = getEnum<ChestType>(j, "chest_type", kChestTypeNames);
+    screen.chest_open = getBool(j, "chest_open");
+
+    // Rest
+    screen.has_rested = getBool(j, "has_rested");
+    const json& rest_options = getArray(j, "rest_options");
+    screen.rest_options.resize(rest_options.size());
+    for (size_t i = 0; i < rest_options.size(); ++i) {
+        screen.rest_options[i] = toEnum<RestOption>(rest_options[i], kRestOptionNames);
+    }
+
+    // Card lists
+    parseCards(getArray(j, "cards"), gs, screen.cards);
+    parseCards(getArray(j, "selected_cards"), gs, screen.selected_cards);
+    screen.can_bowl = getBool(j, "can_bowl");
+    screen.can_skip = getBool(j, "can_skip");
+
+    // Relics and potions (boss reward, shop)
+    parseRelics(getArray(j, "relics"), gs, screen.relics);
+    parsePotions(getArray(j, "potions"), gs, screen.potions);
+    screen.purge_available = getBool(j, "purge_available");
+    screen.purge_cost = getInt(j, "purge_cost");
+
+    // Combat rewards; reward relics and potions are appended after any listed above
+    const json& rewards = getArray(j, "rewards");
+    screen.rewards.resize(rewards.size());
+    for (size_t i = 0; i < rewards.size(); ++i) {
+        const json& r = rewards[i];
+        Reward& reward = screen.rewards[i];
+        reward.type = getEnum<RewardType>(r, "reward_type", kRewardTypeNames);
+        reward.gold = getInt(r, "gold");
+        reward.relic = -1;
+        reward.potion = -1;
+        if (const json* relic = field(r, "relic")) {
+            reward.relic = static_cast<int32_t>(screen.relics.size());
+            parseRelic(*relic, gs, screen.relics.emplace_back());
+        }
+        if (const json* potion = field(r, "potion")) {
+            reward.potion = static_cast<int32_t>(screen.potions.size());
+            parsePotion(*potion, gs, screen.potions.emplace_back());
+        }
+    }
+
+    // Map
+    const json* current_node = field(j, "current_node");
+    screen.has_current_node = current_node && current_node->is_object();
+    if (screen.has_current_node) {
+        parseMapNode(*current_node, gs, screen.current_node);
+    }
+    parseMapNodes(getArray(j, "next_nodes"), gs, screen.next_nodes);
+    screen.boss_available = getBool(j, "boss_available");
+
+    // Grid / hand select
+    screen.num_cards = getInt(j, "num_cards");
+    screen.any_number = getBool(j, "any_number");
+    screen.confirm_up = getBool(j, "confirm_up");
+    screen.for_upgrade = getBool(j, "for_upgrade");
+    screen.for_transform = getBool(j, "for_transform");
+    screen.for_purge = getBool(j, "for_purge");
+    screen.can_pick_zero = getBool(j, "can_pick_zero");
+
+    // Game over
+    screen.score = getInt(j, "score");
+    screen.victory = getBool(j, "victory");
+}
+
+// SAX handler that fills a GameState as the text is tokenized
+//
+// A fixed stack of frames tracks which struct the parser is inside; values
+// under keys the handler does not know (or sections the caller excluded) are
+// skipped by depth counting, so they never allocate.
+class GameStateSax {
+public:
+    GameStateSax(GameState& out, uint32_t sections) : gs_(out), sections_(sections) {}
+
+    // nlohmann::json_sax interface
+
+    bool null() { return scalar(Scalar{}); }
+    bool boolean(bool value) { Scalar v; v.kind = Scalar::BOOL; v.b = value; return scalar(v); }
+    bool number_integer(json::number_integer_t value) { Scalar v; v.kind = Scalar::INT; v.i = value; return scalar(v); }
+    bool number_unsigned(json::number_unsigned_t value) {
+        Scalar v;
+        v.kind = Scalar::INT;
+        v.i = static_cast<int64_t>(value);
+        return scalar(v);
+    }
+    bool number_float(json::number_float_t value, const json::string_t&) {
+        Scalar v;
+        v.kind = Scalar::FLOAT;
+        v.i = toInt64(value);
+        return scalar(v);
+    }
+    bool string(json::string_t& value) { Scalar v; v.kind = Scalar::STRING; v.s = &value; return scalar(v); }
+    bool binary(json::binary_t&) { return scalar(Scalar{}); }
+
+    bool key(json::string_t& value) {
+        if (skip_depth_ == 0) {
+            // Keys longer than any field name can never match, so just forget them
+            key_len_ = value.size() < sizeof(key_) ? value.size() : 0;
+            value.copy(key_, key_len_);
+        }
+        return true;
+    }
+
+    bool start_object(size_t) {
+        if (skip_depth_ > 0 || depth_ == kMaxDepth) {
+            ++skip_depth_;
+            return true;
+        }
+        if (depth_ == 0) {
+            push(Ctx::ROOT);
+            return true;
+        }
+        Frame child = isList(top().ctx) ? appendElement() : childObject();
+        if (child.ctx == Ctx::SKIP) {
+            ++skip_depth_;
+        } else {
+            push(child.ctx, child.target);
+        }
+        return true;
+    }
+
+    bool start_array(size_t) {
+        if (skip_depth_ > 0 || depth_ == 0 || depth_ == kMaxDepth) {
+            ++skip_depth_;
+            return true;
+        }
+        if (isList(top().ctx)) {
+            // Nested arrays are never valid elements; keep the index alignment and skip it
+            appendElement();
+            ++skip_depth_;
+            return true;
+        }
+        Frame child = childArray();
+        if (child.ctx == Ctx::SKIP) {
+            ++skip_depth_;
+        } else {
+            push(child.ctx, child.target);
+        }
+        return true;
+    }
+
+    bool end_object() { return end(); }
+    bool end_array() { return end(); }
+
+    bool parse_error(size_t, const std::string&, const nlohmann::detail::exception&) {
+        return false;
+    }
+
+private:
+    enum class Ctx : uint8_t {
+        ROOT, GAME, COMBAT, PLAYER, SCREEN,
+        CARD, RELIC, POTION, MAP_NODE, MAP_CHILD, POWER, ORB, MONSTER, OPTION, REWARD,
+        // Array contexts
+        COMMANDS, CARDS, RELICS, POTIONS, MAP_NODES, MAP_CHILDREN, POWERS, ORBS, MONSTERS,
+        OPTIONS, REST_OPTIONS, REWARDS,
+        SKIP
+    };
+
+    struct Frame {
+        Ctx ctx = Ctx::SKIP;
+        void* target = nullptr;  // Struct or container filled by this frame, depends on ctx
+    };
+
+    struct Scalar {
+        enum Kind : uint8_t { NUL, BOOL, INT, FLOAT, STRING } kind = NUL;
+        bool b = false;
+        int64_t i = 0;
+        const json::string_t* s = nullptr;
+
+        bool isNumber() const { return kind == INT || kind == FLOAT; }
+    };
+
+    static constexpr size_t kMaxDepth = 16;
+
+    GameState& gs_;
+    uint32_t sections_;
+    Frame stack_[kMaxDepth];
+    size_t depth_ = 0;
+    size_t skip_depth_ = 0;
+    char key_[32] = {};
+    size_t key_len_ = 0;
+
+    static bool isList(Ctx ctx) { return ctx >= Ctx::COMMANDS && ctx < Ctx::SKIP; }
+
+    const Frame& top() const { return stack_[depth_ - 1]; }
+    std::string_view key() const { return std::string_view(key_, key_len_); }
+    bool wants(uint32_t section) const { return (sections_ & section) != 0; }
+
+    template <typename T>
+    T& target() const { return *static_cast<T*>(top().target); }
+
+    void push(Ctx ctx, void* target = nullptr) { stack_[depth_++] = Frame{ctx, target}; }
+
+    bool end() {
+        if (skip_depth_ > 0) {
+            --skip_depth_;
+        } else if (depth_ > 0) {
+            --depth_;
+        }
+        return true;
+    }
+
+    // Append a default element to the list on top of the stack
+    Frame appendElement() {
+        CombatState& combat = gs_.combat;
+        ScreenState& screen = gs_.screen;
+        switch (top().ctx) {
+            case Ctx::CARDS: return {Ctx::CARD, &target<std::vector<Card>>().emplace_back()};
+            case Ctx::RELICS: return {Ctx::RELIC, &target<std::vector<Relic>>().emplace_back()};
+            case Ctx::POTIONS: return {Ctx::POTION, &target<std::vector<Potion>>().emplace_back()};
+            case Ctx::MAP_NODES: return {Ctx::MAP_NODE, &target<std::vector<MapNode>>().emplace_back()};
+            case Ctx::MAP_CHILDREN:
+                target<MapNode>().num_children++;
+                return {Ctx::MAP_CHILD, &gs_.map_children.emplace_back()};
+            case Ctx::POWERS:
+                target<PowerRange>().count++;
+                return {Ctx::POWER, &combat.powers.emplace_back()};
+            case Ctx::ORBS: return {Ctx::ORB, &combat.orbs.emplace_back()};
+            case Ctx::MONSTERS: return {Ctx::MONSTER, &combat.monsters.emplace_back()};
+            case Ctx::OPTIONS: return {Ctx::OPTION, &screen.options.emplace_back()};
+            case Ctx::REWARDS: return {Ctx::REWARD, &screen.rewards.emplace_back()};
+            default: return {};
+        }
+    }
+
+    // Frame for an object value under key() in the object on top of the stack
+    Frame childObject() {
+        std::string_view k = key();
+        ScreenState& screen = gs_.screen;
+        switch (top().ctx) {
+            case Ctx::ROOT:
+                if (k == "game_state") {
+                    gs_.has_game_state = true;
+                    return {Ctx::GAME};
+                }
+                break;
+            case Ctx::GAME:
+                if (k == "combat_state" && wants(StateSections::COMBAT)) {
+                    gs_.in_combat = true;
+                    return {Ctx::COMBAT};
+                }
+                if (k == "screen" && wants(StateSections::SCREEN)) {
+                    return {Ctx::SCREEN};
+                }
+                break;
+            case Ctx::COMBAT:
+                if (k == "player") {
+                    return {Ctx::PLAYER};
+                }
+                if (k == "card_in_play") {
+                    gs_.combat.has_card_in_play = true;
+                    return {Ctx::CARD, &gs_.combat.card_in_play};
+                }
+                break;
+            case Ctx::SCREEN:
+                if (k == "current_node") {
+                    screen.has_current_node = true;
+                    return {Ctx::MAP_NODE, &screen.current_node};
+                }
+                break;
+            case Ctx::REWARD:
+                if (k == "relic") {
+                    target<Reward>().relic = static_cast<int32_t>(screen.relics.size());
+                    return {Ctx::RELIC, &screen.relics.emplace_back()};
+                }
+                if (k == "potion") {
+                    target<Reward>().potion = static_cast<int32_t>(screen.potions.size());
+                    return {Ctx::POTION, &screen.potions.emplace_back()};
+                }
+                break;
+            default:
+                break;
+        }
+        return {};
+    }
+
+    // Frame for an array value under key() in the object on top of the stack
+    Frame childArray() {
+        std::string_view k = key();
+        CombatState& combat = gs_.combat;
+        ScreenState& screen = gs_.screen;
+        switch (top().ctx) {
+            case Ctx::ROOT:
+                if (k == "available_commands") return {Ctx::COMMANDS};
+                break;
+            case Ctx::GAME:
+                if (k == "relics" && wants(StateSections::ITEMS)) return {Ctx::RELICS, &gs_.relics};
+                if (k == "potions" && wants(StateSections::ITEMS)) return {Ctx::POTIONS, &gs_.potions};
+                if (k == "deck" && wants(StateSections::DECK)) return {Ctx::CARDS, &gs_.deck};
+                if (k == "map" && wants(StateSections::MAP)) return {Ctx::MAP_NODES, &gs_.map};
+                break;
+            case Ctx::COMBAT:
+                if (k == "monsters") return {Ctx::MONSTERS};
+                if (k == "hand") return {Ctx::CARDS, &combat.hand};
+                if (k == "draw_pile") return {Ctx::CARDS, &combat.draw_pile};
+                if (k == "discard_pile") return {Ctx::CARDS, &combat.discard_pile};
+                if (k == "exhaust_pile") return {Ctx::CARDS, &combat.exhaust_pile};
+                if (k == "limbo") return {Ctx::CARDS, &combat.limbo};
+                break;
+            case Ctx::PLAYER:
+                if (k == "powers") return powers(combat.player.powers);
+                if (k == "orbs") return {Ctx::ORBS};
+                break;
+            case Ctx::MONSTER:
+                if (k == "powers") return powers(target<Monster>().powers);
+                break;
+            case Ctx::MAP_NODE:
+                if (k == "children") {
+                    MapNode& node = target<MapNode>();
+                    node.first_child = static_cast<uint32_t>(gs_.map_children.size());
+                    node.num_children = 0;
+                    return {Ctx::MAP_CHILDREN, &node};
+                }
+                break;
+            case Ctx::SCREEN:
+                if (k == "options") return {Ctx::OPTIONS};
+                if (k == "rest_options") return {Ctx::REST_OPTIONS};
+                if (k == "cards") return {Ctx::CARDS, &screen.cards};
+                if (k == "selected_cards") return {Ctx::CARDS, &screen.selected_cards};
+                if (k == "rewards") return {Ctx::REWARDS};
+                if (k == "next_nodes") return {Ctx::MAP_NODES, &screen.next_nodes};
+                if (k == "relics") return {Ctx::RELICS, &screen.relics};
+                if (k == "potions") return {Ctx::POTIONS, &screen.potions};
+                break;
+            default:
+                break;
+        }
+        return {};
+    }
+
+    Frame powers(PowerRange& range) {
+        range.begin = static_cast<uint32_t>(gs_.combat.powers.size());
+        range.count = 0;
+        return {Ctx::POWERS, &range};
+    }
+
+    // Field setters: like the DOM accessors, null or mismatched values leave the default
+
+    static void set(int32_t& field, const Scalar& v) {
+        if (v.isNumber()) field = toInt32(v.i);
+    }
+    static void set(int64_t& field, const Scalar& v) {
+        if (v.isNumber()) field = v.i;
+    }
+    static void set(bool& field, const Scalar& v) {
+        if (v.kind == Scalar::BOOL) field = v.b;
+    }
+    void set(StrRef& field, const Scalar& v) {
+        if (v.kind == Scalar::STRING) field = intern(*v.s);
+    }
+    template <typename Id>
+    static void set(Id& field, const Scalar& v, Id (*lookup)(std::string_view)) {
+        if (v.kind == Scalar::STRING) field = lookup(*v.s);
+    }
+    template <typename E, size_t N>
+    static void set(E& field, const Scalar& v, const std::string_view (&names)[N]) {
+        if (v.kind != Scalar::NUL) field = toEnum<E>(v, names);
+    }
+
+    template <typename E, size_t N>
+    static E toEnum(const Scalar& v, const std::string_view (&names)[N]) {
+        if (v.kind == Scalar::STRING) {
+            for (size_t i = 0; i < N; ++i) {
+                if (names[i] == *v.s) {
+                    return static_cast<E>(i);
+                }
+            }
+        }
+        return E::UNKNOWN;
+    }
+
+    StrRef intern(const std::string& s) {
+        StrRef ref{static_cast<uint32_t>(gs_.strings.size()), static_cast<uint32_t>(s.size())};
+        gs_.strings.append(s);
+        return ref;
+    }
+
+    bool scalar(const Scalar& v) {
+        if (skip_depth_ > 0 || depth_ == 0) {
+            return true;
+        }
+        std::string_view k = key();
+        switch (top().ctx) {
+            case Ctx::ROOT: {
+                int64_t version = 0;
+                if (k == "state_version") { set(version, v); gs_.state_version = static_cast<uint64_t>(version); }
+                else if (k == "last_action_id") { set(version, v); gs_.last_action_id = static_cast<uint64_t>(version); }
+                else if (k == "in_game") set(gs_.in_game, v);
+                else if (k == "ready_for_command") set(gs_.ready_for_command, v);
+                break;
+            }
+            case Ctx::GAME:
+                if (k == "current_action") set(gs_.current_action, v);
+                else if (k == "current_hp") set(gs_.current_hp, v);
+                else if (k == "max_hp") set(gs_.max_hp, v);
+                else if (k == "floor") set(gs_.floor, v);
+                else if (k == "act") set(gs_.act, v);
+                else if (k == "gold") set(gs_.gold, v);
+                else if (k == "seed") set(gs_.seed, v);
+                else if (k == "ascension_level") set(gs_.ascension_level, v);
+                else if (k == "act_boss") set(gs_.act_boss, v);
+                else if (k == "character") set(gs_.character, v, kPlayerClassNames);
+                else if (k == "screen_type") set(gs_.screen_type, v, kScreenTypeNames);
+                else if (k == "room_phase") set(gs_.room_phase, v, kRoomPhaseNames);
+                else if (k == "room_type") set(gs_.room_type, v, kRoomTypeNames);
+                else if (k == "is_screen_up") set(gs_.is_screen_up, v);
+                else if (k == "choice_available") set(gs_.choice_available, v);
+                break;
+            case Ctx::COMBAT: {
+                CombatState& combat = gs_.combat;
+                if (k == "turn") set(combat.turn, v);
+                else if (k == "cards_discarded_this_turn") set(combat.cards_discarded_this_turn, v);
+                break;
+            }
+            case Ctx::PLAYER: {
+                Player& player = gs_.combat.player;
+                if (k == "current_hp") set(player.current_hp, v);
+                else if (k == "max_hp") set(player.max_hp, v);
+                else if (k == "block") set(player.block, v);
+                else if (k == "energy") set(player.energy, v);
+                break;
+            }
+            case Ctx::SCREEN: {
+                ScreenState& screen = gs_.screen;
+                if (k == "screen_type") set(screen.screen_type, v, kScreenTypeNames);
+                else if (k == "event_name") set(screen.event_name, v);
+                else if (k == "event_id") set(screen.event_id, v);
+                else if (k == "body_text") set(screen.body_text, v);
+                else if (k == "chest_type") set(screen.chest_type, v, kChestTypeNames);
+                else if (k == "chest_open") set(screen.chest_open, v);
+                else if (k == "has_rested") set(screen.has_rested, v);
+                else if (k == "can_bowl") set(screen.can_bowl, v);
+                else if (k == "can_skip") set(screen.can_skip, v);
+                else if (k == "boss_available") set(screen.boss_available, v);
+                else if (k == "purge_available") set(screen.purge_available, v);
+                else if (k == "purge_cost") set(screen.purge_cost, v);
+                else if (k == "num_cards") set(screen.num_cards, v);
+                else if (k == "any_number") set(screen.any_number, v);
+                else if (k == "confirm_up") set(screen.confirm_up, v);
+                else if (k == "for_upgrade") set(screen.for_upgrade, v);
+                else if (k == "for_transform") set(screen.for_transform, v);
+                else if (k == "for_purge") set(screen.for_purge, v);
+                else if (k == "can_pick_zero") set(screen.can_pick_zero, v);
+                else if (k == "score") set(screen.score, v);
+                else if (k == "victory") set(screen.victory, v);
+                break;
+            }
+            case Ctx::CARD: {
+                Card& card = target<Card>();
+                if (k == "id") set(card.id, v, cardId);
+                else if (k == "name") set(card.name, v);
+                else if (k == "uuid") set(card.uuid, v);
+                else if (k == "cost") set(card.cost, v);
+                else if (k == "upgrades") set(card.upgrades, v);
+                else if (k == "misc") set(card.misc, v);
+                else if (k == "price") set(card.price, v);
+                else if (k == "type") set(card.type, v, kCardTypeNames);
+                else if (k == "rarity") set(card.rarity, v, kCardRarityNames);
+                else if (k == "has_target") set(card.has_target, v);
+                else if (k == "is_playable") set(card.is_playable, v);
+                else if (k == "exhausts") set(card.exhausts, v);
+                break;
+            }
+            case Ctx::RELIC: {
+                Relic& relic = target<Relic>();
+                if (k == "id") set(relic.id, v, relicId);
+                else if (k == "name") set(relic.name, v);
+                else if (k == "counter") set(relic.counter, v);
+                else if (k == "price") set(relic.price, v);
+                break;
+            }
+            case Ctx::POTION: {
+                Potion& potion = target<Potion>();
+                if (k == "id") set(potion.id, v, potionId);
+                else if (k == "name") set(potion.name, v);
+                else if (k == "price") set(potion.price, v);
+                else if (k == "can_use") set(potion.can_use, v);
+                else if (k == "can_discard") set(potion.can_discard, v);
+                else if (k == "requires_target") set(potion.requires_target, v);
+                break;
+            }
+            case Ctx::MAP_NODE: {
+                MapNode& node = target<MapNode>();
+                if (k == "x") set(node.x, v);
+                else if (k == "y") set(node.y, v);
+                else if (k == "symbol" && v.kind == Scalar::STRING && !v.s->empty()) node.symbol = (*v.s)[0];
+                break;
+            }
+            case Ctx::MAP_CHILD: {
+                MapCoord& coord = target<MapCoord>();
+                if (k == "x") set(coord.x, v);
+                else if (k == "y") set(coord.y, v);
+                break;
+            }
+            case Ctx::POWER: {
+                Power& power = target<Power>();
+                if (k == "id") set(power.id, v, powerId);
+                else if (k == "name") set(power.name, v);
+                else if (k == "amount") set(power.amount, v);
+                else if (k == "damage") set(power.damage, v);
+                else if (k == "misc") set(power.misc, v);
+                else if (k == "just_applied") set(power.just_applied, v);
+                break;
+            }
+            case Ctx::ORB: {
+                Orb& orb = target<Orb>();
+                if (k == "id") set(orb.id, v);
+                else if (k == "name") set(orb.name, v);
+                else if (k == "evoke_amount") set(orb.evoke_amount, v);
+                else if (k == "passive_amount") set(orb.passive_amount, v);
+                break;
+            }
+            case Ctx::MONSTER: {
+                Monster& monster = target<Monster>();
+                if (k == "id") set(monster.id, v);
+                else if (k == "name") set(monster.name, v);
+                else if (k == "current_hp") set(monster.current_hp, v);
+                else if (k == "max_hp") set(monster.max_hp, v);
+                else if (k == "block") set(monster.block, v);
+                else if (k == "move_id") set(monster.move_id, v);
+                else if (k == "last_move_id") set(monster.last_move_id, v);
+                else if (k == "second_last_move_id") set(monster.second_last_move_id, v);
+                else if (k == "move_base_damage") set(monster.move_base_damage, v);
+                else if (k == "move_adjusted_damage") set(monster.move_adjusted_damage, v);
+                else if (k == "move_hits") set(monster.move_hits, v);
+                else if (k == "intent") set(monster.intent, v, kIntentNames);
+                else if (k == "half_dead") set(monster.half_dead, v);
+                else if (k == "is_gone") set(monster.is_gone, v);
+                break;
+            }
+            case Ctx::OPTION: {
+                EventOption& option = target<EventOption>();
+                if (k == "label") set(option.label, v);
+                else if (k == "text") set(option.text, v);
+                else if (k == "choice_index") set(option.choice_index, v);
+                else if (k == "disabled") set(option.disabled, v);
+                break;
+            }
+            case Ctx::REWARD: {
+                Reward& reward = target<Reward>();
+                if (k == "reward_type") set(reward.type, v, kRewardTypeNames);
+                else if (k == "gold") set(reward.gold, v);
+                break;
+            }
+            case Ctx::COMMANDS:
+                if (v.kind == Scalar::STRING) {
+                    gs_.available_commands.push_back(intern(*v.s));
+                    gs_.commands |= commandBit(*v.s);
+                } else {
+                    gs_.available_commands.push_back({});
+                }
+                break;
+            case Ctx::REST_OPTIONS:
+                gs_.screen.rest_options.push_back(toEnum<RestOption>(v, kRestOptionNames));
+                break;
+            default:
+                // Scalar inside an object list still occupies an index
+                if (isList(top().ctx)) {
+                    appendElement();
+                }
+                break;
+        }
+        return true;
+    }
+};
+
+template <typename E, size_t N>
+std::string_view enumName(E value, const std::string_view (&names)[N]) {
+    size_t index = static_cast<size_t>(value);
+    return index < N ? names[index] : std::string_view("UNKNOWN");
+}
+
+} // anonymous namespace
+
+std::string_view toString(ScreenType value) { return enumName(value, kScreenTypeNames); }
+std::string_view toString(RoomPhase value) { return enumName(value, kRoomPhaseNames); }
+std::string_view toString(RoomType value) { return enumName(value, kRoomTypeNames); }
+std::string_view toString(PlayerClass value) { return enumName(value, kPlayerClassNames); }
+std::string_view toString(CardType value) { return enumName(value, kCardTypeNames); }
+std::string_view toString(CardRarity value) { return enumName(value, kCardRarityNames); }
+std::string_view toString(Intent value) { return enumName(value, kIntentNames); }
+std::string_view toString(ChestType value) { return enumName(value, kChestTypeNames); }
+std::string_view toString(RewardType value) { return enumName(value, kRewardTypeNames); }
+std::string_view toString(RestOption value) { return enumName(value, kRestOptionNames); }
+
+uint32_t commandBit(std::string_view name) {
+    for (size_t i = 0; i < std::size(kCommandNames); ++i) {
+        if (kCommandNames[i] == name) {
+            return 1u << i;
+        }
+    }
+    return Command::OTHER;
+}
+
+void CombatState::clear() {
+    player = Player();
+    monsters.clear();
+    hand.clear();
+    draw_pile.clear();
+    discard_pile.clear();
+    exhaust_pile.clear();
+    limbo.clear();
+    powers.clear();
+    orbs.clear();
+    card_in_play = Card();
+    has_card_in_play = false;
+    turn = 0;
+    cards_discarded_this_turn = 0;
+}
+
+void ScreenState::clear() {
+    screen_type = ScreenType::NONE;
+    event_name = {};
+    event_id = {};
+    body_text = {};
+    options.clear();
+    chest_type = ChestType::UNKNOWN;
+    chest_open = false;
+    has_rested = false;
+    rest_options.clear();
+    cards.clear();
+    selected_cards.clear();
+    can_bowl = false;
+    can_skip = false;
+    rewards.clear();
+    current_node = MapNode();
+    has_current_node = false;
+    next_nodes.clear();
+    boss_available = false;
+    relics.clear();
+    potions.clear();
+    purge_available = false;
+    purge_cost = 0;
+    num_cards = 0;
+    any_number = false;
+    confirm_up = false;
+    for_upgrade = false;
+    for_transform = false;
+    for_purge = false;
+    can_pick_zero = false;
+    score = 0;
+    victory = false;
+}
+
+bool GameState::hasCommand(std::string_view command) const {
+    uint32_t bit = commandBit(command);
+    if (bit != Command::OTHER) {
+        return (commands & bit) != 0;
+    }
+    for (const auto& ref : available_commands) {
+        if (str(ref) == command) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GameState::clear() {
+    state_version = 0;
+    last_action_id = 0;
+    in_game = false;
+    ready_for_command = false;
+    available_commands.clear();
+    commands = 0;
+    has_game_state = false;
+    current_action = {};
+    current_hp = 0;
+    max_hp = 0;
+    floor = 0;
+    act = 0;
+    gold = 0;
+    seed = 0;
+    ascension_level = 0;
+    act_boss = {};
+    character = PlayerClass::UNKNOWN;
+    screen_type = ScreenType::NONE;
+    room_phase = RoomPhase::UNKNOWN;
+    room_type = RoomType::UNKNOWN;
+    is_screen_up = false;
+    choice_available = false;
+    relics.clear();
+    deck.clear();
+    potions.clear();
+    map.clear();
+    map_children.clear();
+    in_combat = false;
+    combat.clear();
+    screen.clear();
+    strings.clear();
+}
+
+void parseGameState(const json& state, GameState& out, uint32_t sections) {
+    out.clear();
+
+    out.state_version = static_cast<uint64_t>(getInt64(state, "state_version"));
+    out.last_action_id = static_cast<uint64_t>(getInt64(state, "last_action_id"));
+    out.in_game = getBool(state, "in_game");
+    out.ready_for_command = getBool(state, "ready_for_command");
+    for (const auto& command : getArray(state, "available_commands")) {
+        out.available_commands.push_back(intern(out, command));
+        if (command.is_string()) {
+            out.commands |= commandBit(command.get_ref<const std::string&>());
+        }
+    }
+
+    const json* game_state = field(state, "game_state");
+    out.has_game_state = game_state && game_state->is_object();
+    if (!out.has_game_state) {
+        return;
+    }
+    const json& gs = *game_state;
+
+    out.current_action = getStr(out, gs, "current_action");
+    out.current_hp = getInt(gs, "current_hp");
+    out.max_hp = getInt(gs, "max_hp");
+    out.floor = getInt(gs, "floor");
+    out.act = getInt(gs, "act");
+    out.gold = getInt(gs, "gold");
+    out.seed = getInt64(gs, "seed");
+    out.ascension_level = getInt(gs, "ascension_level");
+    out.act_boss = getStr(out, gs, "act_boss");
+    out.character = getEnum<PlayerClass>(gs, "character", kPlayerClassNames);
+    out.screen_type = field(gs, "screen_type") ? getEnum<ScreenType>(gs, "screen_type", kScreenTypeNames)
+                                                : ScreenType::NONE;
+    out.room_phase = getEnum<RoomPhase>(gs, "room_phase", kRoomPhaseNames);
+    out.room_type = getEnum<RoomType>(gs, "room_type", kRoomTypeNames);
+    out.is_screen_up = getBool(gs, "is_screen_up");
+    out.choice_available = getBool(gs, "choice_available");
+
+    if (sections & StateSections::ITEMS) {
+        parseRelics(getArray(gs, "relics"), out, out.relics);
+        parsePotions(getArray(gs, "potions"), out, out.potions);
+    }
+    if (sections & StateSections::DECK) {
+        parseCards(getArray(gs, "deck"), out, out.deck);
+    }
+    if (sections & StateSections::MAP) {
+        parseMapNodes(getArray(gs, "map"), out, out.map);
+    }
+
+    const json* combat_state = field(gs, "combat_state");
+    out.in_combat = (sections & StateSections::COMBAT) && combat_state && combat_state->is_object();
+    if (out.in_combat) {
+        parseCombat(*combat_state, out);
+    }
+
+    const json* screen = field(gs, "screen");
+    if ((sections & StateSections::SCREEN) && screen && screen->is_object()) {
+        parseScreen(*screen, out);
+    }
+}
+
+bool parseGameStateBody(std::string_view body, GameState& out, uint32_t sections, WireFormat format) {
+    json::input_format_t input_format = json::input_format_t::json;
+    if (format == WireFormat::MSGPACK) {
+        input_format = json::input_format_t::msgpack;
+    } else if (format == WireFormat::CBOR) {
+        input_format = json::input_format_t::cbor;
+    }
+
+    out.clear();
+    GameStateSax sax(out, sections);
+    if (!json::sax_parse(body.begin(), body.end(), &sax, input_format)) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+} // namespace spirecomm
@@ -0,0 +1,129 @@
+#include "spirecomm/ids.hpp"
+#include <array>
+#include <bit>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace spirecomm {
+
+namespace {
+
+static_assert(std::is_sorted(std::begin(kKnownCardIds), std::end(kKnownCardIds)));
+static_assert(std::is_sorted(std::begin(kKnownRelicIds), std::end(kKnownRelicIds)));
+static_assert(std::is_sorted(std::begin(kKnownPotionIds), std::end(kKnownPotionIds)));
+static_assert(std::is_sorted(std::begin(kKnownPowerIds), std::end(kKnownPowerIds)));
+
+constexpr uint32_t hashId(std::string_view id) {
+    uint32_t hash = 2166136261u;  // FNV-1a
+    for (char c : id) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+// Open-addressed hash of a known table, built at compile time; slots hold ID (0 = empty)
+template <size_t N>
+struct KnownTable {
+    static constexpr size_t kSlots = std::bit_ceil(N * 2);
+
+    const std::string_view* names;
+    std::array<uint16_t, kSlots> slots{};
+
+    constexpr explicit KnownTable(const std::string_view (&table)[N]) : names(table) {
+        for (size_t i = 0; i < N; ++i) {
+            size_t slot = hashId(table[i]) & (kSlots - 1);
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & (kSlots - 1);
+            }
+            slots[slot] = static_cast<uint16_t>(i + 1);
+        }
+    }
+
+    uint16_t find(std::string_view id) const {
+        for (size_t slot = hashId(id) & (kSlots - 1); slots[slot] != 0; slot = (slot + 1) & (kSlots - 1)) {
+            if (names[slots[slot] - 1] == id) {
+                return slots[slot];
+            }
+        }
+        return 0;
+    }
+};
+
+constexpr KnownTable kCards(kKnownCardIds);
+constexpr KnownTable kRelics(kKnownRelicIds);
+constexpr KnownTable kPotions(kKnownPotionIds);
+constexpr KnownTable kPowers(kKnownPowerIds);
+
+// IDs interned for one kind, numbered from first (the table size + 1)
+class Interner {
+public:
+    explicit Interner(size_t first) : first(first) {}
+
+    uint16_t find(std::string_view id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = ids.find(id);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        if (first + names.size() > UINT16_MAX) {
+            return 0;
+        }
+        // Deque elements never move, so keys can view them
+        const std::string& name = names.emplace_back(id);
+        uint16_t number = static_cast<uint16_t>(first + names.size() - 1);
+        ids.emplace(name, number);
+        return number;
+    }
+
+    std::string_view name(uint16_t number) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t index = number - first;
+        return index < names.size() ? std::string_view(names[index]) : std::string_view();
+    }
+
+private:
+    const size_t first;
+    std::mutex mutex;
+    std::unordered_map<std::string_view, uint16_t> ids;
+    std::deque<std::string> names;
+};
+
+// Function statics, so IDs can be looked up during static initialization
+Interner& cardInterner() { static Interner interner(std::size(kKnownCardIds) + 1); return interner; }
+Interner& relicInterner() { static Interner interner(std::size(kKnownRelicIds) + 1); return interner; }
+Interner& potionInterner() { static Interner interner(std::size(kKnownPotionIds) + 1); return interner; }
+Interner& powerInterner() { static Interner interner(std::size(kKnownPowerIds) + 1); return interner; }
+
+template <typename Id, size_t N>
+Id lookup(const KnownTable<N>& known, Interner& interner, std::string_view id) {
+    if (id.empty()) {
+        return Id::NONE;
+    }
+    uint16_t number = known.find(id);
+    return static_cast<Id>(number != 0 ? number : interner.find(id));
+}
+
+template <typename Id, size_t N>
+std::string_view name(const std::string_view (&table)[N], Interner& interner, Id id) {
+    uint16_t number = static_cast<uint16_t>(id);
+    if (number == 0) {
+        return {};
+    }
+    return number <= N ? table[number - 1] : interner.name(number);
+}
+
+} // anonymous namespace
+
+CardId cardId(std::string_view id) { return lookup<CardId>(kCards, cardInterner(), id); }
+RelicId relicId(std::string_view id) { return lookup<RelicId>(kRelics, relicInterner(), id); }
+PotionId potionId(std::string_view id) { return lookup<PotionId>(kPotions, potionInterner(), id); }
+PowerId powerId(std::string_view id) { return lookup<PowerId>(kPowers, powerInterner(), id); }
+
+std::string_view toString(CardId id) { return name(kKnownCardIds, cardInterner(), id); }
+std::string_view toString(RelicId id) { return name(kKnownRelicIds, relicInterner(), id); }
+std::string_view toString(PotionId id) { return name(kKnownPotionIds, potionInterner(), id); }
+std::string_view toString(PowerId id) { return name(kKnownPowerIds, powerInterner(), id); }
+
+} // namespace spirecomm
@@ -0,0 +1,200 @@
+#include "spirecomm/legal_actions.hpp"
+
+namespace spirecomm {
+
+namespace {
+
+void add(std::vector<LegalAction>& out, ActionKind kind, size_t index = static_cast<size_t>(-1), int target = -1) {
+    LegalAction action;
+    action.kind = kind;
+    action.index = static_cast<int16_t>(index);
+    action.target = static_cast<int16_t>(target);
+    out.push_back(action);
+}
+
+// One entry per targetable monster, or a single untargeted one
+void addTargeted(std::vector<LegalAction>& out, const GameState& state, ActionKind kind, size_t index, bool has_target) {
+    if (!has_target) {
+        add(out, kind, index);
+        return;
+    }
+    const auto& monsters = state.combat.monsters;
+    for (size_t m = 0; m < monsters.size(); ++m) {
+        if (monsters[m].isTargetable()) {
+            add(out, kind, index, static_cast<int>(m));
+        }
+    }
+}
+
+void addChoices(const GameState& state, std::vector<LegalAction>& out) {
+    const ScreenState& screen = state.screen;
+    switch (state.screen_type) {
+        case ScreenType::EVENT:
+            for (size_t i = 0; i < screen.options.size(); ++i) {
+                if (!screen.options[i].disabled) {
+                    add(out, ActionKind::EVENT_OPTION, i);
+                }
+            }
+            break;
+        case ScreenType::MAP:
+            for (size_t i = 0; i < screen.next_nodes.size(); ++i) {
+                add(out, ActionKind::MAP_NODE, i);
+            }
+            if (screen.boss_available) {
+                add(out, ActionKind::MAP_BOSS);
+            }
+            break;
+        case ScreenType::COMBAT_REWARD:
+            for (size_t i = 0; i < screen.rewards.size(); ++i) {
+                add(out, ActionKind::COMBAT_REWARD, i);
+            }
+            break;
+        case ScreenType::CARD_REWARD:
+            for (size_t i = 0; i < screen.cards.size(); ++i) {
+                add(out, ActionKind::CARD_REWARD, i);
+            }
+            if (screen.can_bowl) {
+                add(out, ActionKind::SINGING_BOWL);
+            }
+            break;
+        case ScreenType::BOSS_REWARD:
+            for (size_t i = 0; i < screen.relics.size(); ++i) {
+                add(out, ActionKind::BOSS_REWARD, i);
+            }
+            break;
+        case ScreenType::SHOP_SCREEN:
+            for (size_t i = 0; i < screen.cards.size(); ++i) {
+                if (screen.cards[i].price <= state.gold) {
+                    add(out, ActionKind::BUY_CARD, i);
+                }
+            }
+            for (size_t i = 0; i < screen.relics.size(); ++i) {
+                if (screen.relics[i].price <= state.gold) {
+                    add(out, ActionKind::BUY_RELIC, i);
+                }
+            }
+            for (size_t i = 0; i < screen.potions.size(); ++i) {
+                if (screen.potions[i].price <= state.gold) {
+                    add(out, ActionKind::BUY_POTION, i);
+                }
+            }
+            if (screen.purge_available && screen.purge_cost <= state.gold) {
+                add(out, ActionKind::BUY_PURGE);
+            }
+            break;
+        case ScreenType::REST:
+            for (size_t i = 0; i < screen.rest_options.size(); ++i) {
+                if (screen.rest_options[i] != RestOption::UNKNOWN) {
+                    add(out, ActionKind::REST, i);
+                }
+            }
+            break;
+        case ScreenType::CHEST:
+            if (!screen.chest_open) {
+                add(out, ActionKind::OPEN_CHEST);
+            }
+            break;
+        case ScreenType::GRID:
+        case ScreenType::HAND_SELECT:
+            for (size_t i = 0; i < screen.cards.size(); ++i) {
+                add(out, ActionKind::CHOOSE, i);
+            }
+            break;
+        default:
+            // Choice list not in the typed state
+            add(out, ActionKind::CHOOSE, 0);
+            break;
+    }
+}
+
+} // anonymous namespace
+
+Action LegalAction::toAction(const GameState& state) const {
+    const ScreenState& screen = state.screen;
+    switch (kind) {
+        case ActionKind::PLAY_CARD:
+            return target >= 0 ? Action::playCard(index, target) : Action::playCard(index);
+        case ActionKind::END_TURN:
+            return Action::endTurn();
+        case ActionKind::USE_POTION:
+            return target >= 0 ? Action::usePotion(index, target) : Action::usePotion(index);
+        case ActionKind::DISCARD_POTION:
+            return Action::discardPotion(index);
+        case ActionKind::PROCEED:
+            return Action::proceed();
+        case ActionKind::CANCEL:
+            return Action::cancel();
+        case ActionKind::CHOOSE:
+            return Action::choose(index);
+        case ActionKind::EVENT_OPTION: {
+            int32_t choice = screen.options[index].choice_index;
+            return Action::eventOption(choice >= 0 ? choice : index);
+        }
+        case ActionKind::MAP_NODE:
+            return Action::chooseMapNode(screen.next_nodes[index].x, screen.next_nodes[index].y);
+        case ActionKind::MAP_BOSS:
+            return Action::chooseMapBoss();
+        case ActionKind::COMBAT_REWARD:
+            return Action::combatReward(index);
+        case ActionKind::CARD_REWARD:
+            return Action::cardReward(state.str(screen.cards[index].name));
+        case ActionKind::SINGING_BOWL:
+            return Action::cardReward("", true);
+        case ActionKind::BOSS_REWARD:
+            return Action::bossReward(state.str(screen.relics[index].name));
+        case ActionKind::BUY_CARD:
+            return Action::buyCard(state.str(screen.cards[index].name));
+        case ActionKind::BUY_RELIC:
+            return Action::buyRelic(state.str(screen.relics[index].name));
+        case ActionKind::BUY_POTION:
+            return Action::buyPotion(state.str(screen.potions[index].name));
+        case ActionKind::BUY_PURGE:
+            return Action::buyPurge();
+        case ActionKind::REST:
+            return Action::rest(toString(screen.rest_options[index]));
+        case ActionKind::OPEN_CHEST:
+            return Action::openChest();
+    }
+    return Action::proceed();
+}
+
+void enumerateLegalActions(const GameState& state, std::vector<LegalAction>& out) {
+    out.clear();
+    if (!state.ready_for_command) {
+        return;
+    }
+
+    if (state.in_combat && state.hasCommand(Command::PLAY)) {
+        const auto& hand = state.combat.hand;
+        for (size_t i = 0; i < hand.size(); ++i) {
+            if (hand[i].is_playable) {
+                addTargeted(out, state, ActionKind::PLAY_CARD, i, hand[i].has_target);
+            }
+        }
+    }
+    if (state.hasCommand(Command::END)) {
+        add(out, ActionKind::END_TURN);
+    }
+    if (state.hasCommand(Command::POTION)) {
+        for (size_t i = 0; i < state.potions.size(); ++i) {
+            const Potion& potion = state.potions[i];
+            if (potion.can_use && (state.in_combat || !potion.requires_target)) {
+                addTargeted(out, state, ActionKind::USE_POTION, i, potion.requires_target);
+            }
+            if (potion.can_discard) {
+                add(out, ActionKind::DISCARD_POTION, i);
+            }
+        }
+    }
+    if (state.hasCommand(Command::CHOOSE)) {
+        addChoices(state, out);
+    }
+    if (state.hasCommand(Command::PROCEED | Command::CONFIRM)) {
+        add(out, ActionKind::PROCEED);
+    }
+    if (state.hasCommand(Command::CANCEL | Command::RETURN | Command::SKIP | Command::LEAVE)) {
+        add(out, ActionKind::CANCEL);
+    }
+}
+
+} // namespace spirecomm
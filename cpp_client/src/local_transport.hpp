@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace spirecomm {
+
+/**
+ * Backend that hands SpireCommClient states in place instead of over HTTP
+ * (internal to the library): the shared-memory ring (ShmTransport) and
+ * recorded traces (ReplayTransport)
+ *
+ * A state is read by taking latest(), parsing its body straight out of the
+ * transport's memory, and then checking stillValid(): if the body may have
+ * been overwritten meanwhile, whatever was parsed has to be read again.
+ */
+class LocalTransport {
+public:
+    // Newest state record, pointing into the transport's memory
+    struct StateView {
+        uint64_t version = 0;
+        uint64_t position = 0;  // Where the record is, for stillValid()
+        std::string_view body;  // JSON /state body
+    };
+
+    virtual ~LocalTransport() = default;
+
+    /**
+     * Map the file and check its header
+     * @param path File to open
+     * @param error Set to the reason on failure
+     * @return true if the transport is usable
+     */
+    virtual bool open(const std::string& path, std::string& error) = 0;
+
+    /**
+     * Wait until the newest state is past since_version
+     * @return Newest version (equal to or below since_version on timeout)
+     */
+    virtual uint64_t waitForVersion(uint64_t since_version, int timeout_ms) = 0;
+
+    /**
+     * Get the newest state record
+     * @return false if there is no state yet
+     */
+    virtual bool latest(StateView& view) const = 0;
+
+    /**
+     * Check that a record handed out by latest() has not been overwritten
+     */
+    virtual bool stillValid(const StateView& view) const = 0;
+
+    /**
+     * Send an /action body
+     * @param timeout_ms How long to wait for the other side, if it has to make room
+     * @param error Set to the reason on failure
+     * @param action_id If given, set to the id the action was queued under
+     *        (see ClientConfig and executeAndWait(); 0 means any later state)
+     * @return false if the action could not be sent
+     */
+    virtual bool pushAction(std::string_view body, int timeout_ms, std::string& error,
+                            uint64_t* action_id = nullptr) = 0;
+
+    /**
+     * Check whether no newer state will ever arrive (the end of a replay)
+     */
+    virtual bool exhausted() const { return false; }
+};
+
+} // namespace spirecomm
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace spirecomm {
+
+/**
+ * Whole-file memory mapping (internal to the library)
+ * Shared with other processes when writable; unmapped on destruction.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Map an existing file
+     * @param path File to map
+     * @param writable Map read-write (shared) instead of read-only
+     * @param error Set to the reason on failure
+     * @return true if mapped (empty files cannot be mapped)
+     */
+    bool open(const std::string& path, bool writable, std::string& error);
+
+    void close();
+
+    bool isOpen() const { return base != nullptr; }
+    unsigned char* data() const { return base; }
+    size_t size() const { return mapped_size; }
+
+private:
+    unsigned char* base = nullptr;
+    size_t mapped_size = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+};
+
+} // namespace spirecomm
@@ -0,0 +1,521 @@
+#include "spirecomm/search.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace spirecomm {
+
+namespace {
+
+// Iterations a worker runs on a tree before requeueing it
+constexpr int kSliceIterations = 64;
+
+// Longest line selected within one turn
+constexpr size_t kMaxDepth = 48;
+
+// Every (card, target) pair plus END
+constexpr size_t kMaxMoves = CombatSim::kMaxHand * CombatSim::kMaxMonsters + 1;
+
+// Plan steps backed by fewer visits are left for the next search
+constexpr uint64_t kMinPlanVisits = 8;
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t splitmix(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+bool sameCard(const SimCard& a, const SimCard& b) {
+    return a.id == b.id && a.cost == b.cost && a.type == b.type && a.flags == b.flags;
+}
+
+// Play identified by card rather than hand index, see CombatSearch
+struct Move {
+    SimCard card;
+    int8_t target = -1;
+    bool end = false;
+
+    bool operator==(const Move& other) const {
+        return end == other.end && target == other.target && (end || sameCard(card, other.card));
+    }
+};
+
+using MoveList = std::array<Move, kMaxMoves>;
+
+// First hand index holding the move's card, -1 if there is none or it cannot be played
+int handIndex(const CombatSim& sim, const Move& move) {
+    for (size_t i = 0; i < sim.hand.size(); ++i) {
+        if (sameCard(sim.hand[i], move.card) && sim.canPlay(static_cast<int>(i), move.target)) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// Distinct modelled plays followed by END
+size_t legalMoves(const CombatSim& sim, MoveList& moves, bool* skipped_unsupported = nullptr) {
+    size_t count = 0;
+    for (size_t i = 0; i < sim.hand.size(); ++i) {
+        const SimCard& card = sim.hand[i];
+        bool duplicate = false;
+        for (size_t j = 0; j < i && !duplicate; ++j) {
+            duplicate = sameCard(sim.hand[j], card);
+        }
+        if (duplicate) {
+            continue;
+        }
+        int first_target = card.is(SimCard::TARGETED) ? 0 : -1;
+        int last_target = card.is(SimCard::TARGETED) ? sim.num_monsters - 1 : -1;
+        for (int target = first_target; target <= last_target; ++target) {
+            if (!sim.canPlay(static_cast<int>(i), target)) {
+                continue;
+            }
+            if (card.id == SimCardId::UNKNOWN) {
+                if (skipped_unsupported) {
+                    *skipped_unsupported = true;
+                }
+                break;
+            }
+            moves[count].card = card;
+            moves[count].target = static_cast<int8_t>(target);
+            moves[count].end = false;
+            ++count;
+        }
+    }
+    moves[count] = Move();
+    moves[count].end = true;
+    return count + 1;
+}
+
+SimStatus apply(CombatSim& sim, const Move& move) {
+    if (move.end) {
+        return sim.endTurn();
+    }
+    int index = handIndex(sim, move);
+    if (index < 0) {
+        return SimStatus::ILLEGAL;
+    }
+    return sim.playCard(index, move.target);
+}
+
+int32_t monsterHp(const CombatSim& sim) {
+    int32_t total = 0;
+    for (size_t i = 0; i < sim.num_monsters; ++i) {
+        if (!sim.monsters[i].is_gone) {
+            total += std::max(sim.monsters[i].hp, 0);
+        }
+    }
+    return total;
+}
+
+struct Node {
+    Move move;
+    uint32_t first_child = 0;
+    uint16_t num_children = 0;
+    bool expanded = false;
+    uint32_t visits = 0;
+    double value = 0;    // Sum of scores backed up through this node
+};
+
+// One root-parallel tree; only the worker currently holding its task touches it
+struct Tree {
+    std::vector<Node> nodes;   // Arena, nodes[0] is the root; capacity is kept between searches
+    uint64_t rng = 0;
+};
+
+} // anonymous namespace
+
+// PIMPL implementation
+struct CombatSearch::Impl {
+    // Worker thread with its own queue of trees (indices into trees)
+    struct Worker {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+        std::thread thread;
+    };
+
+    SearchConfig config;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<Tree> trees;
+    uint64_t searches = 0;
+
+    // Current search, written by search() before any task is queued
+    const CombatSim* root = nullptr;
+    int32_t root_monster_hp = 0;
+    int64_t deadline_ns = 0;
+    std::atomic<uint64_t> iterations{0};
+    std::atomic<uint64_t> steals{0};
+    std::atomic<size_t> pending{0};   // Trees still being searched
+
+    std::atomic<bool> stopping{false};
+    std::atomic<size_t> queued{0};    // Tasks waiting in any worker queue
+
+    // Idle workers sleep here
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+
+    // search() waits here for the last tree
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+
+    Impl(const SearchConfig& cfg) : config(cfg) {
+        size_t threads = config.num_threads > 0 ? static_cast<size_t>(config.num_threads)
+                                                : std::max(1u, std::thread::hardware_concurrency());
+        size_t num_trees = config.num_trees > 0 ? static_cast<size_t>(config.num_trees) : threads;
+        trees.resize(num_trees);
+        for (size_t i = 0; i < threads; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workers[i]->thread = std::thread([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            stopping.store(true);
+        }
+        idle_cv.notify_all();
+        for (auto& worker : workers) {
+            worker->thread.join();
+        }
+    }
+
+    void push(size_t worker, size_t task) {
+        {
+            std::lock_guard<std::mutex> lock(workers[worker]->mutex);
+            workers[worker]->tasks.push_back(task);
+        }
+        {
+            // Taken so the increment cannot slip between an idle worker's check and its wait
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            queued.fetch_add(1);
+        }
+        idle_cv.notify_one();
+    }
+
+    // Own queue is served oldest first, so every tree gets its turn
+    bool popLocal(size_t worker, size_t& task) {
+        std::lock_guard<std::mutex> lock(workers[worker]->mutex);
+        auto& tasks = workers[worker]->tasks;
+        if (tasks.empty()) {
+            return false;
+        }
+        task = tasks.front();
+        tasks.pop_front();
+        queued.fetch_sub(1);
+        return true;
+    }
+
+    // Thieves take from the back, away from the owner
+    bool steal(size_t thief, size_t& task) {
+        for (size_t offset = 1; offset < workers.size(); ++offset) {
+            Worker& victim = *workers[(thief + offset) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.back();
+                victim.tasks.pop_back();
+                queued.fetch_sub(1);
+                steals.fetch_add(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool outOfBudget() const {
+        if (config.max_iterations > 0 && iterations.load(std::memory_order_relaxed) >= config.max_iterations) {
+            return true;
+        }
+        return nowNs() >= deadline_ns;
+    }
+
+    // Score in [0, 1]: 0 for a loss, above 0.6 for a win
+    double score(const CombatSim& sim) const {
+        if (sim.lost()) {
+            return 0.0;
+        }
+        double hp = static_cast<double>(sim.player.hp) / std::max(sim.player.max_hp, 1);
+        if (sim.won()) {
+            return 0.6 + 0.4 * hp;
+        }
+        double dealt = 1.0 - static_cast<double>(monsterHp(sim)) / std::max(root_monster_hp, 1);
+        return 0.3 * hp + 0.3 * dealt;
+    }
+
+    // Uniformly random modelled plays (END included); the baseline policy
+    void rollout(CombatSim& sim, uint64_t& rng) const {
+        MoveList moves;
+        int turns = 0;
+        while (!sim.isOver() && turns <= config.rollout_turns) {
+            size_t count = legalMoves(sim, moves);
+            const Move& move = moves[splitmix(rng) % count];
+            if (move.end) {
+                ++turns;
+            }
+            if (apply(sim, move) != SimStatus::OK) {
+                sim.endTurn();
+                ++turns;
+            }
+        }
+    }
+
+    // Children are created together so they are contiguous in the arena
+    void expand(Tree& tree, uint32_t index, const CombatSim& sim) {
+        MoveList moves;
+        size_t count = legalMoves(sim, moves);
+        tree.nodes[index].expanded = true;
+        if (tree.nodes.size() + count > config.max_nodes) {
+            return;
+        }
+        tree.nodes[index].first_child = static_cast<uint32_t>(tree.nodes.size());
+        tree.nodes[index].num_children = static_cast<uint16_t>(count);
+        for (size_t i = 0; i < count; ++i) {
+            Node child;
+            child.move = moves[i];
+            tree.nodes.push_back(child);
+        }
+    }
+
+    // UCT over the children that are legal in this iteration's state
+    int64_t select(const Tree& tree, const Node& parent, const CombatSim& sim) const {
+        int64_t best = -1;
+        double best_ucb = -1.0;
+        double log_visits = std::log(static_cast<double>(std::max(parent.visits, 1u)));
+        for (uint32_t i = 0; i < parent.num_children; ++i) {
+            uint32_t index = parent.first_child + i;
+            const Node& child = tree.nodes[index];
+            if (!child.move.end && handIndex(sim, child.move) < 0) {
+                continue;
+            }
+            if (child.visits == 0) {
+                return index;
+            }
+            double ucb = child.value / child.visits
+                       + config.exploration * std::sqrt(log_visits / child.visits);
+            if (ucb > best_ucb) {
+                best_ucb = ucb;
+                best = index;
+            }
+        }
+        return best;
+    }
+
+    void iterate(Tree& tree, CombatSim& sim) {
+        sim = *root;
+        sim.rng = splitmix(tree.rng) | 1;
+
+        std::array<uint32_t, kMaxDepth + 1> path;
+        size_t depth = 0;
+        path[0] = 0;
+        while (depth < kMaxDepth && !sim.isOver()) {
+            Node& node = tree.nodes[path[depth]];
+            if (depth > 0 && node.move.end) {
+                break;  // The tree covers the current turn; rollouts cover the rest
+            }
+            if (!node.expanded) {
+                if (depth > 0 && node.visits == 0) {
+                    break;
+                }
+                expand(tree, path[depth], sim);
+            }
+            int64_t child = select(tree, tree.nodes[path[depth]], sim);
+            if (child < 0 || apply(sim, tree.nodes[static_cast<size_t>(child)].move) != SimStatus::OK) {
+                break;
+            }
+            path[++depth] = static_cast<uint32_t>(child);
+        }
+
+        rollout(sim, tree.rng);
+        double value = score(sim);
+        for (size_t i = 0; i <= depth; ++i) {
+            Node& node = tree.nodes[path[i]];
+            ++node.visits;
+            node.value += value;
+        }
+        iterations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void workerLoop(size_t worker) {
+        CombatSim scratch;
+        while (true) {
+            size_t task;
+            if (!popLocal(worker, task) && !steal(worker, task)) {
+                std::unique_lock<std::mutex> lock(idle_mutex);
+                idle_cv.wait(lock, [this] { return stopping.load() || queued.load() > 0; });
+                if (stopping.load()) {
+                    return;
+                }
+                continue;
+            }
+
+            for (int i = 0; i < kSliceIterations && !outOfBudget(); ++i) {
+                iterate(trees[task], scratch);
+            }
+            if (!outOfBudget()) {
+                push(worker, task);
+            } else if (pending.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(done_mutex);
+                done_cv.notify_all();
+            }
+        }
+    }
+
+    // Sum the trees' statistics along the chosen line and turn it into actions
+    void extractPlan(SearchResult& result) {
+        std::vector<uint32_t> cursors(trees.size(), 0);
+        std::vector<bool> live(trees.size(), true);
+        CombatSim plan = *root;
+
+        while (true) {
+            struct Candidate {
+                Move move;
+                uint64_t visits = 0;
+                double value = 0;
+            };
+            std::vector<Candidate> candidates;
+            for (size_t t = 0; t < trees.size(); ++t) {
+                if (!live[t]) {
+                    continue;
+                }
+                const Node& node = trees[t].nodes[cursors[t]];
+                for (uint32_t i = 0; i < node.num_children; ++i) {
+                    const Node& child = trees[t].nodes[node.first_child + i];
+                    auto it = std::find_if(candidates.begin(), candidates.end(),
+                                           [&](const Candidate& c) { return c.move == child.move; });
+                    if (it == candidates.end()) {
+                        candidates.push_back({child.move, 0, 0});
+                        it = candidates.end() - 1;
+                    }
+                    it->visits += child.visits;
+                    it->value += child.value;
+                }
+            }
+            auto best = std::max_element(candidates.begin(), candidates.end(),
+                                         [](const Candidate& a, const Candidate& b) { return a.visits < b.visits; });
+            if (best == candidates.end() || best->visits == 0
+                || (!result.actions.empty() && best->visits < kMinPlanVisits)) {
+                return;
+            }
+            if (result.actions.empty()) {
+                result.value = best->value / static_cast<double>(best->visits);
+            }
+
+            if (best->move.end) {
+                result.actions.push_back(Action::endTurn());
+                return;
+            }
+            int index = handIndex(plan, best->move);
+            if (index < 0) {
+                return;
+            }
+            result.actions.push_back(best->move.target >= 0 ? Action::playCard(index, best->move.target)
+                                                            : Action::playCard(index));
+            uint64_t rng_before = plan.rng;
+            plan.playCard(index, best->move.target);
+            if (plan.rng != rng_before || plan.isOver()) {
+                return;  // What follows depends on a draw or random target
+            }
+
+            for (size_t t = 0; t < trees.size(); ++t) {
+                if (!live[t]) {
+                    continue;
+                }
+                const Node& node = trees[t].nodes[cursors[t]];
+                live[t] = false;
+                for (uint32_t i = 0; i < node.num_children; ++i) {
+                    if (trees[t].nodes[node.first_child + i].move == best->move) {
+                        cursors[t] = node.first_child + i;
+                        live[t] = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Constructor
+CombatSearch::CombatSearch(const SearchConfig& config)
+    : pImpl(std::make_unique<Impl>(config)) {}
+
+// Destructor
+CombatSearch::~CombatSearch() = default;
+
+size_t CombatSearch::numThreads() const {
+    return pImpl->workers.size();
+}
+
+SearchResult CombatSearch::search(const GameState& state) {
+    CombatSim sim;
+    SearchResult result;
+    result.status = sim.load(state, pImpl->config.seed + pImpl->searches, &result.error);
+    if (result.status != SimStatus::OK) {
+        return result;
+    }
+    return search(sim);
+}
+
+SearchResult CombatSearch::search(const CombatSim& root) {
+    SearchResult result;
+    if (root.isOver()) {
+        result.error = "Combat is over";
+        return result;
+    }
+    int64_t start_ns = nowNs();
+
+    // Only END: nothing to search
+    MoveList moves;
+    size_t count = legalMoves(root, moves, &result.skipped_unsupported);
+    if (count == 1) {
+        result.status = SimStatus::OK;
+        result.actions.push_back(Action::endTurn());
+        return result;
+    }
+
+    Impl& impl = *pImpl;
+    uint64_t seed = impl.config.seed ^ (++impl.searches * 0xD1B54A32D192ED03ull);
+    for (Tree& tree : impl.trees) {
+        tree.nodes.clear();
+        tree.nodes.emplace_back();
+        tree.rng = splitmix(seed);
+    }
+    impl.root = &root;
+    impl.root_monster_hp = monsterHp(root);
+    impl.deadline_ns = start_ns + static_cast<int64_t>(impl.config.budget_ms) * 1000000;
+    impl.iterations.store(0);
+    impl.steals.store(0);
+    impl.pending.store(impl.trees.size());
+    for (size_t i = 0; i < impl.trees.size(); ++i) {
+        impl.push(i % impl.workers.size(), i);
+    }
+    {
+        std::unique_lock<std::mutex> lock(impl.done_mutex);
+        impl.done_cv.wait(lock, [&impl] { return impl.pending.load() == 0; });
+    }
+
+    impl.extractPlan(result);
+    result.status = result.actions.empty() ? SimStatus::ILLEGAL : SimStatus::OK;
+    result.iterations = impl.iterations.load();
+    result.steals = impl.steals.load();
+    for (const Tree& tree : impl.trees) {
+        result.nodes += tree.nodes.size();
+    }
+    result.elapsed_ms = static_cast<double>(nowNs() - start_ns) / 1e6;
+    return result;
+}
+
+} // namespace spirecomm
@@ -0,0 +1,216 @@
+#include "shm_transport.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace spirecomm {
+
+namespace {
+
+// Header field offsets; writer-owned positions sit on separate cache lines
+constexpr size_t kMagicOffset = 0;
+constexpr size_t kLayoutOffset = 4;
+constexpr size_t kStateCapacityOffset = 8;
+constexpr size_t kActionCapacityOffset = 16;
+constexpr size_t kStateReserveOffset = 64;        // End of the record being written
+constexpr size_t kStateCommitOffset = 72;         // End of the last complete record
+constexpr size_t kStateLatestOffset = 80;         // Start of the last complete record
+constexpr size_t kStateLatestVersionOffset = 88;  // Version of that record
+constexpr size_t kActionWriteOffset = 128;        // Written by the client
+constexpr size_t kActionReadOffset = 192;         // Written by the server
+constexpr size_t kHeaderSize = 256;
+
+// Record: u32 length, u32 reserved, u64 version, body, padded to 8 bytes
+constexpr size_t kRecordHeaderSize = 16;
+constexpr uint32_t kWrapMarker = 0xFFFFFFFF;  // Rest of the ring is unused, continue at the start
+
+uint64_t recordSize(size_t body_size) {
+    return (kRecordHeaderSize + body_size + 7) & ~uint64_t{7};
+}
+
+// Spin briefly, then yield, then sleep in growing steps up to 1ms
+class Backoff {
+public:
+    void pause() {
+        if (rounds < 64) {
+            ++rounds;
+        } else if (rounds < 128) {
+            ++rounds;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(sleep_us));
+            sleep_us = sleep_us < 1000 ? sleep_us * 2 : 1000;
+        }
+    }
+
+private:
+    int rounds = 0;
+    int sleep_us = 16;
+};
+
+} // anonymous namespace
+
+bool ShmTransport::open(const std::string& path, std::string& error) {
+    if (!file.open(path, true, error)) {
+        return false;
+    }
+    if (file.size() < kHeaderSize) {
+        error = "Not a SpireComm shared-memory file: " + path;
+        file.close();
+        return false;
+    }
+
+    const unsigned char* base = file.data();
+    uint32_t magic;
+    uint32_t layout;
+    std::memcpy(&magic, base + kMagicOffset, sizeof(magic));
+    std::memcpy(&layout, base + kLayoutOffset, sizeof(layout));
+    state_capacity = load(kStateCapacityOffset);
+    action_capacity = load(kActionCapacityOffset);
+
+    if (magic != kMagic) {
+        error = "Not a SpireComm shared-memory file: " + path;
+    } else if (layout != kLayoutVersion) {
+        error = "Unsupported shared-memory layout version " + std::to_string(layout);
+    } else if (kHeaderSize + state_capacity + action_capacity > file.size() ||
+               state_capacity % 8 != 0 || action_capacity % 8 != 0) {
+        error = "Corrupt shared-memory header in " + path;
+    } else {
+        state_data = file.data() + kHeaderSize;
+        action_data = state_data + state_capacity;
+        return true;
+    }
+    file.close();
+    return false;
+}
+
+uint64_t ShmTransport::load(size_t offset) const {
+    return std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(file.data() + offset)).load(std::memory_order_acquire);
+}
+
+void ShmTransport::store(size_t offset, uint64_t value) {
+    std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(file.data() + offset)).store(value, std::memory_order_release);
+}
+
+uint64_t ShmTransport::latestVersion() const {
+    return load(kStateLatestVersionOffset);
+}
+
+uint64_t ShmTransport::waitForVersion(uint64_t since_version, int timeout_ms) {
+    uint64_t version = latestVersion();
+    if (version > since_version || timeout_ms <= 0) {
+        return version;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    Backoff backoff;
+    while ((version = latestVersion()) <= since_version) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        backoff.pause();
+    }
+    return version;
+}
+
+bool ShmTransport::latest(StateView& view) const {
+    if (load(kStateCommitOffset) == 0) {
+        return false;
+    }
+
+    uint64_t position = load(kStateLatestOffset);
+    const unsigned char* record = state_data + position % state_capacity;
+    uint32_t length;
+    std::memcpy(&length, record, sizeof(length));
+    std::memcpy(&view.version, record + 8, sizeof(view.version));
+
+    // A torn header (the writer lapped us) is caught by stillValid(); keep the view inside the ring
+    uint64_t available = state_capacity - position % state_capacity - kRecordHeaderSize;
+    if (length > available) {
+        length = 0;
+    }
+    view.position = position;
+    view.body = std::string_view(reinterpret_cast<const char*>(record + kRecordHeaderSize), length);
+    return true;
+}
+
+bool ShmTransport::stillValid(const StateView& view) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // Everything from reserve - capacity onwards is intact
+    return load(kStateReserveOffset) <= view.position + state_capacity;
+}
+
+bool ShmTransport::pushAction(std::string_view body, int timeout_ms, std::string& error, uint64_t* action_id) {
+    uint64_t need = recordSize(body.size());
+    if (need > action_capacity) {
+        error = "Action does not fit in the shared-memory ring";
+        return false;
+    }
+
+    uint64_t write = load(kActionWriteOffset);
+    uint64_t offset = write % action_capacity;
+    uint64_t skip = action_capacity - offset < need ? action_capacity - offset : 0;
+
+    // Wait for the server to drain enough of the ring
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    Backoff backoff;
+    while (write + skip + need - load(kActionReadOffset) > action_capacity) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            error = "Shared-memory action ring full (server not draining)";
+            return false;
+        }
+        backoff.pause();
+    }
+
+    if (skip != 0) {
+        std::memcpy(action_data + offset, &kWrapMarker, sizeof(kWrapMarker));
+        write += skip;
+        offset = 0;
+    }
+
+    unsigned char* record = action_data + offset;
+    uint32_t length = static_cast<uint32_t>(body.size());
+    uint32_t reserved = 0;
+    uint64_t version = 0;
+    std::memcpy(record, &length, sizeof(length));
+    std::memcpy(record + 4, &reserved, sizeof(reserved));
+    std::memcpy(record + 8, &version, sizeof(version));
+    std::memcpy(record + kRecordHeaderSize, body.data(), body.size());
+    store(kActionWriteOffset, write + need);
+
+    if (!action_id) {
+        return true;
+    }
+    if (!waitForActionId(write, timeout_ms, *action_id)) {
+        error = "Shared-memory action was not picked up by the server";
+        return false;
+    }
+    if (*action_id == 0) {
+        error = "Server rejected the action (see the server log)";
+        return false;
+    }
+    return true;
+}
+
+bool ShmTransport::waitForActionId(uint64_t record_position, int timeout_ms, uint64_t& action_id) const {
+    const unsigned char* record = action_data + record_position % action_capacity;
+    uint32_t length;
+    std::memcpy(&length, record, sizeof(length));
+    uint64_t end = record_position + recordSize(length);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    Backoff backoff;
+    while (load(kActionReadOffset) < end) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        backoff.pause();
+    }
+    // Stored by the server before it advanced the read position (acquired above)
+    std::memcpy(&action_id, record + 8, sizeof(action_id));
+    return true;
+}
+
+} // namespace spirecomm
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "local_transport.hpp"
+#include "mapped_file.hpp"
+
+namespace spirecomm {
+
+/**
+ * Client end of the shared-memory transport created by http_server.py --shm
+ * (used by SpireCommClient when config.shm_path is set)
+ *
+ * The file holds a header and two rings of variable-length records:
+ *   - the state ring, written by the server with every /state body, and read
+ *     here in place (the body is parsed straight out of the mapping);
+ *   - the action ring, a single-producer/single-consumer queue of /action
+ *     bodies written here and drained by the server.
+ *
+ * The state writer never waits for readers. A reader takes the latest record
+ * and must call stillValid() after using the body: if the writer has since
+ * lapped the ring over that record, whatever was parsed may be torn and has
+ * to be read again. See HTTP_API.md for the layout.
+ */
+class ShmTransport : public LocalTransport {
+public:
+    // Layout identification, must match spirecomm/shm_ring.py
+    static constexpr uint32_t kMagic = 0x42524353;  // "SCRB"
+    static constexpr uint32_t kLayoutVersion = 1;
+
+    bool open(const std::string& path, std::string& error) override;
+
+    /**
+     * Get version of the newest state (0 if the server has not published one)
+     */
+    uint64_t latestVersion() const;
+
+    /**
+     * Wait until the newest state is past since_version
+     * Polls the header with a backoff from spinning to 1ms sleeps.
+     */
+    uint64_t waitForVersion(uint64_t since_version, int timeout_ms) override;
+
+    bool latest(StateView& view) const override;
+    bool stillValid(const StateView& view) const override;
+
+    /**
+     * Append an /action body to the action ring
+     * Waits up to timeout_ms for the server to make room if the ring is full.
+     * With action_id, also waits for the server to queue the action: it stores
+     * the id in the record before releasing it.
+     * @return false if the body does not fit, the ring stayed full, or the
+     *         server rejected the action
+     */
+    bool pushAction(std::string_view body, int timeout_ms, std::string& error,
+                    uint64_t* action_id = nullptr) override;
+
+private:
+    MappedFile file;
+    uint64_t state_capacity = 0;
+    uint64_t action_capacity = 0;
+    unsigned char* state_data = nullptr;
+    unsigned char* action_data = nullptr;
+
+    uint64_t load(size_t offset) const;
+    void store(size_t offset, uint64_t value);
+    bool waitForActionId(uint64_t record, int timeout_ms, uint64_t& action_id) const;
+};
+
+} // namespace spirecomm
@@ -0,0 +1,113 @@
+#include "spirecomm/stats.hpp"
+#include <algorithm>
+#include <bit>
+#include <sstream>
+
+namespace spirecomm {
+
+namespace {
+
+// Largest value that falls in a bucket
+uint64_t bucketUpper(size_t bucket) {
+    if (bucket == 0) {
+        return 0;
+    }
+    if (bucket >= Histogram::kBuckets - 1) {
+        return UINT64_MAX;
+    }
+    return (uint64_t{1} << bucket) - 1;
+}
+
+std::string formatBytes(uint64_t bytes) {
+    std::ostringstream out;
+    out.precision(1);
+    out << std::fixed;
+    if (bytes >= 1024 * 1024) {
+        out << static_cast<double>(bytes) / (1024.0 * 1024.0) << " MiB";
+    } else if (bytes >= 1024) {
+        out << static_cast<double>(bytes) / 1024.0 << " KiB";
+    } else {
+        out << bytes << " B";
+    }
+    return out.str();
+}
+
+void formatHistogram(std::ostream& out, const Histogram& h, const char* unit) {
+    out.precision(1);
+    out << std::fixed;
+    out << "n=" << h.count;
+    if (h.count != 0) {
+        out << " mean=" << h.mean() << unit
+            << " p50=" << h.percentile(0.5) << unit
+            << " p99=" << h.percentile(0.99) << unit
+            << " max=" << h.max << unit;
+    }
+}
+
+void formatEndpoint(std::ostream& out, const char* name, const EndpointStats& e) {
+    out << "  " << name << ": " << e.requests << " requests";
+    if (e.failures != 0) {
+        out << ", " << e.failures << " failed";
+    }
+    if (e.not_modified != 0) {
+        out << ", " << e.not_modified << " not modified";
+    }
+    out << ", " << formatBytes(e.bytes_received) << " in, " << formatBytes(e.bytes_sent) << " out";
+    if (e.round_trip_us.count != 0) {
+        out << ", rtt ";
+        formatHistogram(out, e.round_trip_us, "us");
+    }
+    out << "\n";
+}
+
+} // anonymous namespace
+
+void Histogram::record(uint64_t value) {
+    size_t bucket = std::min(static_cast<size_t>(std::bit_width(value)), kBuckets - 1);
+    ++buckets[bucket];
+    ++count;
+    total += value;
+    max = std::max(max, value);
+}
+
+double Histogram::mean() const {
+    return count == 0 ? 0.0 : static_cast<double>(total) / static_cast<double>(count);
+}
+
+uint64_t Histogram::percentile(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::clamp(p, 0.0, 1.0) * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen > rank || seen == count) {
+            return std::min(bucketUpper(i), max);
+        }
+    }
+    return max;
+}
+
+std::string ClientStats::toString() const {
+    std::ostringstream out;
+    out.precision(1);
+    out << std::fixed;
+    out << "Client stats over " << elapsed_seconds << "s\n";
+    formatEndpoint(out, "/health", health);
+    formatEndpoint(out, "/state ", state);
+    formatEndpoint(out, "/action", action);
+    formatEndpoint(out, "/stream", stream);
+
+    out << "  states: " << states << ", decisions: " << decisions << "\n";
+    out << "  parse: ";
+    formatHistogram(out, parse_us, "us");
+    out << "\n  action to ready: ";
+    formatHistogram(out, action_to_ready_us, "us");
+    out << "\n  polls per decision: ";
+    formatHistogram(out, polls_per_decision, "");
+    out << "\n";
+    return out.str();
+}
+
+} // namespace spirecomm
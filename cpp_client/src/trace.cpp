@@ -0,0 +1,167 @@
+#include "trace.hpp"
+#include <cerrno>
+#include <cstring>
+
+namespace spirecomm {
+
+namespace {
+
+uint64_t paddedSize(size_t body_size) {
+    return (trace::kRecordHeaderSize + body_size + 7) & ~uint64_t{7};
+}
+
+} // anonymous namespace
+
+// TraceWriter
+
+TraceWriter::~TraceWriter() {
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+bool TraceWriter::open(const std::string& path, std::string& error) {
+    if (file) {
+        std::fclose(file);
+    }
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        error = "Cannot create trace file " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    uint32_t header[2] = {trace::kMagic, trace::kFormatVersion};
+    std::fwrite(header, sizeof(header), 1, file);
+    record_count = 0;
+    return true;
+}
+
+void TraceWriter::writeState(uint64_t version, std::string_view body) {
+    write(trace::RecordKind::STATE, version, body);
+}
+
+void TraceWriter::writeAction(std::string_view body) {
+    write(trace::RecordKind::ACTION, 0, body);
+}
+
+void TraceWriter::write(trace::RecordKind kind, uint64_t version, std::string_view body) {
+    if (!file) {
+        return;
+    }
+    static constexpr char kPadding[8] = {};
+    uint32_t length = static_cast<uint32_t>(body.size());
+    uint32_t kind_value = static_cast<uint32_t>(kind);
+    std::fwrite(&length, sizeof(length), 1, file);
+    std::fwrite(&kind_value, sizeof(kind_value), 1, file);
+    std::fwrite(&version, sizeof(version), 1, file);
+    std::fwrite(body.data(), 1, body.size(), file);
+    std::fwrite(kPadding, 1, paddedSize(body.size()) - trace::kRecordHeaderSize - body.size(), file);
+    ++record_count;
+}
+
+// ReplayTransport
+
+bool ReplayTransport::open(const std::string& path, std::string& error) {
+    if (!file.open(path, false, error)) {
+        return false;
+    }
+
+    uint32_t header[2] = {};
+    if (file.size() >= trace::kFileHeaderSize) {
+        std::memcpy(header, file.data(), sizeof(header));
+    }
+    if (header[0] != trace::kMagic) {
+        error = "Not a SpireComm trace file: " + path;
+    } else if (header[1] != trace::kFormatVersion) {
+        error = "Unsupported trace format version " + std::to_string(header[1]);
+    } else {
+        rewind();
+        return true;
+    }
+    file.close();
+    return false;
+}
+
+void ReplayTransport::rewind() {
+    current = 0;
+    at_end = false;
+    advanceToState(trace::kFileHeaderSize);
+}
+
+bool ReplayTransport::readRecord(size_t offset, Record& record) const {
+    if (offset + trace::kRecordHeaderSize > file.size()) {
+        return false;
+    }
+    const unsigned char* data = file.data() + offset;
+    uint32_t length;
+    uint32_t kind;
+    std::memcpy(&length, data, sizeof(length));
+    std::memcpy(&kind, data + 4, sizeof(kind));
+    std::memcpy(&record.version, data + 8, sizeof(record.version));
+    if (length > file.size() - offset - trace::kRecordHeaderSize) {
+        return false;  // Truncated (recording interrupted); treat as the end
+    }
+    record.kind = static_cast<trace::RecordKind>(kind);
+    record.body = std::string_view(reinterpret_cast<const char*>(data + trace::kRecordHeaderSize), length);
+    record.next = offset + paddedSize(length);
+    return true;
+}
+
+bool ReplayTransport::advanceToState(size_t from) {
+    Record record;
+    for (size_t offset = from; readRecord(offset, record); offset = record.next) {
+        if (record.kind == trace::RecordKind::STATE) {
+            current = offset;
+            return true;
+        }
+    }
+    at_end = true;
+    return false;
+}
+
+uint64_t ReplayTransport::waitForVersion(uint64_t since_version, int) {
+    Record record;
+    if (current == 0 || !readRecord(current, record)) {
+        return 0;
+    }
+    if (record.version <= since_version && !at_end) {
+        // The client has this state; hand out the next one without waiting
+        if (advanceToState(record.next)) {
+            readRecord(current, record);
+        }
+    }
+    return record.version;
+}
+
+bool ReplayTransport::latest(StateView& view) const {
+    Record record;
+    if (current == 0 || !readRecord(current, record)) {
+        return false;
+    }
+    view.version = record.version;
+    view.position = current;
+    view.body = record.body;
+    return true;
+}
+
+bool ReplayTransport::pushAction(std::string_view, int, std::string& error, uint64_t* action_id) {
+    if (action_id) {
+        *action_id = 0;  // The next state is the result; recorded ids belong to the recording
+    }
+    if (at_end) {
+        error = "Replay finished";
+        return false;
+    }
+
+    // Skip to the state the game answered the next recorded action with
+    Record record;
+    for (size_t offset = current; readRecord(offset, record); offset = record.next) {
+        if (record.kind == trace::RecordKind::ACTION) {
+            advanceToState(record.next);
+            return true;
+        }
+    }
+    at_end = true;  // No recorded action left: nothing more will happen
+    return true;
+}
+
+} // namespace spirecomm
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include "local_transport.hpp"
+#include "mapped_file.hpp"
+
+namespace spirecomm {
+
+/**
+ * Trace files: every state a client parsed and every action it sent, in order
+ * (written when config.record_path is set, replayed with config.replay_path)
+ *
+ * Layout (little-endian): a u32 magic "STRC" and a u32 format version, then
+ * records of u32 body length, u32 kind, u64 state version (0 for actions) and
+ * the body, padded to 8 bytes. Bodies are JSON: full /state responses for
+ * states (also when they arrived as deltas or MessagePack) and /action bodies
+ * for actions. The file is meant to be mapped, so bodies are parsed in place.
+ */
+namespace trace {
+
+constexpr uint32_t kMagic = 0x43525453;  // "STRC"
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kFileHeaderSize = 8;
+constexpr size_t kRecordHeaderSize = 16;
+
+enum class RecordKind : uint32_t {
+    STATE = 1,
+    ACTION = 2
+};
+
+} // namespace trace
+
+/**
+ * Appends records to a trace file
+ * Writes are buffered; the file is complete once the writer is destroyed.
+ */
+class TraceWriter {
+public:
+    TraceWriter() = default;
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    /**
+     * Create (or truncate) the file and write its header
+     * @return false with error set if the file cannot be created
+     */
+    bool open(const std::string& path, std::string& error);
+
+    void writeState(uint64_t version, std::string_view body);
+    void writeAction(std::string_view body);
+
+    /**
+     * Get number of records written
+     */
+    uint64_t records() const { return record_count; }
+
+private:
+    std::FILE* file = nullptr;
+    uint64_t record_count = 0;
+
+    void write(trace::RecordKind kind, uint64_t version, std::string_view body);
+};
+
+/**
+ * Feeds a recorded trace back to SpireCommClient at full speed
+ * (used when config.replay_path is set)
+ *
+ * States come back in recorded order with no waiting: asking for anything
+ * newer than the current state moves to the next one, and sending an action
+ * moves to the first state recorded after the next recorded action, i.e. the
+ * state the game produced in response. Actions are not compared with the
+ * recording, so any agent can be replayed deterministically. Once the trace
+ * is exhausted no newer state arrives and exhausted() returns true.
+ */
+class ReplayTransport : public LocalTransport {
+public:
+    bool open(const std::string& path, std::string& error) override;
+    uint64_t waitForVersion(uint64_t since_version, int timeout_ms) override;
+    bool latest(StateView& view) const override;
+    bool stillValid(const StateView&) const override { return true; }  // The mapping is read-only
+    bool pushAction(std::string_view body, int timeout_ms, std::string& error,
+                    uint64_t* action_id = nullptr) override;
+
+    /**
+     * Check whether every recorded state has been handed out
+     */
+    bool exhausted() const override { return at_end; }
+
+    /**
+     * Rewind to the first state
+     */
+    void rewind();
+
+private:
+    // One record of the mapping
+    struct Record {
+        trace::RecordKind kind;
+        uint64_t version;
+        std::string_view body;
+        size_t next;  // Offset of the following record
+    };
+
+    MappedFile file;
+    size_t current = 0;     // Offset of the state handed out by latest() (0 = none yet)
+    bool at_end = false;
+
+    bool readRecord(size_t offset, Record& record) const;
+    bool advanceToState(size_t from);  // Move to the first state record at or after from
+};
+
+} // namespace spirecomm
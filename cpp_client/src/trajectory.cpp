@@ -0,0 +1,385 @@
+#include "spirecomm/trajectory.hpp"
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace spirecomm {
+
+namespace {
+
+struct FileHeader {
+    uint32_t magic = trajectory::kMagic;
+    uint32_t format_version = trajectory::kFormatVersion;
+    uint32_t layout_version = Feature::kLayoutVersion;
+    uint32_t feature_count = Feature::COUNT;
+    uint32_t record_size = sizeof(TransitionRecord);
+    uint32_t reserved[3] = {};
+};
+
+struct ChunkHeader {
+    uint32_t magic = trajectory::kChunkMagic;
+    uint32_t rows = 0;
+    uint64_t strings_size = 0;
+    uint64_t chunk_size = 0;  // Header and sections, padding included
+    uint64_t reserved = 0;
+};
+
+static_assert(sizeof(FileHeader) == trajectory::kFileHeaderSize);
+static_assert(sizeof(ChunkHeader) == trajectory::kChunkHeaderSize);
+
+uint64_t padded(uint64_t size) {
+    return (size + trajectory::kAlignment - 1) & ~uint64_t{trajectory::kAlignment - 1};
+}
+
+uint64_t chunkSize(uint64_t rows, uint64_t feature_count, uint64_t strings_size) {
+    return trajectory::kChunkHeaderSize + padded(rows * sizeof(TransitionRecord)) +
+           2 * rows * feature_count * sizeof(float) + padded(strings_size);
+}
+
+// Transitions being collected, or queued for the writer thread
+struct Chunk {
+    std::vector<TransitionRecord> records;
+    std::vector<float> states;       // Sized once for a full chunk
+    std::vector<float> next_states;
+    std::string strings;
+    size_t rows = 0;
+
+    explicit Chunk(size_t capacity) {
+        records.reserve(capacity);
+        states.resize(capacity * Feature::COUNT);
+        next_states.resize(capacity * Feature::COUNT);
+    }
+
+    void clear() {
+        records.clear();
+        strings.clear();
+        rows = 0;
+    }
+};
+
+} // anonymous namespace
+
+// TrajectoryWriter
+
+struct TrajectoryWriter::Impl {
+    size_t chunk_rows;
+    std::unique_ptr<Chunk> current;
+    uint64_t transitions = 0;
+
+    std::FILE* file = nullptr;
+    std::thread thread;
+
+    mutable std::mutex mutex;
+    std::condition_variable work_cv;   // Signals the writer thread: chunk queued or stopping
+    std::condition_variable idle_cv;   // Signals flush(): a chunk was written
+    std::deque<std::unique_ptr<Chunk>> queue;
+    std::vector<std::unique_ptr<Chunk>> free_chunks;
+    bool writing = false;
+    bool stopping = false;
+    std::string last_error;
+
+    explicit Impl(size_t rows) : chunk_rows(std::max<size_t>(rows, 1)) {}
+
+    void append(const GameState& state, std::string_view body, const GameState& next_state,
+                float reward, bool done, const LegalAction* legal) {
+        if (!file) {
+            return;
+        }
+        if (!current) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (free_chunks.empty()) {
+                current = std::make_unique<Chunk>(chunk_rows);
+            } else {
+                current = std::move(free_chunks.back());
+                free_chunks.pop_back();
+            }
+        }
+
+        Chunk& chunk = *current;
+        size_t row = chunk.rows++;
+        encodeFeatures(state, chunk.states.data() + row * Feature::COUNT);
+        encodeFeatures(next_state, chunk.next_states.data() + row * Feature::COUNT);
+
+        TransitionRecord& record = chunk.records.emplace_back();
+        record.state_version = state.state_version;
+        record.next_state_version = next_state.state_version;
+        record.action_offset = static_cast<uint32_t>(chunk.strings.size());
+        record.action_length = static_cast<uint32_t>(body.size());
+        record.reward = reward;
+        record.done = done ? 1 : 0;
+        if (legal) {
+            record.action_kind = static_cast<uint8_t>(legal->kind);
+            record.action_index = legal->index;
+            record.action_target = legal->target;
+        }
+        chunk.strings.append(body);
+        ++transitions;
+
+        if (chunk.rows == chunk_rows) {
+            submit();
+        }
+    }
+
+    void submit() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(current));
+        }
+        work_cv.notify_one();
+    }
+
+    void writerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            work_cv.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;  // Stopping with nothing left to write
+            }
+            std::unique_ptr<Chunk> chunk = std::move(queue.front());
+            queue.pop_front();
+            // After a failed write the file ends in a partial chunk; later chunks could not be read anyway
+            bool skip = !last_error.empty();
+            writing = true;
+            lock.unlock();
+
+            std::string error;
+            if (!skip) {
+                writeChunk(*chunk, error);
+            }
+            chunk->clear();
+
+            lock.lock();
+            if (!error.empty()) {
+                last_error = error;
+            }
+            free_chunks.push_back(std::move(chunk));
+            writing = false;
+            idle_cv.notify_all();
+        }
+    }
+
+    // Writer thread only
+    void writeChunk(const Chunk& chunk, std::string& error) {
+        static constexpr char kPadding[trajectory::kAlignment] = {};
+        ChunkHeader header;
+        header.rows = static_cast<uint32_t>(chunk.rows);
+        header.strings_size = chunk.strings.size();
+        header.chunk_size = chunkSize(chunk.rows, Feature::COUNT, chunk.strings.size());
+
+        size_t records_size = chunk.rows * sizeof(TransitionRecord);
+        size_t features_size = chunk.rows * Feature::COUNT * sizeof(float);
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = ok && std::fwrite(chunk.records.data(), 1, records_size, file) == records_size;
+        ok = ok && std::fwrite(kPadding, 1, padded(records_size) - records_size, file) == padded(records_size) - records_size;
+        ok = ok && std::fwrite(chunk.states.data(), 1, features_size, file) == features_size;
+        ok = ok && std::fwrite(chunk.next_states.data(), 1, features_size, file) == features_size;
+        ok = ok && std::fwrite(chunk.strings.data(), 1, chunk.strings.size(), file) == chunk.strings.size();
+        ok = ok && std::fwrite(kPadding, 1, padded(chunk.strings.size()) - chunk.strings.size(), file) ==
+                       padded(chunk.strings.size()) - chunk.strings.size();
+        // Hand each chunk to the OS, so a crash of this process loses only what is still queued
+        ok = ok && std::fflush(file) == 0;
+        if (!ok) {
+            error = std::string("Trajectory write failed: ") + std::strerror(errno);
+        }
+    }
+};
+
+TrajectoryWriter::TrajectoryWriter(size_t chunk_rows) : pImpl(std::make_unique<Impl>(chunk_rows)) {}
+
+TrajectoryWriter::~TrajectoryWriter() {
+    close();
+}
+
+bool TrajectoryWriter::open(const std::string& path, std::string& error) {
+    close();
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        error = "Cannot create trajectory file " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    FileHeader header;
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        error = "Cannot write trajectory file " + path + ": " + std::strerror(errno);
+        std::fclose(file);
+        return false;
+    }
+
+    pImpl->file = file;
+    pImpl->transitions = 0;
+    pImpl->stopping = false;
+    pImpl->last_error.clear();
+    pImpl->thread = std::thread([this] { pImpl->writerLoop(); });
+    return true;
+}
+
+void TrajectoryWriter::append(const GameState& state, const Action& action, const GameState& next_state,
+                              float reward, bool done) {
+    pImpl->append(state, action.body(), next_state, reward, done, nullptr);
+}
+
+void TrajectoryWriter::append(const GameState& state, const LegalAction& action, const GameState& next_state,
+                              float reward, bool done) {
+    if (!pImpl->file) {
+        return;
+    }
+    Action built = action.toAction(state);
+    pImpl->append(state, built.body(), next_state, reward, done, &action);
+}
+
+bool TrajectoryWriter::flush() {
+    if (!pImpl->file) {
+        return false;
+    }
+    if (pImpl->current && pImpl->current->rows > 0) {
+        pImpl->submit();
+    }
+    std::unique_lock<std::mutex> lock(pImpl->mutex);
+    pImpl->idle_cv.wait(lock, [this] { return pImpl->queue.empty() && !pImpl->writing; });
+    return pImpl->last_error.empty();
+}
+
+void TrajectoryWriter::close() {
+    if (!pImpl->file) {
+        return;
+    }
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        pImpl->stopping = true;
+    }
+    pImpl->work_cv.notify_one();
+    pImpl->thread.join();
+    std::fclose(pImpl->file);
+    pImpl->file = nullptr;
+}
+
+bool TrajectoryWriter::isOpen() const {
+    return pImpl->file != nullptr;
+}
+
+uint64_t TrajectoryWriter::transitions() const {
+    return pImpl->transitions;
+}
+
+size_t TrajectoryWriter::pendingChunks() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->queue.size() + (pImpl->writing ? 1 : 0);
+}
+
+std::string TrajectoryWriter::getLastError() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->last_error;
+}
+
+// TrajectoryReader
+
+struct TrajectoryReader::Impl {
+    MappedFile file;
+    uint32_t layout_version = 0;
+    size_t feature_count = 0;
+    std::vector<TrajectoryChunk> chunks;
+    std::vector<uint64_t> first_rows;  // Index of each chunk's first transition
+    uint64_t total = 0;
+};
+
+TrajectoryReader::TrajectoryReader() : pImpl(std::make_unique<Impl>()) {}
+
+TrajectoryReader::~TrajectoryReader() = default;
+
+bool TrajectoryReader::open(const std::string& path, std::string& error) {
+    close();
+    MappedFile& file = pImpl->file;
+    if (!file.open(path, false, error)) {
+        return false;
+    }
+
+    FileHeader header;
+    header.magic = 0;
+    if (file.size() >= sizeof(header)) {
+        std::memcpy(&header, file.data(), sizeof(header));
+    }
+    if (header.magic != trajectory::kMagic) {
+        error = "Not a SpireComm trajectory file: " + path;
+    } else if (header.format_version != trajectory::kFormatVersion) {
+        error = "Unsupported trajectory format version " + std::to_string(header.format_version);
+    } else if (header.record_size != sizeof(TransitionRecord)) {
+        error = "Unexpected trajectory record size " + std::to_string(header.record_size);
+    } else {
+        pImpl->layout_version = header.layout_version;
+        pImpl->feature_count = header.feature_count;
+        // Index chunks up to the end of the file or the first incomplete one
+        uint64_t offset = sizeof(header);
+        while (offset + sizeof(ChunkHeader) <= file.size()) {
+            ChunkHeader chunk_header;
+            std::memcpy(&chunk_header, file.data() + offset, sizeof(chunk_header));
+            uint64_t rows = chunk_header.rows;
+            if (chunk_header.magic != trajectory::kChunkMagic ||
+                chunk_header.chunk_size != chunkSize(rows, header.feature_count, chunk_header.strings_size) ||
+                chunk_header.chunk_size > file.size() - offset) {
+                break;
+            }
+            const unsigned char* base = file.data() + offset + sizeof(chunk_header);
+            size_t features_size = rows * header.feature_count * sizeof(float);
+            TrajectoryChunk chunk;
+            chunk.rows = rows;
+            chunk.feature_count = header.feature_count;
+            chunk.records = reinterpret_cast<const TransitionRecord*>(base);
+            base += padded(rows * sizeof(TransitionRecord));
+            chunk.states = reinterpret_cast<const float*>(base);
+            chunk.next_states = reinterpret_cast<const float*>(base + features_size);
+            chunk.strings = std::string_view(reinterpret_cast<const char*>(base + 2 * features_size),
+                                             chunk_header.strings_size);
+            pImpl->chunks.push_back(chunk);
+            pImpl->first_rows.push_back(pImpl->total);
+            pImpl->total += rows;
+            offset += chunk_header.chunk_size;
+        }
+        return true;
+    }
+    file.close();
+    return false;
+}
+
+void TrajectoryReader::close() {
+    pImpl->file.close();
+    pImpl->chunks.clear();
+    pImpl->first_rows.clear();
+    pImpl->total = 0;
+    pImpl->layout_version = 0;
+    pImpl->feature_count = 0;
+}
+
+uint32_t TrajectoryReader::layoutVersion() const {
+    return pImpl->layout_version;
+}
+
+size_t TrajectoryReader::featureCount() const {
+    return pImpl->feature_count;
+}
+
+size_t TrajectoryReader::chunks() const {
+    return pImpl->chunks.size();
+}
+
+TrajectoryChunk TrajectoryReader::chunk(size_t index) const {
+    return pImpl->chunks[index];
+}
+
+uint64_t TrajectoryReader::size() const {
+    return pImpl->total;
+}
+
+TrajectoryChunk TrajectoryReader::locate(uint64_t index, size_t& row) const {
+    const std::vector<uint64_t>& first = pImpl->first_rows;
+    size_t chunk = static_cast<size_t>(std::upper_bound(first.begin(), first.end(), index) - first.begin()) - 1;
+    row = static_cast<size_t>(index - first[chunk]);
+    return pImpl->chunks[chunk];
+}
+
+} // namespace spirecomm
@@ -0,0 +1,41 @@
+#include "spirecomm/wire_format.hpp"
+
+namespace spirecomm {
+
+using json = nlohmann::json;
+
+std::string_view contentType(WireFormat format) {
+    switch (format) {
+        case WireFormat::MSGPACK: return "application/msgpack";
+        case WireFormat::CBOR: return "application/cbor";
+        case WireFormat::JSON: break;
+    }
+    return "application/json";
+}
+
+WireFormat wireFormatFromContentType(std::string_view content_type) {
+    std::string_view media_type = content_type.substr(0, content_type.find(';'));
+    while (!media_type.empty() && media_type.back() == ' ') {
+        media_type.remove_suffix(1);
+    }
+
+    if (media_type == "application/msgpack" || media_type == "application/x-msgpack" ||
+        media_type == "application/vnd.msgpack") {
+        return WireFormat::MSGPACK;
+    }
+    if (media_type == "application/cbor") {
+        return WireFormat::CBOR;
+    }
+    return WireFormat::JSON;
+}
+
+json decodeBody(std::string_view body, WireFormat format) {
+    switch (format) {
+        case WireFormat::MSGPACK: return json::from_msgpack(body.begin(), body.end());
+        case WireFormat::CBOR: return json::from_cbor(body.begin(), body.end());
+        case WireFormat::JSON: break;
+    }
+    return json::parse(body.begin(), body.end());
+}
+
+} // namespace spirecomm
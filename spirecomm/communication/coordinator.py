@@ -19,11 +19,13 @@ if not logger.handlers:
     logger.setLevel(logging.INFO)
 
 
-def read_stdin(input_queue):
+def read_stdin(input_queue, wakeup=None):
     """Read lines from stdin and write them to a queue
 
     :param input_queue: A queue, to which lines from stdin will be written
     :type input_queue: queue.Queue
+    :param wakeup: An event set after each line is queued
+    :type wakeup: threading.Event
     :return: None
     """
     while True:
@@ -35,6 +37,8 @@ def read_stdin(input_queue):
             else:
                 stdin_input += input_char
         input_queue.put(stdin_input)
+        if wakeup is not None:
+            wakeup.set()
 
 
 def write_stdout(output_queue):
@@ -52,15 +56,24 @@ def write_stdout(output_queue):
 class Coordinator:
     """An object to coordinate communication with Slay the Spire"""
 
-    def __init__(self):
+    def __init__(self, game=None):
+        """
+        :param game: a stand-in for Communication Mod to talk to instead of stdin/stdout,
+            such as spirecomm.communication.mock_game.MockGame
+        """
         self.input_queue = queue.Queue()
         self.output_queue = queue.Queue()
-        self.input_thread = threading.Thread(target=read_stdin, args=(self.input_queue,))
-        self.output_thread = threading.Thread(target=write_stdout, args=(self.output_queue,))
-        self.input_thread.daemon = True
-        self.input_thread.start()
-        self.output_thread.daemon = True
-        self.output_thread.start()
+        # Set whenever a message arrives or an action is queued, so a loop can sleep in wait_for_work()
+        self.wakeup = threading.Event()
+        if game is not None:
+            game.attach(self.input_queue, self.output_queue, self.wakeup)
+        else:
+            self.input_thread = threading.Thread(target=read_stdin, args=(self.input_queue, self.wakeup))
+            self.output_thread = threading.Thread(target=write_stdout, args=(self.output_queue,))
+            self.input_thread.daemon = True
+            self.input_thread.start()
+            self.output_thread.daemon = True
+            self.output_thread.start()
         self.action_queue = collections.deque()
         self.state_change_callback = None
         self.out_of_game_callback = None
@@ -70,6 +83,7 @@ class Coordinator:
         self.in_game = False
         self.last_game_state = None
         self.last_error = None
+        self.last_executed_action = None
 
     def signal_ready(self):
         """Indicate to Communication Mod that setup is complete
@@ -99,6 +113,32 @@ class Coordinator:
         :return: None
         """
         self.action_queue.append(action)
+        self.wakeup.set()
+
+    def add_actions_to_queue(self, actions):
+        """Queue several actions to perform in order, without interleaving others
+
+        :param actions: the actions to queue
+        :type actions: list[Action]
+        :return: None
+        """
+        self.action_queue.extend(actions)
+        self.wakeup.set()
+
+    def wait_for_work(self, timeout=None):
+        """Block until a message arrives from Communication Mod or an action is queued
+
+        Call after an iteration that neither executed an action nor received a
+        message; anything that arrived since the previous call returns at once.
+
+        :param timeout: maximum time to wait, in seconds (None to wait forever)
+        :type timeout: float
+        :return: True if woken by new work, False on timeout
+        :rtype: bool
+        """
+        woken = self.wakeup.wait(timeout)
+        self.wakeup.clear()
+        return woken
 
     def clear_actions(self):
         """Remove all actions from the action queue
@@ -113,6 +153,7 @@ class Coordinator:
         :return: None
         """
         action = self.action_queue.popleft()
+        self.last_executed_action = action
         logger.debug(f"Executing action: {type(action).__name__}")
         action.execute(self)
         logger.debug(f"Action execution complete")
@@ -0,0 +1,276 @@
+"""
+Mock game - a stand-in for Communication Mod that answers instantly
+
+Plugs into Coordinator in place of stdin/stdout (Coordinator(game=MockGame()),
+or http_server.py --mock) and answers every command the coordinator sends
+with the next state of a script, without any animation delay. Together with
+a client such as cpp_client/examples/full_game_test.cpp this measures how many
+actions per second the client, the HTTP layer and the coordinator queue can
+sustain on their own.
+
+A script is a list of Communication Mod messages (the JSON objects the mod
+writes to stdout). Any command that the current state allows moves to the
+next message; "state" and "wait" resend the current one, and a command the
+current state does not list (under any of its aliases, e.g. "cancel" for
+"skip") is answered with an error like the mod does.
+After the last message the script starts over.
+
+The built-in script walks through one short run covering every screen type
+(Neow, map, combat, rewards, shop, grid, rest, chest, boss reward, game
+over), then the main menu, where "start" begins the run again. Custom scripts are JSON Lines files, one message per line,
+e.g. captured from a real game by putting tee between the mod and the server.
+"""
+
+import json
+import logging
+import threading
+import time
+
+logger = logging.getLogger('spirecomm.mock_game')
+
+# Commands Communication Mod accepts under another name
+_COMMAND_ALIASES = {
+    'confirm': 'proceed',
+    'skip': 'return',
+    'cancel': 'return',
+    'leave': 'return',
+}
+
+# Commands answered with the current state instead of advancing
+_QUERY_COMMANDS = ('state', 'wait')
+
+
+def _card(card_id, name, card_type='ATTACK', cost=1, has_target=True, uuid='0', rarity='BASIC'):
+    return {'id': card_id, 'name': name, 'type': card_type, 'rarity': rarity, 'upgrades': 0,
+            'has_target': has_target, 'cost': cost, 'uuid': uuid, 'misc': 0, 'is_playable': True,
+            'exhausts': False}
+
+
+def _strike(n):
+    return _card('Strike_R', 'Strike', uuid='strike-%d' % n)
+
+
+def _defend(n):
+    return _card('Defend_R', 'Defend', 'SKILL', has_target=False, uuid='defend-%d' % n)
+
+
+def _bash():
+    return _card('Bash', 'Bash', cost=2, uuid='bash-0')
+
+
+def _node(x, y, symbol):
+    return {'x': x, 'y': y, 'symbol': symbol}
+
+
+def _dungeon_map():
+    rows = ['M?M', '$M?', 'RTM', 'E?M']
+    nodes = []
+    for y, row in enumerate(rows):
+        for x, symbol in enumerate(row):
+            children = [{'x': cx, 'y': y + 1} for cx in (x - 1, x, x + 1) if 0 <= cx < 3 and y + 1 < len(rows)]
+            nodes.append(dict(_node(x, y, symbol), children=children))
+    return nodes
+
+
+def _monster(name, monster_id, hp, max_hp, intent='ATTACK', damage=11):
+    return {'name': name, 'id': monster_id, 'current_hp': hp, 'max_hp': max_hp, 'block': 0, 'intent': intent,
+            'half_dead': False, 'is_gone': hp <= 0, 'move_id': 1, 'last_move_id': None,
+            'second_last_move_id': None, 'move_base_damage': damage, 'move_adjusted_damage': damage,
+            'move_hits': 1, 'powers': []}
+
+
+def _in_game(floor, screen_type, screen_state, commands, room_type='MonsterRoom', room_phase='COMPLETE',
+             choice_list=None, combat_state=None, hp=80, gold=99):
+    """Build one in-game Communication Mod message"""
+    game_state = {
+        'current_hp': hp, 'max_hp': 80, 'floor': floor, 'act': 1, 'gold': gold, 'seed': 1234567890,
+        'class': 'IRONCLAD', 'ascension_level': 0, 'act_boss': 'Hexaghost',
+        'relics': [{'id': 'Burning Blood', 'name': 'Burning Blood', 'counter': -1}],
+        'deck': [_strike(n) for n in range(5)] + [_defend(n) for n in range(4)] + [_bash()],
+        'potions': [{'id': 'Fire Potion', 'name': 'Fire Potion', 'can_use': True, 'can_discard': True,
+                     'requires_target': True},
+                    {'id': 'Potion Slot', 'name': 'Potion Slot', 'can_use': False, 'can_discard': False,
+                     'requires_target': False}],
+        'map': _dungeon_map(),
+        'screen_type': screen_type, 'screen_state': screen_state, 'is_screen_up': screen_type != 'NONE',
+        'room_phase': room_phase, 'room_type': room_type,
+    }
+    if choice_list is not None:
+        game_state['choice_list'] = choice_list
+    if combat_state is not None:
+        game_state['combat_state'] = combat_state
+    return {'available_commands': commands + ['key', 'click', 'wait', 'state'], 'ready_for_command': True,
+            'in_game': True, 'game_state': game_state}
+
+
+def _combat(floor, turn, monster_hp, hand, energy):
+    combat_state = {
+        'player': {'current_hp': 80 - 6 * turn, 'max_hp': 80, 'block': 0, 'energy': energy, 'powers': [],
+                   'orbs': []},
+        'monsters': [_monster('Jaw Worm', 'JawWorm', monster_hp, 42)],
+        'hand': hand,
+        'draw_pile': [_strike(n) for n in range(3, 5)] + [_defend(3)],
+        'discard_pile': [_defend(2)] if turn > 1 else [],
+        'exhaust_pile': [], 'limbo': [], 'turn': turn, 'cards_discarded_this_turn': 0,
+    }
+    return _in_game(floor, 'NONE', {}, ['play', 'end', 'potion'], room_phase='COMBAT',
+                    combat_state=combat_state, hp=80 - 6 * turn)
+
+
+def default_script():
+    """Build the built-in script: one short run through every screen type
+
+    :return: Communication Mod messages in the order they are answered
+    :rtype: list[dict]
+    """
+    relic = {'id': 'Anchor', 'name': 'Anchor', 'counter': -1, 'price': 150}
+    potion = {'id': 'Block Potion', 'name': 'Block Potion', 'can_use': True, 'can_discard': True,
+              'requires_target': False, 'price': 50}
+    menu = {'available_commands': ['start', 'state'], 'ready_for_command': True, 'in_game': False}
+    hand = [_strike(0), _strike(1), _defend(0), _defend(1), _bash()]
+
+    return [
+        _in_game(0, 'EVENT', {'event_name': 'Neow', 'event_id': 'Neow Event', 'body_text': 'Choose a blessing',
+                              'options': [{'text': '[Max HP +8]', 'label': 'Max HP', 'disabled': False,
+                                           'choice_index': 0},
+                                          {'text': '[Gain 100 Gold]', 'label': 'Gold', 'disabled': False,
+                                           'choice_index': 1}]},
+                 ['choose'], room_type='NeowRoom', room_phase='EVENT', choice_list=['max hp', 'gold']),
+        _in_game(0, 'MAP', {'current_node': None, 'next_nodes': [_node(0, 0, 'M'), _node(2, 0, 'M')],
+                            'boss_available': False},
+                 ['choose'], room_type='NeowRoom', choice_list=['x=0', 'x=2']),
+        _combat(1, 1, 42, hand, 3),
+        _combat(1, 1, 36, hand[1:], 2),
+        _combat(1, 1, 30, hand[2:], 1),
+        _combat(1, 2, 22, hand, 3),
+        _combat(1, 2, 8, hand[1:], 1),
+        _in_game(1, 'COMBAT_REWARD', {'rewards': [{'reward_type': 'GOLD', 'gold': 15},
+                                                  {'reward_type': 'POTION', 'potion': potion},
+                                                  {'reward_type': 'CARD'}]},
+                 ['choose', 'proceed'], choice_list=['gold', 'potion', 'card'], gold=99),
+        _in_game(1, 'CARD_REWARD', {'cards': [_card('Pommel Strike', 'Pommel Strike', rarity='COMMON', uuid='r1'),
+                                              _card('Shrug It Off', 'Shrug It Off', 'SKILL', has_target=False,
+                                                    rarity='COMMON', uuid='r2'),
+                                              _card('Inflame', 'Inflame', 'POWER', has_target=False,
+                                                    rarity='UNCOMMON', uuid='r3')],
+                                    'bowl_available': False, 'skip_available': True},
+                 ['choose', 'skip'], choice_list=['pommel strike', 'shrug it off', 'inflame'], gold=114),
+        _in_game(1, 'MAP', {'current_node': _node(0, 0, 'M'), 'next_nodes': [_node(0, 1, '$'), _node(1, 1, 'M')],
+                            'boss_available': False},
+                 ['choose'], choice_list=['x=0', 'x=1'], gold=114),
+        _in_game(2, 'SHOP_ROOM', {}, ['choose', 'proceed'], room_type='ShopRoom', choice_list=['shop'], gold=114),
+        _in_game(2, 'SHOP_SCREEN', {'cards': [dict(_card('Anger', 'Anger', cost=0, rarity='COMMON', uuid='s1'),
+                                                   price=49)],
+                                    'relics': [relic], 'potions': [potion],
+                                    'purge_available': True, 'purge_cost': 75},
+                 ['choose', 'leave'], room_type='ShopRoom', choice_list=['purge', 'anger', 'anchor', 'block potion'],
+                 gold=114),
+        _in_game(2, 'GRID', {'cards': [_strike(n) for n in range(5)] + [_defend(n) for n in range(4)],
+                             'selected_cards': [], 'num_cards': 1, 'any_number': False, 'confirm_up': False,
+                             'for_upgrade': False, 'for_transform': False, 'for_purge': True},
+                 ['choose'], room_type='ShopRoom', choice_list=['strike'] * 5 + ['defend'] * 4, gold=39),
+        _in_game(2, 'SHOP_ROOM', {}, ['choose', 'proceed'], room_type='ShopRoom', choice_list=['shop'], gold=39),
+        _in_game(3, 'REST', {'has_rested': False, 'rest_options': ['rest', 'smith']},
+                 ['choose'], room_type='RestRoom', choice_list=['rest', 'smith'], gold=39),
+        _in_game(3, 'REST', {'has_rested': True, 'rest_options': []},
+                 ['proceed'], room_type='RestRoom', gold=39),
+        _in_game(4, 'CHEST', {'chest_type': 'MediumChest', 'chest_open': False},
+                 ['choose', 'proceed'], room_type='TreasureRoom', choice_list=['open'], gold=39),
+        _in_game(4, 'CHEST', {'chest_type': 'MediumChest', 'chest_open': True},
+                 ['proceed'], room_type='TreasureRoom', gold=39),
+        _in_game(5, 'BOSS_REWARD', {'relics': [dict(relic, id='Cursed Key', name='Cursed Key'),
+                                               dict(relic, id='Sozu', name='Sozu')]},
+                 ['choose', 'skip'], room_type='TreasureRoom', choice_list=['cursed key', 'sozu'], gold=39),
+        _in_game(5, 'GAME_OVER', {'score': 42, 'victory': False}, ['proceed'], room_phase='COMPLETE', hp=0,
+                 gold=39),
+        menu,
+    ]
+
+
+def load_script(path):
+    """Read a script from a JSON Lines file
+
+    :param path: file with one Communication Mod message per line (blank lines are skipped)
+    :type path: str
+    :return: the messages
+    :rtype: list[dict]
+    """
+    with open(path, 'r', encoding='utf-8') as f:
+        script = [json.loads(line) for line in f if line.strip()]
+    if not script:
+        raise ValueError(f"Mock script {path} is empty")
+    return script
+
+
+class MockGame:
+    """Answers Communication Mod commands from a script, instantly
+
+    respond() holds the whole behaviour and can be used on its own; attach()
+    connects it to a Coordinator's queues in place of stdin/stdout.
+    """
+
+    def __init__(self, script=None, delay=0.0):
+        """
+        :param script: Communication Mod messages to answer with (default: default_script())
+        :type script: list[dict]
+        :param delay: seconds to wait before answering each command, to imitate the game's pace
+        :type delay: float
+        """
+        script = script or default_script()
+        self.script = [json.dumps(message) for message in script]  # Encoded once; answers are just lookups
+        self._commands = [self._allowed(message) for message in script]
+        self.delay = delay
+        self.position = 0
+        self.commands_received = 0
+
+    @staticmethod
+    def _allowed(message):
+        # Normalised like incoming verbs, so "skip", "cancel" and "leave" all match a listed "skip"
+        commands = message.get('available_commands', ())
+        return {_COMMAND_ALIASES.get(command, command) for command in commands} | set(_QUERY_COMMANDS)
+
+    def respond(self, command):
+        """Get the message the game answers a command with
+
+        :param command: a line written to Communication Mod ("ready", "play 1 0", "end", ...)
+        :type command: str
+        :return: the JSON line to hand back
+        :rtype: str
+        """
+        self.commands_received += 1
+        if command == 'ready':
+            return self.script[self.position]
+
+        name = command.split(' ', 1)[0].lower()
+        verb = _COMMAND_ALIASES.get(name, name)
+        if verb not in self._commands[self.position]:
+            return json.dumps({
+                'error': f"Invalid command: {name}. Possible commands: {sorted(self._commands[self.position])}",
+                'ready_for_command': True
+            })
+        if verb not in _QUERY_COMMANDS:
+            self.position = (self.position + 1) % len(self.script)
+        return self.script[self.position]
+
+    def attach(self, input_queue, output_queue, wakeup=None):
+        """Serve a Coordinator's queues from a background thread
+
+        :param input_queue: the queue the coordinator reads game messages from
+        :type input_queue: queue.Queue
+        :param output_queue: the queue the coordinator writes commands to
+        :type output_queue: queue.Queue
+        :param wakeup: an event set after each answer is queued
+        :type wakeup: threading.Event
+        :return: None
+        """
+        def serve():
+            while True:
+                command = output_queue.get()
+                if self.delay:
+                    time.sleep(self.delay)
+                input_queue.put(self.respond(command))
+                if wakeup is not None:
+                    wakeup.set()
+
+        threading.Thread(target=serve, daemon=True).start()
+        logger.info(f"Mock game serving a {len(self.script)}-state script")
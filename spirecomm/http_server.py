@@ -6,31 +6,73 @@ Wraps the Coordinator with an HTTP interface, providing endpoints for
 querying game state and sending actions.
 
 Usage:
-    python -m spirecomm.http_server [--port PORT] [--host HOST] [--debug] [--log-file FILE]
+    python -m spirecomm.http_server [--port PORT] [--host HOST] [--unix-socket PATH] [--shm PATH]
+                                    [--mock] [--mock-script FILE] [--debug] [--log-file FILE]
 
 Endpoints:
     GET  /health  - Health check and queue status
-    GET  /state   - Current game state
-    POST /action  - Queue an action
+    GET  /state   - Current game state (supports long-polling via ?since=&wait=)
+    GET  /stream  - Server-Sent Events stream of every new state
+    GET  /metrics - Timing and queue telemetry (Prometheus text format)
+    POST /action  - Queue an action, or a batch of actions
     POST /clear   - Clear action queue
 
 For complete API documentation, see HTTP_API.md
 """
 
+import collections
 import json
 import logging
+import os
+import socket
+import socketserver
 import sys
 import threading
+import time
 from datetime import datetime
 from http.server import BaseHTTPRequestHandler, HTTPServer
 from socketserver import ThreadingMixIn
+from urllib.parse import parse_qs, urlsplit
 
 from spirecomm.communication.action_factory import action_from_json
 from spirecomm.communication.coordinator import Coordinator
+from spirecomm.communication import mock_game
+from spirecomm.json_patch import make_patch
+from spirecomm.metrics import ServerMetrics
+from spirecomm import metrics
+from spirecomm.shm_ring import SharedMemoryRing
+from spirecomm import wire_format
 
 # Global logger
 logger = None
 
+# Upper bound on how long a single long-poll request may block (seconds)
+MAX_LONG_POLL_WAIT = 30.0
+
+# Number of served /state snapshots kept as bases for delta responses
+SNAPSHOT_HISTORY = 32
+
+# Interval between keep-alive comments on an idle /stream connection (seconds)
+STREAM_KEEPALIVE = 5.0
+
+# Idle time after which a persistent connection is closed by the server (seconds)
+KEEPALIVE_TIMEOUT = 120.0
+
+# Longest the coordinator sleeps without a wake-up before re-checking its queues (seconds)
+COORDINATOR_IDLE_TIMEOUT = 1.0
+
+# Default size of the --shm state ring (MiB); holds many states, so readers are rarely lapped
+SHM_STATE_RING_MB = 8
+
+# Size of the --shm action ring (bytes)
+SHM_ACTION_RING_SIZE = 256 * 1024
+
+# Longest the --shm action reader sleeps between polls of an empty ring (seconds)
+SHM_ACTION_POLL_MAX = 0.001
+
+# Paths counted individually in /metrics (anything else is counted as "other")
+METRIC_PATHS = frozenset(('/health', '/state', '/stream', '/metrics', '/action', '/clear'))
+
 
 def setup_logger(log_file=None, debug=False):
     """Setup file-based logger for both http_server and coordinator"""
@@ -68,6 +110,12 @@ def setup_logger(log_file=None, debug=False):
     coord_logger.addHandler(file_handler)
     # No console handler for coordinator to reduce noise
 
+    # Configure mock game logger (--mock)
+    mock_logger = logging.getLogger('spirecomm.mock_game')
+    mock_logger.setLevel(logging.DEBUG if debug else logging.INFO)
+    mock_logger.handlers = []
+    mock_logger.addHandler(file_handler)
+
     logger.info(f"SpireComm HTTP Server starting. Logging to: {log_file}")
     return log_file
 
@@ -80,27 +128,448 @@ except ImportError:
         daemon_threads = True
 
 
+class ThreadingUnixHTTPServer(ThreadingHTTPServer):
+    """ThreadingHTTPServer listening on a Unix domain socket instead of TCP
+
+    For a client on the same host this skips the loopback TCP stack, and a
+    socket path per instance needs no port allocation.
+    """
+
+    address_family = getattr(socket, 'AF_UNIX', None)
+
+    def server_bind(self):
+        """Bind to the socket path, replacing a stale socket left by a previous run"""
+        if os.path.exists(self.server_address):
+            os.unlink(self.server_address)
+        # HTTPServer.server_bind would look up a host name and port
+        socketserver.TCPServer.server_bind(self)
+        self.server_name = 'localhost'
+        self.server_port = 0
+
+    def get_request(self):
+        """Accept a connection; Unix sockets have no peer address, so report a placeholder"""
+        request, _ = self.socket.accept()
+        return request, ('unix', 0)
+
+
+class StateMonitor:
+    """Monotonic version counter for the state served by /state
+
+    The version is bumped whenever the content of /state changes: a new message
+    arrives from Communication Mod, or ready_for_command flips because a command
+    was sent. Request handlers can block until the version moves past the one
+    a client has already seen.
+
+    It also keeps the last few /state bodies, keyed by version, so older
+    versions can act as the base for JSON-patch deltas. A body is built by
+    the thread that bumps the version, in the same step, so it always holds
+    the content of its own version and never that of a later one. Their
+    encodings in each wire format are cached alongside, so a version is
+    encoded at most once per format.
+    """
+
+    def __init__(self, build):
+        """
+        :param build: callable taking a version and returning its /state body (or None)
+        """
+        self.version = 0
+        self._build = build
+        self._condition = threading.Condition()
+        self._snapshots = collections.OrderedDict()
+        self._encoded = {}
+
+    def bump(self):
+        """Advance the version, store its body and wake any waiting request handlers
+
+        :return: the new version
+        :rtype: int
+        """
+        with self._condition:
+            self.version += 1
+            body = self._build(self.version)
+            if body is not None:
+                self._snapshots[self.version] = body
+                while len(self._snapshots) > SNAPSHOT_HISTORY:
+                    evicted, _ = self._snapshots.popitem(last=False)
+                    for key in [key for key in self._encoded if key[0] == evicted]:
+                        del self._encoded[key]
+            self._condition.notify_all()
+            return self.version
+
+    def wait_for_change(self, since, timeout):
+        """Block until the version differs from since, or the timeout expires
+
+        :param since: the version the caller has already seen
+        :type since: int
+        :param timeout: maximum time to wait, in seconds
+        :type timeout: float
+        :return: the current version (equal to since on timeout)
+        :rtype: int
+        """
+        with self._condition:
+            self._condition.wait_for(lambda: self.version != since, timeout)
+            return self.version
+
+    def current(self):
+        """Get the current version and its /state body together
+
+        :return: (version, body), body being None if no state has been received yet
+        :rtype: tuple
+        """
+        with self._condition:
+            return self.version, self._snapshots.get(self.version)
+
+    def encoded(self, version, fmt, body):
+        """Get a snapshot body encoded in a wire format, encoding it on first use
+
+        :param version: the state version of body
+        :type version: int
+        :param fmt: the wire format (see spirecomm.wire_format)
+        :type fmt: str
+        :param body: the body returned by current() for this version
+        :type body: dict
+        :return: the encoded body
+        :rtype: bytes
+        """
+        key = (version, fmt)
+        with self._condition:
+            cached = self._encoded.get(key)
+        if cached is not None:
+            return cached
+
+        data = wire_format.encode(fmt, body)
+        with self._condition:
+            if version in self._snapshots:
+                data = self._encoded.setdefault(key, data)
+            return data
+
+    def previous_snapshot(self, version):
+        """Get a previously served body, if still retained
+
+        :param version: the state version the client already has
+        :type version: int
+        :return: the body served for that version, or None
+        :rtype: dict
+        """
+        with self._condition:
+            return self._snapshots.get(version)
+
+
+class ActionBatch:
+    """Actions queued together by one POST /action request
+
+    A batch is a plan computed against a single state, such as a full combat
+    turn. With abort_on_divergence set, the actions still queued are dropped as
+    soon as the game reports an error or leaves the context the first action
+    was executed in (left the game, or the screen type or room phase changed),
+    since their indices no longer refer to the state the plan was made for.
+    """
+
+    def __init__(self, actions, abort_on_divergence=True):
+        self.actions = actions
+        self.abort_on_divergence = abort_on_divergence
+        self.context = None
+        for action in actions:
+            action.batch = self
+
+    def pending(self, coordinator):
+        """Get the actions of this batch that have not been executed yet
+
+        :param coordinator: the coordinator holding the action queue
+        :return: the batch's actions still in the queue
+        :rtype: list[Action]
+        """
+        return [action for action in list(coordinator.action_queue) if getattr(action, 'batch', None) is self]
+
+    def diverged(self, coordinator):
+        """Check whether the latest state no longer matches the state the batch started in
+
+        :param coordinator: the coordinator holding the latest state
+        :return: True if the rest of the batch should be dropped
+        :rtype: bool
+        """
+        return coordinator.last_error is not None or _batch_context(coordinator) != self.context
+
+
+class ActionIds:
+    """Ids of queued actions, and the newest one that has been resolved
+
+    Every action gets the next id of one increasing sequence when it is
+    queued. It is resolved once the game has answered it (the next message
+    after sending it), or when it is discarded without being sent (/clear, or
+    a diverged batch). /state reports the highest resolved id as
+    last_action_id, so the first ready state with last_action_id >= N is the
+    result of action N.
+    """
+
+    def __init__(self):
+        self.last_assigned = 0
+        self.resolved = 0
+        self._lock = threading.Lock()
+
+    def assign(self, actions):
+        """Give each action the next id
+
+        :param actions: the actions about to be queued, in order
+        :type actions: list[Action]
+        :return: the ids assigned
+        :rtype: list[int]
+        """
+        with self._lock:
+            first = self.last_assigned + 1
+            self.last_assigned += len(actions)
+        for action_id, action in enumerate(actions, first):
+            action.action_id = action_id
+        return list(range(first, first + len(actions)))
+
+    def resolve(self, actions):
+        """Mark actions as answered or discarded
+
+        :param actions: the actions (those without an id are ignored)
+        :type actions: list[Action]
+        :return: True if the newest resolved id moved
+        :rtype: bool
+        """
+        ids = [getattr(action, 'action_id', 0) for action in actions]
+        with self._lock:
+            resolved = self.resolved
+            self.resolved = max([resolved, *ids])
+            return self.resolved != resolved
+
+
+def _batch_context(coordinator):
+    """Summarize the parts of the state a batch's remaining actions depend on"""
+    game_state = coordinator.last_game_state
+    if not coordinator.in_game or game_state is None:
+        return (False, None, None)
+    return (True, game_state.screen_type, game_state.room_phase)
+
+
+def build_state_response(coordinator, version, last_action_id=0):
+    """Serialize the coordinator's current state for /state
+
+    :param coordinator: the coordinator holding the state
+    :type coordinator: Coordinator
+    :param version: the state version to stamp into the response
+    :type version: int
+    :param last_action_id: the newest resolved action id (see ActionIds)
+    :type last_action_id: int
+    :return: the response body, or None if no state has been received yet
+    :rtype: dict
+    """
+    game_state = coordinator.last_game_state
+
+    if game_state is None:
+        return None
+
+    response = {
+        'in_game': coordinator.in_game,
+        'ready_for_command': coordinator.game_is_ready,
+        'state_version': version,
+        'last_action_id': last_action_id,
+        'game_state': game_state.to_json()
+    }
+
+    # Add available commands
+    available_commands = []
+    if game_state.play_available:
+        available_commands.append('play')
+    if game_state.end_available:
+        available_commands.append('end')
+    if game_state.potion_available:
+        available_commands.append('potion')
+    if game_state.proceed_available:
+        available_commands.append('proceed')
+    if game_state.cancel_available:
+        available_commands.append('cancel')
+
+    response['available_commands'] = available_commands
+    return response
+
+
+def queue_actions(server, action_data):
+    """Queue a decoded /action body: a single action, or a batch
+
+    A batch is a JSON array of actions, or an object with an "actions" array
+    and an optional "abort_on_divergence" flag (default true). Every action
+    is validated before any is queued, so an error leaves the queue untouched.
+
+    :param server: the SpireCommServer, or its HTTP server (anything with
+        coordinator, metrics, action_ids and debug attributes)
+    :param action_data: the decoded body
+    :return: the /action response body
+    :rtype: dict
+    :raises ValueError: if the body is not a valid action or batch
+    """
+    if isinstance(action_data, list) or (isinstance(action_data, dict) and 'actions' in action_data):
+        return _queue_batch(server, action_data)
+
+    coordinator, debug = server.coordinator, server.debug
+    action = action_from_json(action_data)
+
+    if debug:
+        logger.debug(f"[HTTP] Created action object: {type(action).__name__}")
+
+    # Queue action in coordinator
+    action_id, = server.action_ids.assign([action])
+    server.metrics.action_queued(action)
+    coordinator.add_action_to_queue(action)
+
+    if debug:
+        logger.debug(f"[HTTP] Queued action {action_id}. Queue size: {len(coordinator.action_queue)}")
+
+    return {
+        'status': 'queued',
+        'action': action_data.get('type'),
+        'action_id': action_id
+    }
+
+
+def _queue_batch(server, batch_data):
+    """Queue a batch of actions (see queue_actions)"""
+    coordinator = server.coordinator
+    if isinstance(batch_data, list):
+        actions_data = batch_data
+        abort_on_divergence = True
+    else:
+        actions_data = batch_data.get('actions')
+        abort_on_divergence = bool(batch_data.get('abort_on_divergence', True))
+
+    if not isinstance(actions_data, list) or not actions_data:
+        raise ValueError("Batch must contain a non-empty list of actions")
+    for index, item in enumerate(actions_data):
+        if not isinstance(item, dict):
+            raise ValueError(f"Batch action {index} is not an object")
+
+    actions = [action_from_json(item) for item in actions_data]
+    ActionBatch(actions, abort_on_divergence)
+    action_ids = server.action_ids.assign(actions)
+    for action in actions:
+        server.metrics.action_queued(action)
+    coordinator.add_actions_to_queue(actions)
+
+    if server.debug:
+        logger.debug(f"[HTTP] Queued batch of {len(actions)} action(s). "
+                     f"Queue size: {len(coordinator.action_queue)}")
+
+    return {
+        'status': 'queued',
+        'actions': [item.get('type') for item in actions_data],
+        'action_ids': action_ids,
+        'count': len(actions),
+        'abort_on_divergence': abort_on_divergence
+    }
+
+
+def _int_param(params, name, default=None):
+    """Read an integer query parameter, returning default if missing or malformed"""
+    values = params.get(name)
+    if not values:
+        return default
+    try:
+        return int(values[0])
+    except ValueError:
+        return default
+
+
 class SpireCommHTTPHandler(BaseHTTPRequestHandler):
-    """HTTP request handler with access to SpireComm coordinator"""
+    """HTTP request handler with access to SpireComm coordinator
+
+    Speaks HTTP/1.1, so a client can keep one connection open across
+    requests; every response therefore carries a Content-Length (or has no
+    body). Nagle's algorithm is disabled so small responses go out at once.
+    """
+
+    protocol_version = 'HTTP/1.1'
+    disable_nagle_algorithm = True
+    timeout = KEEPALIVE_TIMEOUT
+
+    def setup(self):
+        """Disable Nagle on TCP connections only (Unix sockets have no such option)"""
+        if self.server.address_family not in (socket.AF_INET, socket.AF_INET6):
+            self.disable_nagle_algorithm = False
+        super().setup()
 
     def log_message(self, format, *args):
         """Suppress default HTTP logging unless debug enabled"""
         if self.server.debug:
             super().log_message(format, *args)
 
-    def _send_json_response(self, status_code, data):
-        """Send JSON response with proper headers"""
+    def _wire_format(self):
+        """Get the response format negotiated from the request's Accept header"""
+        return wire_format.negotiate(self.headers.get('Accept'))
+
+    def _send_json_response(self, status_code, data, headers=None, encoded=None):
+        """Send a JSON-compatible body, encoded in the format the client accepts
+
+        :param encoded: data already encoded in that format (e.g. a cached snapshot)
+        """
+        fmt = self._wire_format()
+        body = encoded if encoded is not None else wire_format.encode(fmt, data)
+        self.send_response(status_code)
+        self.send_header('Content-Type', wire_format.content_type(fmt))
+        self.send_header('Content-Length', str(len(body)))
+        self.send_header('Vary', 'Accept')
+        self.send_header('Access-Control-Allow-Origin', '*')
+        for name, value in (headers or {}).items():
+            self.send_header(name, value)
+        self.end_headers()
+        self.wfile.write(body)
+
+    def _send_text_response(self, status_code, text, content_type):
+        """Send a plain-text body (e.g. /metrics)"""
+        body = text.encode('utf-8')
+        self.send_response(status_code)
+        self.send_header('Content-Type', content_type)
+        self.send_header('Content-Length', str(len(body)))
+        self.send_header('Access-Control-Allow-Origin', '*')
+        self.end_headers()
+        self.wfile.write(body)
+
+    def _count_request(self, path):
+        """Count a request in /metrics, folding unknown paths together"""
+        self.server.metrics.request(path if path in METRIC_PATHS else 'other')
+
+    def _send_empty_response(self, status_code, headers=None):
+        """Send a response without a body (e.g. 304 Not Modified)"""
         self.send_response(status_code)
-        self.send_header('Content-Type', 'application/json')
         self.send_header('Access-Control-Allow-Origin', '*')
+        for name, value in (headers or {}).items():
+            self.send_header(name, value)
         self.end_headers()
-        self.wfile.write(json.dumps(data).encode('utf-8'))
+
+    def _client_state_version(self, params):
+        """Get the state version the client already has
+
+        Taken from the ?since= query parameter, or failing that from an
+        If-None-Match header carrying a previously served ETag.
+
+        :return: the client's version, or None if it sent neither
+        :rtype: int
+        """
+        since = _int_param(params, 'since')
+        if since is not None:
+            return since
+        etag = self.headers.get('If-None-Match')
+        if etag:
+            etag = etag.split(',')[0].strip()
+            if etag.startswith('W/'):
+                etag = etag[2:]
+            try:
+                return int(etag.strip('"'))
+            except ValueError:
+                return None
+        return None
 
     def do_GET(self):
         """Handle GET requests"""
         coordinator = self.server.coordinator
+        url = urlsplit(self.path)
+        path = url.path
+        params = parse_qs(url.query)
+        self._count_request(path)
 
-        if self.path == '/health':
+        if path == '/health':
             # Health check
             self._send_json_response(200, {
                 'status': 'ready',
@@ -110,41 +579,55 @@ class SpireCommHTTPHandler(BaseHTTPRequestHandler):
                 'queue_size': len(coordinator.action_queue)
             })
 
-        elif self.path == '/state':
-            # Get current game state
-            game_state = coordinator.last_game_state
-
-            if game_state is None:
+        elif path == '/state':
+            # Get current game state, optionally long-polling for a newer version
+            monitor = self.server.state_monitor
+            since = self._client_state_version(params)
+            wait_ms = _int_param(params, 'wait', 0)
+
+            if since is not None and wait_ms > 0:
+                monitor.wait_for_change(since, min(wait_ms / 1000.0, MAX_LONG_POLL_WAIT))
+            version, response = monitor.current()
+            if since is not None and version == since:
+                # Client already has this version - skip the body entirely
+                self._send_empty_response(304, {'ETag': f'"{version}"'})
+                return
+
+            if response is None:
                 # No state available yet
-                self._send_json_response(204, {})
-            else:
-                # Serialize game state
-                response = {
-                    'in_game': coordinator.in_game,
-                    'ready_for_command': coordinator.game_is_ready,
-                    'game_state': game_state.to_json()
-                }
-
-                # Add available commands
-                available_commands = []
-                if game_state.play_available:
-                    available_commands.append('play')
-                if game_state.end_available:
-                    available_commands.append('end')
-                if game_state.potion_available:
-                    available_commands.append('potion')
-                if game_state.proceed_available:
-                    available_commands.append('proceed')
-                if game_state.cancel_available:
-                    available_commands.append('cancel')
-
-                response['available_commands'] = available_commands
-
-                self._send_json_response(200, response)
-
-        elif self.path == '/clear':
-            # Clear the action queue
+                self._send_empty_response(204)
+                return
+
+            # Delta mode: patch against the version the client already has, when retained
+            if since is not None and _int_param(params, 'delta', 0):
+                base = monitor.previous_snapshot(since)
+                if base is not None:
+                    self._send_json_response(200, {
+                        'state_version': version,
+                        'base_version': since,
+                        'patch': make_patch(base, response)
+                    }, {'ETag': f'"{version}"'})
+                    return
+
+            # Full snapshot (also the fallback when the client's base version is gone)
+            encoded = monitor.encoded(version, self._wire_format(), response)
+            self._send_json_response(200, response, {'ETag': f'"{version}"'}, encoded)
+
+        elif path == '/stream':
+            # Push every new state over this connection (Server-Sent Events)
+            self._stream_states(params)
+
+        elif path == '/metrics':
+            # Server-side timing and queue telemetry
+            body = self.server.metrics.render(len(coordinator.action_queue), self.server.state_monitor.version)
+            self._send_text_response(200, body, metrics.CONTENT_TYPE)
+
+        elif path == '/clear':
+            # Clear the action queue; clients waiting on the cleared actions see it in last_action_id
+            resolved = self.server.action_ids.resolve(list(coordinator.action_queue))
             coordinator.clear_actions()
+            if resolved:
+                self.server.state_monitor.bump()
 
             if self.server.debug:
                 logger.debug("[HTTP] Action queue cleared (GET)")
@@ -157,36 +640,75 @@ class SpireCommHTTPHandler(BaseHTTPRequestHandler):
         else:
             self._send_json_response(404, {'error': 'Not found'})
 
+    def _stream_states(self, params):
+        """Serve /stream: one Server-Sent Event per state version, until the client disconnects
+
+        Each event carries the same body /state would serve for that version,
+        with the version as the event id. Versions that are superseded before
+        the handler wakes are coalesced, so a slow client only ever receives
+        the newest state. A comment line is sent on idle connections to detect
+        clients that went away.
+        """
+        monitor = self.server.state_monitor
+        since = _int_param(params, 'since')
+        if since is None:
+            # EventSource reconnects resume from the last id they received
+            try:
+                since = int(self.headers.get('Last-Event-ID', 0))
+            except ValueError:
+                since = 0
+
+        self.send_response(200)
+        self.send_header('Content-Type', 'text/event-stream')
+        self.send_header('Cache-Control', 'no-cache')
+        self.send_header('Connection', 'close')  # No length; the stream ends when the connection does
+        self.send_header('Access-Control-Allow-Origin', '*')
+        self.end_headers()
+
+        if self.server.debug:
+            logger.debug(f"[HTTP] Stream opened (since={since})")
+
+        sent = since
+        try:
+            while True:
+                if monitor.version == sent:
+                    monitor.wait_for_change(sent, STREAM_KEEPALIVE)
+                version, response = monitor.current()
+                if version == sent:
+                    self.wfile.write(b': keepalive\n\n')
+                    self.wfile.flush()
+                    continue
+
+                sent = version
+                if response is None:
+                    continue  # No state received from the game yet
+
+                event = f'id: {version}\nevent: state\ndata: {json.dumps(response)}\n\n'
+                self.wfile.write(event.encode('utf-8'))
+                self.wfile.flush()
+        except (BrokenPipeError, ConnectionResetError):
+            if self.server.debug:
+                logger.debug("[HTTP] Stream closed by client")
+
     def do_POST(self):
         """Handle POST requests"""
         coordinator = self.server.coordinator
+        path = urlsplit(self.path).path
+        self._count_request(path)
 
-        if self.path == '/action':
+        if path == '/action':
             # Queue an action
             content_length = int(self.headers.get('Content-Length', 0))
-            body = self.rfile.read(content_length).decode('utf-8')
+            body = self.rfile.read(content_length)
 
             try:
-                action_data = json.loads(body)
+                # JSON, or MessagePack/CBOR when the Content-Type says so
+                action_data = wire_format.decode(wire_format.format_for_content_type(self.headers.get('Content-Type')), body)
 
                 if self.server.debug:
                     logger.debug(f"[HTTP] Received action: {action_data}")
 
-                action = action_from_json(action_data)
-
-                if self.server.debug:
-                    logger.debug(f"[HTTP] Created action object: {type(action).__name__}")
-
-                # Queue action in coordinator
-                coordinator.add_action_to_queue(action)
-
-                if self.server.debug:
-                    logger.debug(f"[HTTP] Queued action. Queue size: {len(coordinator.action_queue)}")
-
-                self._send_json_response(200, {
-                    'status': 'queued',
-                    'action': action_data.get('type')
-                })
+                self._send_json_response(200, queue_actions(self.server, action_data))
 
             except ValueError as e:
                 logger.error(f"[HTTP] ValueError: {e}")
@@ -207,9 +729,12 @@ class SpireCommHTTPHandler(BaseHTTPRequestHandler):
                     'error': str(e)
                 })
 
-        elif self.path == '/clear':
-            # Clear the action queue
+        elif path == '/clear':
+            # Clear the action queue; clients waiting on the cleared actions see it in last_action_id
+            resolved = self.server.action_ids.resolve(list(coordinator.action_queue))
             coordinator.clear_actions()
+            if resolved:
+                self.server.state_monitor.bump()
 
             if self.server.debug:
                 logger.debug("[HTTP] Action queue cleared")
@@ -228,21 +753,38 @@ class SpireCommHTTPHandler(BaseHTTPRequestHandler):
         self.send_header('Access-Control-Allow-Origin', '*')
         self.send_header('Access-Control-Allow-Methods', 'GET, POST, OPTIONS')
         self.send_header('Access-Control-Allow-Headers', 'Content-Type')
+        self.send_header('Content-Length', '0')
         self.end_headers()
 
 
 class SpireCommServer:
     """Wraps Coordinator with HTTP interface"""
 
-    def __init__(self, host='127.0.0.1', port=8080, debug=False):
+    def __init__(self, host='127.0.0.1', port=8080, debug=False, unix_socket=None, shm_path=None,
+                 shm_size_mb=SHM_STATE_RING_MB, game=None):
         self.host = host
         self.port = port
+        self.unix_socket = unix_socket  # Listen on this socket path instead of host:port
+        self.shm_path = shm_path        # Also serve states and actions through this shared-memory file
+        self.shm_size_mb = shm_size_mb
+        self.shm_ring = None
         self.debug = debug
-        self.coordinator = Coordinator()
+        self.coordinator = Coordinator(game)  # game: a MockGame to serve instead of Communication Mod
+        self.state_monitor = StateMonitor(
+            lambda version: build_state_response(self.coordinator, version, self.action_ids.resolved))
+        self.metrics = ServerMetrics()
+        self.active_batch = None  # Batch of the action executed last
+        self.action_ids = ActionIds()
+        self.awaiting_answer = None  # Action sent to the game that has not been answered yet
         self.server = None
 
     def _coordinator_loop(self):
-        """Custom coordinator loop that polls state without callbacks"""
+        """Custom coordinator loop that polls state without callbacks
+
+        Sleeps in Coordinator.wait_for_work() whenever an iteration finds
+        nothing to do, so an idle server uses no CPU; it wakes when a line
+        arrives from Communication Mod or a request queues an action.
+        """
         try:
             while True:
                 # Check if we have actions to execute
@@ -251,14 +793,32 @@ class SpireCommServer:
                                 f"Ready: {self.coordinator.game_is_ready}")
 
                 # Execute any queued actions
+                was_ready = self.coordinator.game_is_ready
                 executed = self.coordinator.execute_next_action_if_ready()
 
-                if executed and self.debug:
-                    logger.debug(f"[COORDINATOR] Action executed. Queue remaining: {len(self.coordinator.action_queue)}")
+                if executed:
+                    self.metrics.action_executed(self.coordinator.last_executed_action)
+                    self._on_action_executed(self.coordinator.last_executed_action)
+                    if self.debug:
+                        logger.debug(f"[COORDINATOR] Action executed. Queue remaining: {len(self.coordinator.action_queue)}")
 
                 # Receive state updates but don't trigger callbacks
                 received = self.coordinator.receive_game_state_update(block=False, perform_callbacks=False)
 
+                self.metrics.loop_iterations += 1
+                if received:
+                    self.metrics.state_received()
+                    if self.awaiting_answer is not None:
+                        self.action_ids.resolve([self.awaiting_answer])
+                        self.awaiting_answer = None
+                    self._check_active_batch()
+                elif not executed:
+                    self.metrics.idle_iterations += 1
+
+                # Wake long-polling /state requests whenever what they would see changes
+                if received or self.coordinator.game_is_ready != was_ready:
+                    self.state_monitor.bump()
+
                 if received and self.debug:
                     game_state = self.coordinator.last_game_state
                     screen_type = game_state.screen_type.name if game_state and game_state.screen_type else "NONE"
@@ -266,12 +826,102 @@ class SpireCommServer:
                     logger.debug(f"[COORDINATOR] State update: in_game={self.coordinator.in_game}, "
                                 f"ready={self.coordinator.game_is_ready}, "
                                 f"screen={screen_type}, room={room_type}")
+
+                if not executed and not received:
+                    self.coordinator.wait_for_work(COORDINATOR_IDLE_TIMEOUT)
         except (EOFError, BrokenPipeError):
             # Game disconnected - shut down server
             logger.info("Game disconnected, shutting down...")
             if self.server:
                 self.server.shutdown()
 
+    def _on_action_executed(self, action):
+        """Track the batch of the action just sent to the game, and await its answer"""
+        self.awaiting_answer = action
+        batch = getattr(action, 'batch', None)
+        if batch is not None and batch.context is None:
+            # The first action ran against the state the plan was made for
+            batch.context = _batch_context(self.coordinator)
+        self.active_batch = batch
+
+    def _check_active_batch(self):
+        """Drop the rest of the running batch if the new state diverged from its plan"""
+        batch = self.active_batch
+        if batch is None or not batch.abort_on_divergence:
+            return
+
+        pending = batch.pending(self.coordinator)
+        if not pending:
+            self.active_batch = None
+            return
+
+        if batch.diverged(self.coordinator):
+            for action in pending:
+                try:
+                    self.coordinator.action_queue.remove(action)
+                except ValueError:
+                    pass  # Cleared or executed concurrently
+            self.action_ids.resolve(pending)
+            self.active_batch = None
+            reason = self.coordinator.last_error or "state changed"
+            logger.info(f"[COORDINATOR] Batch diverged ({reason}), dropped {len(pending)} queued action(s)")
+
+    def _publish_shm_states(self):
+        """Append every new state version to the shared-memory state ring
+
+        Publishes the same JSON body /state serves, from the same snapshot
+        cache, so HTTP and shared-memory clients always agree.
+        """
+        monitor = self.state_monitor
+        published = 0
+        while True:
+            monitor.wait_for_change(published, MAX_LONG_POLL_WAIT)
+            version, response = monitor.current()
+            if version == published:
+                continue
+            published = version
+            if response is None:
+                continue  # No state received from the game yet
+
+            body = monitor.encoded(version, wire_format.JSON, response)
+            if not self.shm_ring.publish_state(version, body):
+                logger.error(f"[SHM] State {version} ({len(body)} bytes) does not fit in the state ring")
+
+    def _read_shm_actions(self):
+        """Queue actions written to the shared-memory action ring
+
+        Polls with a backoff from 50us up to SHM_ACTION_POLL_MAX, since the
+        client has no way to wake this thread. The id of the (last) queued
+        action is written back into its record for the client to read.
+        """
+        def queue(body):
+            try:
+                action_data = json.loads(body)
+                if self.debug:
+                    logger.debug(f"[SHM] Received action: {action_data}")
+                self.metrics.request('/action')
+                response = queue_actions(self, action_data)
+                return response['action_ids'][-1] if 'action_ids' in response else response['action_id']
+            except Exception as e:
+                # The client already considers the action sent; all we can do is log it
+                logger.error(f"[SHM] Dropped invalid action: {e}")
+                return 0
+
+        delay = 0.00005
+        while True:
+            if self.shm_ring.poll_actions(queue):
+                delay = 0.00005
+            else:
+                time.sleep(delay)
+                delay = min(delay * 2, SHM_ACTION_POLL_MAX)
+
+    def _start_shm(self):
+        """Create the shared-memory file and start its publisher and reader threads"""
+        self.shm_ring = SharedMemoryRing(self.shm_path, self.shm_size_mb * 1024 * 1024, SHM_ACTION_RING_SIZE)
+        for target in (self._publish_shm_states, self._read_shm_actions):
+            threading.Thread(target=target, daemon=True).start()
+        logger.info(f"Shared-memory transport at {self.shm_path} ({self.shm_size_mb} MiB state ring)")
+
     def run(self):
         """Start the HTTP server"""
         logger.info("Sending ready handshake...")
@@ -288,12 +938,23 @@ class SpireCommServer:
         )
         coordinator_thread.start()
 
+        if self.shm_path:
+            self._start_shm()
+
         # Create HTTP server
-        self.server = ThreadingHTTPServer((self.host, self.port), SpireCommHTTPHandler)
+        if self.unix_socket:
+            self.server = ThreadingUnixHTTPServer(self.unix_socket, SpireCommHTTPHandler)
+            listening_on = f"unix:{self.unix_socket}"
+        else:
+            self.server = ThreadingHTTPServer((self.host, self.port), SpireCommHTTPHandler)
+            listening_on = f"http://{self.host}:{self.port}"
         self.server.coordinator = self.coordinator
+        self.server.state_monitor = self.state_monitor
+        self.server.metrics = self.metrics
+        self.server.action_ids = self.action_ids
         self.server.debug = self.debug
 
-        logger.info(f"HTTP server listening on http://{self.host}:{self.port}")
+        logger.info(f"HTTP server listening on {listening_on}")
         logger.info(f"Debug mode: {self.debug}")
         logger.info("Ready for connections")
 
@@ -303,6 +964,11 @@ class SpireCommServer:
         except KeyboardInterrupt:
             logger.info("Shutting down...")
             self.server.shutdown()
+        finally:
+            if self.unix_socket and os.path.exists(self.unix_socket):
+                os.unlink(self.unix_socket)
+            if self.shm_ring:
+                self.shm_ring.close()
 
 
 def main():
@@ -314,12 +980,26 @@ def main():
                         help='HTTP server port (default: 8080)')
     parser.add_argument('--host', type=str, default='127.0.0.1',
                         help='HTTP server host (default: 127.0.0.1)')
+    parser.add_argument('--unix-socket', type=str, default=None,
+                        help='Listen on this Unix domain socket path instead of host:port')
+    parser.add_argument('--shm', type=str, default=None, metavar='PATH',
+                        help='Also serve states and actions through a shared-memory file (e.g. /dev/shm/spirecomm)')
+    parser.add_argument('--shm-size', type=int, default=SHM_STATE_RING_MB, metavar='MB',
+                        help=f'Size of the shared-memory state ring in MiB (default: {SHM_STATE_RING_MB})')
+    parser.add_argument('--mock', action='store_true',
+                        help='Answer from a scripted mock game instead of Communication Mod (for load tests)')
+    parser.add_argument('--mock-script', type=str, default=None, metavar='PATH',
+                        help='JSON Lines file of Communication Mod messages for --mock (default: built-in run)')
+    parser.add_argument('--mock-delay', type=float, default=0.0, metavar='MS',
+                        help='Milliseconds the mock game takes to answer each command (default: 0)')
     parser.add_argument('--debug', action='store_true',
                         help='Enable debug logging')
     parser.add_argument('--log-file', type=str, default=None,
                         help='Log file path (default: spirecomm_server_TIMESTAMP.log)')
 
     args = parser.parse_args()
+    if args.unix_socket and ThreadingUnixHTTPServer.address_family is None:
+        parser.error('--unix-socket is not supported on this platform')
 
     # Setup logging
     log_file = setup_logger(log_file=args.log_file, debug=args.debug)
@@ -327,7 +1007,14 @@ def main():
     logger.info("Starting SpireComm HTTP Server")
     logger.info(f"Log file: {log_file}")
 
-    server = SpireCommServer(host=args.host, port=args.port, debug=args.debug)
+    game = None
+    if args.mock or args.mock_script:
+        script = mock_game.load_script(args.mock_script) if args.mock_script else None
+        game = mock_game.MockGame(script, delay=args.mock_delay / 1000.0)
+        logger.info("Mock game enabled: not reading Communication Mod from stdin")
+
+    server = SpireCommServer(host=args.host, port=args.port, debug=args.debug, unix_socket=args.unix_socket,
+                             shm_path=args.shm, shm_size_mb=args.shm_size, game=game)
     server.run()
 
 
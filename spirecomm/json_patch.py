@@ -0,0 +1,78 @@
+"""
+JSON Patch - Minimal RFC 6902 diff generation
+
+Produces add/remove/replace operations that transform one JSON-compatible
+value into another. Used by the HTTP server to send state deltas instead of
+full snapshots.
+"""
+
+
+def _escape(token):
+    """Escape a reference token for use in a JSON pointer (RFC 6901)"""
+    return str(token).replace('~', '~0').replace('/', '~1')
+
+
+def _same_type(a, b):
+    """Check whether two values can be diffed member-wise rather than replaced"""
+    # bool is a subclass of int, so compare exact types
+    return type(a) is type(b)
+
+
+def _equal(a, b):
+    """Check whether two values are equal, telling 0, 0.0 and False apart at any depth"""
+    if not _same_type(a, b):
+        return False
+    if isinstance(a, dict):
+        return a.keys() == b.keys() and all(_equal(value, b[key]) for key, value in a.items())
+    if isinstance(a, list):
+        return len(a) == len(b) and all(_equal(x, y) for x, y in zip(a, b))
+    return a == b
+
+
+def _diff(src, dst, path, ops):
+    if _same_type(src, dst) and isinstance(src, dict):
+        for key in src:
+            if key not in dst:
+                ops.append({'op': 'remove', 'path': path + '/' + _escape(key)})
+        for key, value in dst.items():
+            child_path = path + '/' + _escape(key)
+            if key not in src:
+                ops.append({'op': 'add', 'path': child_path, 'value': value})
+            else:
+                _diff(src[key], value, child_path, ops)
+    elif _same_type(src, dst) and isinstance(src, list):
+        # Trim the unchanged prefix and suffix so that playing one card out of
+        # the hand becomes a single remove rather than a cascade of replaces
+        shortest = min(len(src), len(dst))
+        prefix = 0
+        while prefix < shortest and _equal(src[prefix], dst[prefix]):
+            prefix += 1
+        suffix = 0
+        while suffix < shortest - prefix and _equal(src[-1 - suffix], dst[-1 - suffix]):
+            suffix += 1
+        src_mid = src[prefix:len(src) - suffix]
+        dst_mid = dst[prefix:len(dst) - suffix]
+
+        common = min(len(src_mid), len(dst_mid))
+        for i in range(common):
+            _diff(src_mid[i], dst_mid[i], path + '/' + str(prefix + i), ops)
+        for i in range(common, len(dst_mid)):
+            ops.append({'op': 'add', 'path': path + '/' + str(prefix + i), 'value': dst_mid[i]})
+        # Remove from the end so earlier indices stay valid
+        for i in range(len(src_mid) - 1, common - 1, -1):
+            ops.append({'op': 'remove', 'path': path + '/' + str(prefix + i)})
+    elif not _equal(src, dst):
+        ops.append({'op': 'replace', 'path': path, 'value': dst})
+
+
+def make_patch(src, dst):
+    """Compute a JSON patch transforming src into dst
+
+    :param src: the document the client already has
+    :param dst: the document the client should end up with
+    :return: list of RFC 6902 operations (empty if the documents are equal)
+    :rtype: list
+    """
+    ops = []
+    _diff(src, dst, '', ops)
+    return ops
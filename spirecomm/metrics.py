@@ -0,0 +1,200 @@
+"""
+Metrics - server-side telemetry in the Prometheus text exposition format
+
+Counters, gauges and histograms recorded by the HTTP server and its
+coordinator loop, rendered for GET /metrics. Everything is kept in memory
+with fixed-size state (the state rate in one bucket per second of its
+window), so recording is cheap enough to leave on in the coordinator's hot
+loop and a scrape costs the same however fast states arrive.
+"""
+
+import bisect
+import collections
+import threading
+import time
+
+# Content-Type of the Prometheus text format
+CONTENT_TYPE = 'text/plain; version=0.0.4; charset=utf-8'
+
+# Upper bounds (seconds) of the latency histogram buckets
+LATENCY_BUCKETS = (0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0)
+
+# Window over which states_per_second is averaged (whole seconds, one bucket each)
+RATE_WINDOW = 10
+
+
+class Histogram:
+    """Cumulative histogram with fixed bucket bounds
+
+    Observations may come from several threads, so updates take a lock.
+    """
+
+    def __init__(self, buckets=LATENCY_BUCKETS):
+        self.buckets = tuple(buckets)
+        self.counts = [0] * (len(self.buckets) + 1)  # Last slot is +Inf
+        self.sum = 0.0
+        self.count = 0
+        self._lock = threading.Lock()
+
+    def observe(self, value):
+        """Record one sample
+
+        :param value: the sample (seconds for latency histograms)
+        :type value: float
+        :return: None
+        """
+        index = bisect.bisect_left(self.buckets, value)
+        with self._lock:
+            self.counts[index] += 1
+            self.sum += value
+            self.count += 1
+
+    def render(self, name, help_text):
+        """Format as Prometheus text
+
+        :return: the exposition lines for this histogram
+        :rtype: list[str]
+        """
+        with self._lock:
+            counts = list(self.counts)
+            total, count = self.sum, self.count
+
+        lines = [f'# HELP {name} {help_text}', f'# TYPE {name} histogram']
+        cumulative = 0
+        for bound, bucket_count in zip(self.buckets, counts):
+            cumulative += bucket_count
+            lines.append(f'{name}_bucket{{le="{bound}"}} {cumulative}')
+        lines.append(f'{name}_bucket{{le="+Inf"}} {count}')
+        lines.append(f'{name}_sum {total}')
+        lines.append(f'{name}_count {count}')
+        return lines
+
+
+def _scalar(name, metric_type, help_text, value):
+    return [f'# HELP {name} {help_text}', f'# TYPE {name} {metric_type}', f'{name} {value}']
+
+
+class ServerMetrics:
+    """Telemetry of one SpireCommServer
+
+    The coordinator loop is the only writer of the loop, action and state
+    counters; request handlers only count requests and observe through locks.
+    """
+
+    def __init__(self):
+        self.start_time = time.monotonic()
+        self.queue_wait = Histogram()        # Action queued -> sent to the game
+        self.game_response = Histogram()     # Command sent -> next message from the game
+        self.loop_iterations = 0
+        self.idle_iterations = 0             # Iterations that found nothing to do (each ends in a wait)
+        self.actions_executed = 0
+        self.states_received = 0
+        self.requests = collections.Counter()
+        self._requests_lock = threading.Lock()
+        self._command_sent_at = None
+        # Ring of per-second state counts: slot i counts the states of second _rate_seconds[i]
+        self._rate_seconds = [-1] * RATE_WINDOW
+        self._rate_counts = [0] * RATE_WINDOW
+
+    def action_queued(self, action):
+        """Stamp an action with the time it entered the queue
+
+        :param action: the action about to be queued
+        :type action: Action
+        :return: None
+        """
+        action.queued_at = time.monotonic()
+
+    def action_executed(self, action):
+        """Record an action sent to the game
+
+        :param action: the action just executed
+        :type action: Action
+        :return: None
+        """
+        now = time.monotonic()
+        queued_at = getattr(action, 'queued_at', None)
+        if queued_at is not None:
+            self.queue_wait.observe(now - queued_at)
+        self.actions_executed += 1
+        self._command_sent_at = now
+
+    def state_received(self):
+        """Record a message from the game
+
+        :return: None
+        """
+        now = time.monotonic()
+        if self._command_sent_at is not None:
+            self.game_response.observe(now - self._command_sent_at)
+            self._command_sent_at = None
+        self.states_received += 1
+        second = int(now)
+        slot = second % RATE_WINDOW
+        if self._rate_seconds[slot] != second:
+            self._rate_seconds[slot] = second  # Reuse the slot of a second that left the window
+            self._rate_counts[slot] = 0
+        self._rate_counts[slot] += 1
+
+    def request(self, path):
+        """Count an HTTP request
+
+        :param path: the request path (without query)
+        :type path: str
+        :return: None
+        """
+        with self._requests_lock:
+            self.requests[path] += 1
+
+    def states_per_second(self):
+        """Get the rate of messages from the game over the last RATE_WINDOW seconds
+
+        :rtype: float
+        """
+        now = time.monotonic()
+        second = int(now)
+        # The current second is partly over, so the buckets span a little less than RATE_WINDOW
+        window = min(RATE_WINDOW - 1 + (now - second), now - self.start_time)
+        recent = sum(count for slot_second, count in zip(self._rate_seconds, self._rate_counts)
+                     if second - slot_second < RATE_WINDOW)
+        return recent / window if window > 0 else 0.0
+
+    def render(self, queue_depth, state_version):
+        """Format every metric as Prometheus text
+
+        :param queue_depth: current length of the action queue
+        :type queue_depth: int
+        :param state_version: current /state version
+        :type state_version: int
+        :return: the exposition body
+        :rtype: str
+        """
+        lines = []
+        lines += self.queue_wait.render(
+            'spirecomm_action_queue_wait_seconds', 'Time actions waited in the action queue before being sent to the game')
+        lines += self.game_response.render(
+            'spirecomm_game_response_seconds', 'Time from sending a command to the next message from the game')
+        lines += _scalar('spirecomm_actions_executed_total', 'counter',
+                         'Actions sent to the game', self.actions_executed)
+        lines += _scalar('spirecomm_states_received_total', 'counter',
+                         'Messages received from the game', self.states_received)
+        lines += _scalar('spirecomm_states_per_second', 'gauge',
+                         f'Messages received from the game per second over the last {RATE_WINDOW:g}s',
+                         round(self.states_per_second(), 3))
+        lines += _scalar('spirecomm_coordinator_loop_iterations_total', 'counter',
+                         'Coordinator loop iterations', self.loop_iterations)
+        lines += _scalar('spirecomm_coordinator_idle_iterations_total', 'counter',
+                         'Coordinator loop iterations that found nothing to do and went to sleep', self.idle_iterations)
+        lines += _scalar('spirecomm_action_queue_depth', 'gauge', 'Actions waiting in the queue', queue_depth)
+        lines += _scalar('spirecomm_state_version', 'gauge', 'Current /state version', state_version)
+        lines += _scalar('spirecomm_process_cpu_seconds_total', 'counter',
+                         'CPU time used by the server process', round(time.process_time(), 6))
+        lines += _scalar('spirecomm_uptime_seconds', 'gauge', 'Time since the server started',
+                         round(time.monotonic() - self.start_time, 3))
+
+        with self._requests_lock:
+            requests = sorted(self.requests.items())
+        lines += ['# HELP spirecomm_http_requests_total HTTP requests by path',
+                  '# TYPE spirecomm_http_requests_total counter']
+        lines += [f'spirecomm_http_requests_total{{path="{path}"}} {count}' for path, count in requests]
+        return '\n'.join(lines) + '\n'
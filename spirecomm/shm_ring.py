@@ -0,0 +1,171 @@
+"""
+Shared-memory ring - the server end of the --shm transport
+
+A memory-mapped file holding a header and two rings of variable-length
+records, read and written in place by the C++ client (cpp_client/src/
+shm_transport.cpp) so states and actions never go through HTTP:
+
+  - the state ring: every new /state body is appended by the server. The
+    writer never waits; a reader takes the latest record and re-checks the
+    reserve position afterwards to detect that it was overwritten meanwhile.
+  - the action ring: a single-producer/single-consumer queue of /action
+    bodies, written by the client and drained by the server.
+
+Header (little-endian, 256 bytes; positions are byte counts that only grow):
+
+    0   u32 magic ("SCRB")         64  u64 state reserve (end of record being written)
+    4   u32 layout version         72  u64 state commit (end of last complete record)
+    8   u64 state ring capacity    80  u64 state latest (start of last complete record)
+    16  u64 action ring capacity   88  u64 state latest version
+                                   128 u64 action write (client)
+                                   192 u64 action read (server)
+
+Records are u32 length, u32 reserved, u64 version, then the body, padded to
+8 bytes. A length of 0xFFFFFFFF in the action ring means the rest of the
+ring is unused and the next record starts at offset 0. In action records
+the version field is written as 0 by the client; the server stores the
+action's id there (0 if rejected) before releasing the record.
+
+The writes below rely on the stores reaching the mapping in program order,
+which holds on x86-64; Python offers no memory fences to guarantee it on
+weakly-ordered CPUs.
+"""
+
+import mmap
+import os
+import struct
+
+MAGIC = 0x42524353
+LAYOUT_VERSION = 1
+
+HEADER_SIZE = 256
+RECORD_HEADER_SIZE = 16
+WRAP_MARKER = 0xFFFFFFFF
+
+_STATE_CAPACITY = 8
+_ACTION_CAPACITY = 16
+_STATE_RESERVE = 64
+_STATE_COMMIT = 72
+_STATE_LATEST = 80
+_STATE_LATEST_VERSION = 88
+_ACTION_WRITE = 128
+_ACTION_READ = 192
+
+_U32 = struct.Struct('<I')
+_U64 = struct.Struct('<Q')
+_RECORD_HEADER = struct.Struct('<IIQ')
+
+
+def _record_size(body_size):
+    return (RECORD_HEADER_SIZE + body_size + 7) & ~7
+
+
+def _align(capacity):
+    return max(capacity, RECORD_HEADER_SIZE * 2) // 8 * 8
+
+
+class SharedMemoryRing:
+    """Creates the shared-memory file and serves both rings
+
+    publish_state() must only be called from one thread, and poll_actions()
+    from one (possibly different) thread.
+    """
+
+    def __init__(self, path, state_capacity, action_capacity):
+        """Create (or replace) the file and write its header
+
+        :param path: the file to create, e.g. under /dev/shm
+        :type path: str
+        :param state_capacity: size of the state ring in bytes
+        :type state_capacity: int
+        :param action_capacity: size of the action ring in bytes
+        :type action_capacity: int
+        """
+        self.path = path
+        self.state_capacity = _align(state_capacity)
+        self.action_capacity = _align(action_capacity)
+        self._state_base = HEADER_SIZE
+        self._action_base = HEADER_SIZE + self.state_capacity
+        self._state_write = 0
+        self._action_read = 0
+
+        size = HEADER_SIZE + self.state_capacity + self.action_capacity
+        with open(path, 'w+b') as f:
+            f.truncate(size)
+            self._map = mmap.mmap(f.fileno(), size)
+
+        _U32.pack_into(self._map, 4, LAYOUT_VERSION)
+        _U64.pack_into(self._map, _STATE_CAPACITY, self.state_capacity)
+        _U64.pack_into(self._map, _ACTION_CAPACITY, self.action_capacity)
+        _U32.pack_into(self._map, 0, MAGIC)  # Last, so a client never accepts a half-written header
+
+    def publish_state(self, version, body):
+        """Append a state to the state ring and make it the latest
+
+        :param version: the state version of body
+        :type version: int
+        :param body: the encoded /state body
+        :type body: bytes
+        :return: False if the body does not fit in the ring
+        :rtype: bool
+        """
+        need = _record_size(len(body))
+        if need > self.state_capacity:
+            return False
+
+        start = self._state_write
+        offset = start % self.state_capacity
+        if self.state_capacity - offset < need:
+            start += self.state_capacity - offset  # Records never wrap; skip to the start of the ring
+            offset = 0
+        end = start + need
+
+        # Claim the space first so readers of the record being overwritten notice
+        _U64.pack_into(self._map, _STATE_RESERVE, end)
+        record = self._state_base + offset
+        _RECORD_HEADER.pack_into(self._map, record, len(body), 0, version)
+        self._map[record + RECORD_HEADER_SIZE:record + RECORD_HEADER_SIZE + len(body)] = body
+        _U64.pack_into(self._map, _STATE_LATEST, start)
+        _U64.pack_into(self._map, _STATE_LATEST_VERSION, version)
+        _U64.pack_into(self._map, _STATE_COMMIT, end)
+        self._state_write = end
+        return True
+
+    def poll_actions(self, handle):
+        """Drain the action ring
+
+        :param handle: called with each action body written since the last
+            call, oldest first; returns the id to store in the record
+        :type handle: function(body: bytes) -> int
+        :return: the number of actions handled
+        :rtype: int
+        """
+        write = _U64.unpack_from(self._map, _ACTION_WRITE)[0]
+        count = 0
+        read = self._action_read
+        while read < write:
+            offset = read % self.action_capacity
+            record = self._action_base + offset
+            length = _U32.unpack_from(self._map, record)[0]
+            if length == WRAP_MARKER:
+                read += self.action_capacity - offset
+                continue
+            start = record + RECORD_HEADER_SIZE
+            action_id = handle(bytes(self._map[start:start + length]))
+            _U64.pack_into(self._map, record + 8, action_id)
+            read += _record_size(length)
+            count += 1
+
+            # Hands the space (and the id) back to the client
+            self._action_read = read
+            _U64.pack_into(self._map, _ACTION_READ, read)
+        return count
+
+    def close(self):
+        """Unmap and delete the file
+
+        :return: None
+        """
+        self._map.close()
+        if os.path.exists(self.path):
+            os.unlink(self.path)
@@ -0,0 +1,412 @@
+"""
+Wire Format - JSON, MessagePack and CBOR encoding of HTTP bodies
+
+Minimal pure-Python codecs for JSON-compatible values (dict, list, str, int,
+float, bool, None), so the HTTP server can speak binary formats without extra
+dependencies. The format of a response is negotiated from the request's Accept
+header; request bodies are decoded according to their Content-Type.
+"""
+
+import json
+import struct
+
+JSON = 'json'
+MSGPACK = 'msgpack'
+CBOR = 'cbor'
+
+_CONTENT_TYPES = {
+    JSON: 'application/json',
+    MSGPACK: 'application/msgpack',
+    CBOR: 'application/cbor',
+}
+
+# Media types recognized in Accept and Content-Type headers
+_MEDIA_TYPES = {
+    'application/json': JSON,
+    'application/msgpack': MSGPACK,
+    'application/x-msgpack': MSGPACK,
+    'application/vnd.msgpack': MSGPACK,
+    'application/cbor': CBOR,
+}
+
+
+def content_type(fmt):
+    """Get the Content-Type header value for a format
+
+    :param fmt: one of JSON, MSGPACK, CBOR
+    :return: the media type
+    :rtype: str
+    """
+    return _CONTENT_TYPES[fmt]
+
+
+def negotiate(accept):
+    """Pick the response format for an Accept header
+
+    Honours q-values; anything unrecognized (or no header at all) means JSON.
+
+    :param accept: the Accept header value, or None
+    :type accept: str
+    :return: one of JSON, MSGPACK, CBOR
+    :rtype: str
+    """
+    if not accept:
+        return JSON
+
+    best, best_q = JSON, 0.0
+    for entry in accept.split(','):
+        media_type, _, params = entry.partition(';')
+        fmt = _MEDIA_TYPES.get(media_type.strip().lower())
+        if fmt is None:
+            continue
+        q = 1.0
+        for param in params.split(';'):
+            name, _, value = param.partition('=')
+            if name.strip() == 'q':
+                try:
+                    q = float(value)
+                except ValueError:
+                    q = 0.0
+        if q > best_q:
+            best, best_q = fmt, q
+    return best
+
+
+def format_for_content_type(header):
+    """Get the format of a request body from its Content-Type header
+
+    :param header: the Content-Type header value, or None
+    :type header: str
+    :return: one of JSON, MSGPACK, CBOR (JSON if missing or unrecognized)
+    :rtype: str
+    """
+    if not header:
+        return JSON
+    return _MEDIA_TYPES.get(header.split(';')[0].strip().lower(), JSON)
+
+
+def encode(fmt, value):
+    """Encode a JSON-compatible value
+
+    :param fmt: one of JSON, MSGPACK, CBOR
+    :param value: the value to encode
+    :return: the encoded body
+    :rtype: bytes
+    """
+    if fmt == MSGPACK:
+        out = []
+        _pack_msgpack(value, out)
+        return b''.join(out)
+    if fmt == CBOR:
+        out = []
+        _pack_cbor(value, out)
+        return b''.join(out)
+    return json.dumps(value).encode('utf-8')
+
+
+def decode(fmt, data):
+    """Decode a body into a JSON-compatible value
+
+    :param fmt: one of JSON, MSGPACK, CBOR
+    :param data: the encoded body
+    :type data: bytes
+    :return: the decoded value
+    :raises ValueError: if the body is malformed or has trailing data
+    """
+    try:
+        if fmt == JSON:
+            return json.loads(data.decode('utf-8'))
+        if fmt == MSGPACK:
+            value, end = _unpack_msgpack(data, 0)
+        else:
+            value, end = _unpack_cbor(data, 0)
+    except (IndexError, TypeError, RecursionError, struct.error, UnicodeDecodeError) as e:
+        raise ValueError(f"Malformed {fmt} body: {e}")
+    if end != len(data):
+        raise ValueError(f"Malformed {fmt} body: trailing data")
+    return value
+
+
+# MessagePack (https://github.com/msgpack/msgpack/blob/master/spec.md)
+
+def _pack_msgpack(value, out):
+    if value is None:
+        out.append(b'\xc0')
+    elif value is True:
+        out.append(b'\xc3')
+    elif value is False:
+        out.append(b'\xc2')
+    elif isinstance(value, int):
+        if 0 <= value < 0x80:
+            out.append(bytes((value,)))
+        elif -32 <= value < 0:
+            out.append(bytes((value & 0xff,)))
+        elif value >= 0:
+            if value <= 0xff:
+                out.append(struct.pack('>BB', 0xcc, value))
+            elif value <= 0xffff:
+                out.append(struct.pack('>BH', 0xcd, value))
+            elif value <= 0xffffffff:
+                out.append(struct.pack('>BI', 0xce, value))
+            else:
+                out.append(struct.pack('>BQ', 0xcf, value))
+        else:
+            if value >= -0x80:
+                out.append(struct.pack('>Bb', 0xd0, value))
+            elif value >= -0x8000:
+                out.append(struct.pack('>Bh', 0xd1, value))
+            elif value >= -0x80000000:
+                out.append(struct.pack('>Bi', 0xd2, value))
+            else:
+                out.append(struct.pack('>Bq', 0xd3, value))
+    elif isinstance(value, float):
+        out.append(struct.pack('>Bd', 0xcb, value))
+    elif isinstance(value, str):
+        raw = value.encode('utf-8')
+        n = len(raw)
+        if n < 32:
+            out.append(bytes((0xa0 | n,)))
+        elif n <= 0xff:
+            out.append(struct.pack('>BB', 0xd9, n))
+        elif n <= 0xffff:
+            out.append(struct.pack('>BH', 0xda, n))
+        else:
+            out.append(struct.pack('>BI', 0xdb, n))
+        out.append(raw)
+    elif isinstance(value, (list, tuple)):
+        n = len(value)
+        if n < 16:
+            out.append(bytes((0x90 | n,)))
+        elif n <= 0xffff:
+            out.append(struct.pack('>BH', 0xdc, n))
+        else:
+            out.append(struct.pack('>BI', 0xdd, n))
+        for item in value:
+            _pack_msgpack(item, out)
+    elif isinstance(value, dict):
+        n = len(value)
+        if n < 16:
+            out.append(bytes((0x80 | n,)))
+        elif n <= 0xffff:
+            out.append(struct.pack('>BH', 0xde, n))
+        else:
+            out.append(struct.pack('>BI', 0xdf, n))
+        for key, item in value.items():
+            _pack_msgpack(str(key), out)
+            _pack_msgpack(item, out)
+    else:
+        raise TypeError(f"Cannot encode {type(value).__name__} as MessagePack")
+
+
+# Fixed-width MessagePack scalars: type byte -> (struct format, size)
+_MSGPACK_SCALARS = {
+    0xca: ('>f', 4), 0xcb: ('>d', 8),
+    0xcc: ('>B', 1), 0xcd: ('>H', 2), 0xce: ('>I', 4), 0xcf: ('>Q', 8),
+    0xd0: ('>b', 1), 0xd1: ('>h', 2), 0xd2: ('>i', 4), 0xd3: ('>q', 8),
+}
+
+
+def _unpack_msgpack(data, pos):
+    b = data[pos]
+    pos += 1
+    if b < 0x80:
+        return b, pos
+    if b >= 0xe0:
+        return b - 0x100, pos
+    if 0xa0 <= b <= 0xbf:
+        return _msgpack_str(data, pos, b & 0x1f)
+    if 0x90 <= b <= 0x9f:
+        return _msgpack_array(data, pos, b & 0x0f)
+    if 0x80 <= b <= 0x8f:
+        return _msgpack_map(data, pos, b & 0x0f)
+    if b == 0xc0:
+        return None, pos
+    if b == 0xc2:
+        return False, pos
+    if b == 0xc3:
+        return True, pos
+    if b in _MSGPACK_SCALARS:
+        fmt, size = _MSGPACK_SCALARS[b]
+        return struct.unpack_from(fmt, data, pos)[0], pos + size
+    if b in (0xd9, 0xda, 0xdb):
+        n, pos = _msgpack_length(data, pos, b - 0xd9)
+        return _msgpack_str(data, pos, n)
+    if b in (0xc4, 0xc5, 0xc6):
+        n, pos = _msgpack_length(data, pos, b - 0xc4)
+        if pos + n > len(data):
+            raise IndexError("binary past end of body")
+        return bytes(data[pos:pos + n]), pos + n
+    if b in (0xdc, 0xdd):
+        n, pos = _msgpack_length(data, pos, b - 0xdc + 1)
+        return _msgpack_array(data, pos, n)
+    if b in (0xde, 0xdf):
+        n, pos = _msgpack_length(data, pos, b - 0xde + 1)
+        return _msgpack_map(data, pos, n)
+    raise ValueError(f"Unsupported MessagePack type 0x{b:02x}")
+
+
+def _msgpack_length(data, pos, width):
+    """Read a 1, 2 or 4 byte length (width 0, 1 or 2)"""
+    fmt, size = (('>B', 1), ('>H', 2), ('>I', 4))[width]
+    return struct.unpack_from(fmt, data, pos)[0], pos + size
+
+
+def _msgpack_str(data, pos, n):
+    if pos + n > len(data):
+        raise IndexError("string past end of body")
+    return bytes(data[pos:pos + n]).decode('utf-8'), pos + n
+
+
+def _msgpack_array(data, pos, n):
+    items = []
+    for _ in range(n):
+        item, pos = _unpack_msgpack(data, pos)
+        items.append(item)
+    return items, pos
+
+
+def _msgpack_map(data, pos, n):
+    result = {}
+    for _ in range(n):
+        key, pos = _unpack_msgpack(data, pos)
+        if not isinstance(key, str):
+            raise ValueError(f"MessagePack map key is {type(key).__name__}, not a string")
+        value, pos = _unpack_msgpack(data, pos)
+        result[key] = value
+    return result, pos
+
+
+# CBOR (RFC 8949)
+
+def _cbor_head(major, n, out):
+    if n < 24:
+        out.append(bytes(((major << 5) | n,)))
+    elif n <= 0xff:
+        out.append(struct.pack('>BB', (major << 5) | 24, n))
+    elif n <= 0xffff:
+        out.append(struct.pack('>BH', (major << 5) | 25, n))
+    elif n <= 0xffffffff:
+        out.append(struct.pack('>BI', (major << 5) | 26, n))
+    else:
+        out.append(struct.pack('>BQ', (major << 5) | 27, n))
+
+
+def _pack_cbor(value, out):
+    if value is None:
+        out.append(b'\xf6')
+    elif value is True:
+        out.append(b'\xf5')
+    elif value is False:
+        out.append(b'\xf4')
+    elif isinstance(value, int):
+        if value >= 0:
+            _cbor_head(0, value, out)
+        else:
+            _cbor_head(1, -1 - value, out)
+    elif isinstance(value, float):
+        out.append(struct.pack('>Bd', 0xfb, value))
+    elif isinstance(value, str):
+        raw = value.encode('utf-8')
+        _cbor_head(3, len(raw), out)
+        out.append(raw)
+    elif isinstance(value, (list, tuple)):
+        _cbor_head(4, len(value), out)
+        for item in value:
+            _pack_cbor(item, out)
+    elif isinstance(value, dict):
+        _cbor_head(5, len(value), out)
+        for key, item in value.items():
+            _pack_cbor(str(key), out)
+            _pack_cbor(item, out)
+    else:
+        raise TypeError(f"Cannot encode {type(value).__name__} as CBOR")
+
+
+_CBOR_BREAK = 0xff  # Initial byte that ends an indefinite-length item
+
+
+def _cbor_argument(data, pos, info):
+    """Read the argument of a data item head; None means indefinite length"""
+    if info < 24:
+        return info, pos
+    if info == 24:
+        return data[pos], pos + 1
+    if info == 25:
+        return struct.unpack_from('>H', data, pos)[0], pos + 2
+    if info == 26:
+        return struct.unpack_from('>I', data, pos)[0], pos + 4
+    if info == 27:
+        return struct.unpack_from('>Q', data, pos)[0], pos + 8
+    if info == 31:
+        return None, pos
+    raise ValueError(f"Invalid CBOR additional info {info}")
+
+
+def _unpack_cbor(data, pos):
+    b = data[pos]
+    pos += 1
+    major, info = b >> 5, b & 0x1f
+
+    if major == 7:
+        if info == 20:
+            return False, pos
+        if info == 21:
+            return True, pos
+        if info in (22, 23):
+            return None, pos
+        if info == 25:
+            return struct.unpack_from('>e', data, pos)[0], pos + 2
+        if info == 26:
+            return struct.unpack_from('>f', data, pos)[0], pos + 4
+        if info == 27:
+            return struct.unpack_from('>d', data, pos)[0], pos + 8
+        if info == 31:
+            # Indefinite-length items read their own break; anywhere else it is an error
+            raise ValueError("CBOR break outside an indefinite-length item")
+        raise ValueError(f"Unsupported CBOR simple value {info}")
+
+    if info == 31 and major in (0, 1, 6):
+        raise ValueError(f"CBOR major type {major} cannot have indefinite length")
+    n, pos = _cbor_argument(data, pos, info)
+    if major == 0:
+        return n, pos
+    if major == 1:
+        return -1 - n, pos
+    if major == 6:
+        # Tags carry no meaning for JSON-compatible values; decode the tagged item
+        return _unpack_cbor(data, pos)
+    if major in (2, 3):
+        if n is None:
+            chunks = []
+            while data[pos] != _CBOR_BREAK:
+                # Chunks are definite-length strings of the same type
+                if data[pos] >> 5 != major or data[pos] & 0x1f == 31:
+                    raise ValueError("Invalid chunk in an indefinite-length CBOR string")
+                chunk, pos = _unpack_cbor(data, pos)
+                chunks.append(chunk)
+            return ('' if major == 3 else b'').join(chunks), pos + 1
+        if pos + n > len(data):
+            raise IndexError("string past end of body")
+        raw = bytes(data[pos:pos + n])
+        return (raw.decode('utf-8') if major == 3 else raw), pos + n
+    if major == 4:
+        items = []
+        while len(items) != n:
+            if n is None and data[pos] == _CBOR_BREAK:
+                return items, pos + 1
+            item, pos = _unpack_cbor(data, pos)
+            items.append(item)
+        return items, pos
+    # major == 5
+    result = {}
+    count = 0
+    while count != n:
+        if n is None and data[pos] == _CBOR_BREAK:
+            return result, pos + 1
+        key, pos = _unpack_cbor(data, pos)
+        if not isinstance(key, str):
+            raise ValueError(f"CBOR map key is {type(key).__name__}, not a string")
+        value, pos = _unpack_cbor(data, pos)
+        result[key] = value
+        count += 1
+    return result, pos
@@ -0,0 +1,86 @@
+"""
+Round-trip tests for spirecomm.json_patch
+
+Run with: python -m unittest discover tests
+"""
+
+import copy
+import json
+import unittest
+
+from spirecomm.json_patch import make_patch
+
+
+def _unescape(token):
+    return token.replace('~1', '/').replace('~0', '~')
+
+
+def apply_patch(ops, doc):
+    """Apply add/remove/replace operations the way a client does (RFC 6902)"""
+    doc = copy.deepcopy(doc)
+    for op in ops:
+        if op['path'] == '':
+            doc = copy.deepcopy(op['value'])
+            continue
+        *parents, last = [_unescape(token) for token in op['path'].split('/')[1:]]
+        target = doc
+        for token in parents:
+            target = target[int(token)] if isinstance(target, list) else target[token]
+        if isinstance(target, list):
+            index = int(last)
+            if op['op'] == 'add':
+                target.insert(index, copy.deepcopy(op['value']))
+            elif op['op'] == 'remove':
+                del target[index]
+            else:
+                target[index] = copy.deepcopy(op['value'])
+        elif op['op'] == 'remove':
+            del target[last]
+        else:
+            target[last] = copy.deepcopy(op['value'])
+    return doc
+
+
+def _canonical(doc):
+    # json.dumps tells 0, 0.0 and false apart where == does not
+    return json.dumps(doc, sort_keys=True)
+
+
+class RoundTripTest(unittest.TestCase):
+
+    def assertRoundTrip(self, src, dst):
+        patched = apply_patch(make_patch(src, dst), src)
+        self.assertEqual(_canonical(patched), _canonical(dst))
+
+    def test_equal_documents_give_empty_patch(self):
+        doc = {'hand': [{'id': 'Strike_R', 'cost': 1}], 'gold': 99}
+        self.assertEqual(make_patch(doc, copy.deepcopy(doc)), [])
+
+    def test_scalars_of_different_types(self):
+        for src, dst in [(0, False), (False, 0), (1, True), (1, 1.0), (1.0, 1), ('1', 1), (None, 0)]:
+            self.assertRoundTrip({'value': src}, {'value': dst})
+
+    def test_list_trimming_is_type_strict(self):
+        self.assertRoundTrip([1, 0, 1], [True, 0, True])
+        self.assertRoundTrip([0, 1, 2, 0], [False, 1, 2, 0.0])
+        self.assertRoundTrip([[1, 0], {'a': 1}], [[True, 0], {'a': 1.0}])
+
+    def test_card_played_from_hand(self):
+        src = {'hand': [{'id': 'Strike_R'}, {'id': 'Bash'}, {'id': 'Defend_R'}], 'energy': 3}
+        dst = {'hand': [{'id': 'Strike_R'}, {'id': 'Defend_R'}], 'energy': 1}
+        ops = make_patch(src, dst)
+        self.assertIn({'op': 'remove', 'path': '/hand/1'}, ops)
+        self.assertRoundTrip(src, dst)
+
+    def test_nested_changes(self):
+        src = {'a/b': {'~x': [1, 2, 3]}, 'gone': True, 'list': [1, 2], 'type': [1]}
+        dst = {'a/b': {'~x': [0, 1, 2, 3, 4]}, 'new': None, 'list': [], 'type': {'0': 1}}
+        self.assertRoundTrip(src, dst)
+
+    def test_root_replaced(self):
+        self.assertRoundTrip([1, 2], {'a': 1})
+        self.assertRoundTrip(0, False)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,67 @@
+"""
+Tests for spirecomm.communication.mock_game
+
+Run with: python -m unittest discover tests
+"""
+
+import json
+import unittest
+
+from spirecomm.communication.mock_game import MockGame, default_script
+
+
+def _screen(message):
+    return json.loads(message).get('game_state', {}).get('screen_type')
+
+
+class DefaultScriptTest(unittest.TestCase):
+
+    def setUp(self):
+        self.game = MockGame()
+        self.script = default_script()
+
+    def assertAdvances(self, command):
+        position = self.game.position
+        answer = json.loads(self.game.respond(command))
+        self.assertNotIn('error', answer, command)
+        self.assertEqual(self.game.position, (position + 1) % len(self.script), command)
+
+    def test_walk_with_command_aliases(self):
+        # One command per scripted state, using the names clients send
+        commands = {
+            'EVENT': 'choose 0', 'MAP': 'choose 0', 'NONE': 'play 1 0', 'COMBAT_REWARD': 'confirm',
+            'CARD_REWARD': 'skip', 'SHOP_ROOM': 'proceed', 'SHOP_SCREEN': 'leave', 'GRID': 'choose 0',
+            'REST': 'choose 0', 'CHEST': 'proceed', 'BOSS_REWARD': 'cancel', 'GAME_OVER': 'confirm',
+            None: 'start ironclad',
+        }
+        self.game.respond('ready')
+        for message in self.script:
+            screen = message.get('game_state', {}).get('screen_type')
+            if screen == 'REST' and 'choose' not in message['available_commands']:
+                command = 'proceed'
+            elif screen == 'CHEST' and 'choose' in message['available_commands']:
+                command = 'choose 0'
+            else:
+                command = commands[screen]
+            self.assertAdvances(command)
+        self.assertEqual(self.game.position, 0)
+
+    def test_every_alias_of_return(self):
+        for command in ('skip', 'cancel', 'leave', 'return'):
+            self.game.position = next(i for i, message in enumerate(self.game.script)
+                                      if _screen(message) == 'CARD_REWARD')
+            self.assertAdvances(command)
+
+    def test_unlisted_command_is_rejected(self):
+        answer = json.loads(self.game.respond('skip'))  # The Neow event lists neither skip nor return
+        self.assertIn('Invalid command: skip', answer['error'])
+        self.assertEqual(self.game.position, 0)
+
+    def test_queries_do_not_advance(self):
+        for command in ('state', 'wait 10'):
+            json.loads(self.game.respond(command))
+            self.assertEqual(self.game.position, 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,119 @@
+"""
+Tests for spirecomm.wire_format
+
+Run with: python -m unittest discover tests
+"""
+
+import json
+import math
+import unittest
+
+from spirecomm import wire_format
+from spirecomm.wire_format import CBOR, JSON, MSGPACK
+
+FORMATS = (JSON, MSGPACK, CBOR)
+
+# Integers at every width boundary of both formats
+INTEGERS = [0, 1, 23, 24, 31, 127, 128, 255, 256, 65535, 65536, 2 ** 32 - 1, 2 ** 32, 2 ** 63 - 1,
+            -1, -24, -25, -32, -33, -128, -129, -32768, -32769, -2 ** 31, -2 ** 31 - 1, -2 ** 63]
+
+
+def _canonical(value):
+    # json.dumps tells 0, 0.0 and false apart where == does not
+    return json.dumps(value, sort_keys=True)
+
+
+class RoundTripTest(unittest.TestCase):
+
+    def assertRoundTrip(self, value):
+        for fmt in FORMATS:
+            decoded = wire_format.decode(fmt, wire_format.encode(fmt, value))
+            self.assertEqual(_canonical(decoded), _canonical(value), fmt)
+
+    def test_scalars(self):
+        for value in INTEGERS + [0.0, -0.5, 1.5, 1e300, True, False, None, '', 'Strike_R', 'héllo ✓']:
+            self.assertRoundTrip(value)
+
+    def test_lengths_at_width_boundaries(self):
+        for n in (0, 15, 16, 23, 24, 31, 32, 255, 256, 65535, 65536):
+            self.assertRoundTrip('x' * n)
+            self.assertRoundTrip(list(range(n)))
+            self.assertRoundTrip({str(i): i for i in range(n)})
+
+    def test_state_like_document(self):
+        self.assertRoundTrip({
+            'in_game': True, 'state_version': 12, 'available_commands': ['play', 'end'],
+            'game_state': {'hand': [{'id': 'Bash', 'cost': 2, 'upgrades': 0}], 'potions': [], 'gold': 99,
+                           'current_action': None, 'random': -0.25},
+        })
+
+    def test_special_floats(self):
+        for fmt in (MSGPACK, CBOR):
+            self.assertTrue(math.isnan(wire_format.decode(fmt, wire_format.encode(fmt, float('nan')))))
+            self.assertEqual(wire_format.decode(fmt, wire_format.encode(fmt, float('-inf'))), float('-inf'))
+
+
+class CborDecodeTest(unittest.TestCase):
+
+    def test_indefinite_length_items(self):
+        self.assertEqual(wire_format.decode(CBOR, b'\x9f\x01\x02\xff'), [1, 2])
+        self.assertEqual(wire_format.decode(CBOR, b'\xbf\x61a\x01\xff'), {'a': 1})
+        self.assertEqual(wire_format.decode(CBOR, b'\x7f\x62ab\x61c\xff'), 'abc')
+        self.assertEqual(wire_format.decode(CBOR, b'\x9f\x9f\xff\xff'), [[]])
+
+    def test_half_and_single_floats(self):
+        self.assertEqual(wire_format.decode(CBOR, b'\xf9\x3e\x00'), 1.5)
+        self.assertEqual(wire_format.decode(CBOR, b'\xfa\x3f\xc0\x00\x00'), 1.5)
+
+    def test_tags_are_skipped(self):
+        self.assertEqual(wire_format.decode(CBOR, b'\xc1\x1a\x00\x00\x00\x01'), 1)
+
+
+class MalformedInputTest(unittest.TestCase):
+
+    def assertMalformed(self, fmt, data):
+        with self.assertRaises(ValueError, msg=data):
+            wire_format.decode(fmt, data)
+
+    def test_cbor(self):
+        for data in [
+            b'',                      # Empty body
+            b'\xff',                  # Break outside an indefinite-length item
+            b'\x81\xff',              # Break inside a definite-length array
+            b'\xa1\xff\x01',          # Break as a map key
+            b'\x1f', b'\x3f', b'\xdf\x01',  # Indefinite-length integer and tag
+            b'\xa1\x81\x01\x02',      # Array as a map key
+            b'\xa1\x01\x02',          # Integer as a map key
+            b'\x7f\x01\xff',          # Integer chunk in an indefinite-length string
+            b'\x7f\x7f\xff\xff',      # Nested indefinite-length chunk
+            b'\x9f\x01',              # Missing break
+            b'\x62a',                 # String past the end of the body
+            b'\x62\xff\xfe',          # Invalid UTF-8
+            b'\x1c', b'\xf8\x10',     # Reserved additional info, unsupported simple value
+            b'\x01\x02',              # Trailing data
+            b'\x81' * 100000,         # Nested deeper than the recursion limit
+        ]:
+            self.assertMalformed(CBOR, data)
+
+    def test_json(self):
+        for data in [b'', b'{', b'\xff', b'[' * 100000]:
+            self.assertMalformed(JSON, data)
+
+    def test_msgpack(self):
+        for data in [
+            b'',
+            b'\xc1',                  # Reserved type
+            b'\x81\x91\x01\x02',      # Array as a map key
+            b'\x81\x01\x02',          # Integer as a map key
+            b'\x92\x01',              # Array past the end of the body
+            b'\xa2a',                 # String past the end of the body
+            b'\xa2\xff\xfe',          # Invalid UTF-8
+            b'\xcd\x01',              # Truncated uint16
+            b'\x01\x02',              # Trailing data
+            b'\x91' * 100000,         # Nested deeper than the recursion limit
+        ]:
+            self.assertMalformed(MSGPACK, data)
+
+
+if __name__ == '__main__':
+    unittest.main()